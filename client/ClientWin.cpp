@@ -14,6 +14,7 @@
 
 #include "ClientWin.h"
 #include "Error.h"
+#include "FrameTracer.h"
 #include "Log.h"
 #include "Profiler.h"
 #include "GLFrame.h"
@@ -27,8 +28,11 @@ extern Display *maindpy;
 
 
 ClientWin::ClientWin(int dpynum_, Window window_, int drawMethod_,
-	bool stereo_) : drawMethod(drawMethod_), reqDrawMethod(drawMethod_),
-	fb(NULL), cfindex(0), deadYet(false), thread(NULL), stereo(stereo_)
+	bool stereo_, int nprocs_) : drawMethod(drawMethod_),
+	reqDrawMethod(drawMethod_), fb(NULL), cframes(NULL), ncframes(NFRAMES),
+	cfindex(0), nprocs(nprocs_), nextDecompressor(0), pendingTiles(0),
+	needInit(true), deadYet(false), thread(NULL), stereo(stereo_),
+	ackSocket(NULL), ackMutex(NULL)
 {
 	if(dpynum_ < 0 || dpynum_ > 65535 || !window_)
 		throw(Error("ClientWin::ClientWin()", "Invalid argument"));
@@ -36,12 +40,26 @@ ClientWin::ClientWin(int dpynum_, Window window_, int drawMethod_,
 
 	#ifdef USEXV
 	for(int i = 0; i < NFRAMES; i++) xvframes[i] = NULL;
+	xvindex = 0;
 	#endif
+	for(int i = 0; i < MAXPROCS; i++) decompressors[i] = NULL;
+	if(nprocs < 1) nprocs = 1;
+	if(nprocs > MAXPROCS) nprocs = MAXPROCS;
+	// Each decompressor thread needs a tile to work on while the next tile is
+	// being received.
+	if(nprocs > 1) ncframes = nprocs * 2;
+	cframes = new CompressedFrame[ncframes];
+
 	if(drawMethod == RR_DRAWAUTO) drawMethod = RR_DRAWX11;
 	if(stereo) drawMethod = RR_DRAWOGL;
 	initGL();
 	initX11();
 
+	if(nprocs > 1)
+	{
+		for(int i = 0; i < nprocs; i++)
+			decompressors[i] = new Decompressor(i, this);
+	}
 	thread = new Thread(this);
 	thread->start();
 }
@@ -52,6 +70,10 @@ ClientWin::~ClientWin(void)
 	deadYet = true;
 	q.release();
 	if(thread) thread->stop();
+	for(int i = 0; i < MAXPROCS; i++)
+	{
+		delete decompressors[i];  decompressors[i] = NULL;
+	}
 	delete fb;  fb = NULL;
 	#ifdef USEXV
 	for(int i = 0; i < NFRAMES; i++)
@@ -62,11 +84,105 @@ ClientWin::~ClientWin(void)
 		}
 	}
 	#endif
-	for(int i = 0; i < NFRAMES; i++) cframes[i].signalComplete();
+	for(int i = 0; i < ncframes; i++) cframes[i].signalComplete();
+	delete [] cframes;  cframes = NULL;
 	delete thread;  thread = NULL;
 }
 
 
+ClientWin::Decompressor::Decompressor(int myRank, ClientWin *parent_) :
+	parent(parent_), tjhnd(NULL), deadYet(false), thread(NULL)
+{
+	char temps[20];
+	snprintf(temps, 20, "Decomp %-3d", myRank);
+	profDecomp.setName(temps);
+	thread = new Thread(this);
+	thread->start();
+}
+
+
+ClientWin::Decompressor::~Decompressor(void)
+{
+	deadYet = true;
+	q.release();
+	if(thread) { thread->stop();  delete thread;  thread = NULL; }
+	if(tjhnd) { tjDestroy(tjhnd);  tjhnd = NULL; }
+}
+
+
+void ClientWin::Decompressor::run(void)
+{
+	while(!deadYet)
+	{
+		void *ftemp = NULL;
+		q.get(&ftemp);  if(deadYet) break;
+		CompressedFrame *cf = (CompressedFrame *)ftemp;
+		if(!cf) continue;
+		try
+		{
+			if(cf->hdr.compress != RRCOMP_RGB
+				&& cf->hdr.compress != RRCOMP_LOSSLESS && !tjhnd)
+			{
+				if((tjhnd = tjInitDecompress()) == NULL)
+					throw(Error("ClientWin::Decompressor::run()", tjGetErrorStr()));
+			}
+			double traceStart = FrameTracer::start();
+			profDecomp.startFrame();
+			parent->decompress(cf, tjhnd);
+			profDecomp.endFrame(cf->hdr.width * cf->hdr.height, 0,
+				(double)(cf->hdr.width * cf->hdr.height) /
+					(double)(cf->hdr.framew * cf->hdr.frameh));
+			FrameTracer::end("Decompress", cf->hdr.winid, cf->hdr.frameid,
+				traceStart);
+		}
+		catch(std::exception &e)
+		{
+			// The error is reported by the ClientWin thread once all of the tiles
+			// in the frame have been processed.
+			if(thread) thread->setError(e);
+		}
+		parent->pendingMutex.lock();
+		if(--parent->pendingTiles <= 0) parent->tilesDone.signal();
+		parent->pendingMutex.unlock();
+		cf->signalComplete();
+	}
+}
+
+
+void ClientWin::decompress(CompressedFrame *cf, tjhandle handle)
+{
+	if(fb->isGL) ((GLFrame *)fb)->decompress(*cf, handle);
+	else ((FBXFrame *)fb)->decompress(*cf, handle);
+}
+
+
+// Wait until all tiles that have been handed off to the decompressor threads
+// have been decompressed into the back buffer
+void ClientWin::waitForDecompressors(void)
+{
+	while(true)
+	{
+		pendingMutex.lock();
+		int pending = pendingTiles;
+		pendingMutex.unlock();
+		if(pending <= 0) break;
+		tilesDone.wait();
+	}
+	for(int i = 0; i < nprocs; i++)
+		if(decompressors[i]) decompressors[i]->checkError();
+}
+
+
+
+void ClientWin::sendAck(void)
+{
+	if(!ackSocket) return;
+	char ack = 1;
+	CriticalSection::SafeLock l(*ackMutex);
+	ackSocket->send(&ack, 1);
+}
+
+
 void ClientWin::initGL(void)
 {
 	GLFrame *newfb = NULL;
@@ -95,10 +211,12 @@ void ClientWin::initGL(void)
 	{
 		if(fb)
 		{
+			waitForDecompressors();
 			if(fb->isGL) delete ((GLFrame *)fb);
 			else delete ((FBXFrame *)fb);
 		}
 		fb = (Frame *)newfb;
+		needInit = true;
 	}
 }
 
@@ -127,10 +245,12 @@ void ClientWin::initX11(void)
 	{
 		if(fb)
 		{
+			waitForDecompressors();
 			if(fb->isGL) { delete ((GLFrame *)fb); }
 			else delete ((FBXFrame *)fb);
 		}
 		fb = (Frame *)newfb;
+		needInit = true;
 	}
 }
 
@@ -150,19 +270,22 @@ Frame *ClientWin::getFrame(bool useXV)
 	#ifdef USEXV
 	if(useXV)
 	{
-		if(!xvframes[cfindex])
+		if(!xvframes[xvindex])
 		{
 			char dpystr[80];
 			snprintf(dpystr, 80, ":%d.0", dpynum);
-			xvframes[cfindex] = new XVFrame(dpystr, window);
-			if(!xvframes[cfindex]) THROW("Could not allocate class instance");
+			xvframes[xvindex] = new XVFrame(dpystr, window);
+			if(!xvframes[xvindex]) THROW("Could not allocate class instance");
 		}
-		f = (Frame *)xvframes[cfindex];
+		f = (Frame *)xvframes[xvindex];
+		xvindex = (xvindex + 1) % NFRAMES;
 	}
 	else
 	#endif
-	f = (Frame *)&cframes[cfindex];
-	cfindex = (cfindex + 1) % NFRAMES;
+	{
+		f = (Frame *)&cframes[cfindex];
+		cfindex = (cfindex + 1) % ncframes;
+	}
 	cfmutex.unlock();
 	f->waitUntilComplete();
 	if(thread) thread->checkError();
@@ -216,9 +339,12 @@ void ClientWin::run(void)
 			{
 				if(f->hdr.flags != RR_EOF)
 				{
+					double traceStart = FrameTracer::start();
 					pb.startFrame();
 					((XVFrame *)f)->redraw();
 					pb.endFrame(f->hdr.width * f->hdr.height, 0, 1);
+					FrameTracer::end("Blit", f->hdr.winid, f->hdr.frameid, traceStart,
+						FrameTracer::FLOWEND);
 					pt.endFrame(f->hdr.width * f->hdr.height, bytes, 1);
 					bytes = 0;
 					pt.startFrame();
@@ -229,27 +355,57 @@ void ClientWin::run(void)
 			{
 				if(f->hdr.flags == RR_EOF)
 				{
+					waitForDecompressors();
+					needInit = true;
+					double traceStart = FrameTracer::start();
 					pb.startFrame();
 					if(fb->isGL) ((GLFrame *)fb)->init(f->hdr, stereo);
 					else ((FBXFrame *)fb)->init(f->hdr);
 					if(fb->isGL) ((GLFrame *)fb)->redraw();
 					else ((FBXFrame *)fb)->redraw();
 					pb.endFrame(fb->hdr.framew * fb->hdr.frameh, 0, 1);
+					FrameTracer::end("Blit", f->hdr.winid, f->hdr.frameid, traceStart,
+						FrameTracer::FLOWEND);
 					pt.endFrame(fb->hdr.framew * fb->hdr.frameh, bytes, 1);
 					bytes = 0;
 					pt.startFrame();
 				}
+				else if(nprocs > 1)
+				{
+					// All tiles of a frame share the same frame dimensions, so the back
+					// buffer only needs to be (re)initialized once per frame, before any
+					// of the frame's tiles are handed off to the decompressor threads.
+					CompressedFrame *cf = (CompressedFrame *)f;
+					if(needInit)
+					{
+						if(fb->isGL) ((GLFrame *)fb)->init(cf->hdr, cf->stereo);
+						else ((FBXFrame *)fb)->init(cf->hdr);
+						needInit = false;
+					}
+					bytes += f->hdr.size;
+					pendingMutex.lock();
+					pendingTiles++;
+					pendingMutex.unlock();
+					decompressors[nextDecompressor]->add(cf);
+					nextDecompressor = (nextDecompressor + 1) % nprocs;
+					// The decompressor thread will signal completion.
+					continue;
+				}
 				else
 				{
+					double traceStart = FrameTracer::start();
 					pd.startFrame();
 					if(fb->isGL) *((GLFrame *)fb) = *((CompressedFrame *)f);
 					else *((FBXFrame *)fb) = *((CompressedFrame *)f);
 					pd.endFrame(f->hdr.width * f->hdr.height, 0,
 						(double)(f->hdr.width * f->hdr.height) /
 							(double)(f->hdr.framew * f->hdr.frameh));
+					FrameTracer::end("Decompress", f->hdr.winid, f->hdr.frameid,
+						traceStart);
 					bytes += f->hdr.size;
 				}
 			}
+			if(f->hdr.flags == RR_EOF) sendAck();
 			f->signalComplete();
 		}
 
@@ -17,7 +17,9 @@
 
 #include "Frame.h"
 #include "Thread.h"
-#include "GenericQ.h"
+#include "RingQ.h"
+#include "Profiler.h"
+#include "Socket.h"
 
 
 enum { RR_DRAWAUTO = -1, RR_DRAWX11 = 0, RR_DRAWOGL };
@@ -29,26 +31,63 @@ namespace client
 	{
 		public:
 
-			ClientWin(int dpynum, Window window, int drawMethod, bool stereo);
+			ClientWin(int dpynum, Window window, int drawMethod, bool stereo,
+				int nprocs = 1);
 			virtual ~ClientWin(void);
 			common::Frame *getFrame(bool useXV);
 			void drawFrame(common::Frame *f);
 			int match(int dpynum, Window window);
 			bool isStereo(void) { return stereo; }
 
+			// Acknowledge each frame, once it has been displayed, by sending a byte
+			// to the server through the specified socket
+			void enableAcks(util::Socket *socket, util::CriticalSection *mutex)
+			{
+				ackSocket = socket;  ackMutex = mutex;
+			}
+
 		private:
 
+			// Worker thread that decompresses tiles into the back buffer
+			class Decompressor : public util::Runnable
+			{
+				public:
+
+					Decompressor(int myRank, ClientWin *parent);
+					virtual ~Decompressor(void);
+					void run(void);
+					void add(common::CompressedFrame *cf) { q.add(cf); }
+					void checkError(void) { if(thread) thread->checkError(); }
+
+				private:
+
+					ClientWin *parent;
+					tjhandle tjhnd;
+					util::RingQ q;
+					bool deadYet;
+					common::Profiler profDecomp;
+					util::Thread *thread;
+			};
+
 			void initGL(void);
 			void initX11(void);
+			void decompress(common::CompressedFrame *cf, tjhandle handle);
+			void waitForDecompressors(void);
+			void sendAck(void);
 
 			int drawMethod, reqDrawMethod;
 			static const int NFRAMES = 2;
 			common::Frame *fb;
-			common::CompressedFrame cframes[NFRAMES];  int cfindex;
+			common::CompressedFrame *cframes;  int ncframes, cfindex;
 			#ifdef USEXV
-			common::XVFrame *xvframes[NFRAMES];
+			common::XVFrame *xvframes[NFRAMES];  int xvindex;
 			#endif
-			util::GenericQ q;
+			int nprocs;
+			Decompressor *decompressors[MAXPROCS];  int nextDecompressor;
+			int pendingTiles;  bool needInit;
+			util::CriticalSection pendingMutex;
+			util::Event tilesDone;
+			util::RingQ q;
 			bool deadYet;
 			int dpynum;  Window window;
 			void run(void);
@@ -56,6 +95,8 @@ namespace client
 			util::CriticalSection cfmutex;
 			bool stereo;
 			util::CriticalSection mutex;
+			util::Socket *ackSocket;
+			util::CriticalSection *ackMutex;
 	};
 }
 
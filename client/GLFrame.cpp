@@ -119,11 +119,29 @@ void GLFrame::init(rrframeheader &h, bool stereo_)
 
 
 GLFrame &GLFrame::operator= (CompressedFrame &cf)
+{
+	if(!cf.bits || cf.hdr.size < 1) THROW("JPEG not initialized");
+	init(cf.hdr, cf.stereo);
+	if(cf.hdr.compress != RRCOMP_RGB && cf.hdr.compress != RRCOMP_LOSSLESS
+		&& !tjhnd)
+	{
+		if((tjhnd = tjInitDecompress()) == NULL)
+			throw(Error("GLFrame::decompressor", tjGetErrorStr()));
+	}
+	decompress(cf, tjhnd);
+	return *this;
+}
+
+
+// Decompress a tile into a frame that has already been initialized with the
+// tile's frame dimensions.  Different tiles of the same frame can be
+// decompressed concurrently, as long as each thread uses its own TurboJPEG
+// instance.
+void GLFrame::decompress(CompressedFrame &cf, tjhandle handle)
 {
 	int tjflags = TJ_BOTTOMUP;
 
 	if(!cf.bits || cf.hdr.size < 1) THROW("JPEG not initialized");
-	init(cf.hdr, cf.stereo);
 	if(!bits) THROW("Frame not initialized");
 	int width = min(cf.hdr.width, hdr.framew - cf.hdr.x);
 	int height = min(cf.hdr.height, hdr.frameh - cf.hdr.y);
@@ -136,26 +154,27 @@ GLFrame &GLFrame::operator= (CompressedFrame &cf)
 			if(stereo && cf.rbits && rbits)
 				decompressRGB(cf, width, height, true);
 		}
+		else if(cf.hdr.compress == RRCOMP_LOSSLESS)
+		{
+			decompressLossless(cf, width, height, false);
+			if(stereo && cf.rbits && rbits)
+				decompressLossless(cf, width, height, true);
+		}
 		else
 		{
-			if(!tjhnd)
-			{
-				if((tjhnd = tjInitDecompress()) == NULL)
-					throw(Error("GLFrame::decompressor", tjGetErrorStr()));
-			}
+			if(!handle) THROW("Invalid argument");
 			int y = max(0, hdr.frameh - cf.hdr.y - height);
-			TRY_TJ(tjDecompress2(tjhnd, cf.bits, cf.hdr.size,
+			TRY_TJ(tjDecompress2(handle, cf.bits, cf.hdr.size,
 				&bits[pitch * y + cf.hdr.x * pf->size], width, pitch, height,
 				tjpf[pf->id], tjflags));
 			if(stereo && cf.rbits && rbits)
 			{
-				TRY_TJ(tjDecompress2(tjhnd, cf.rbits, cf.rhdr.size,
+				TRY_TJ(tjDecompress2(handle, cf.rbits, cf.rhdr.size,
 					&rbits[pitch * y + cf.hdr.x * pf->size], width, pitch, height,
 					tjpf[pf->id], tjflags));
 			}
 		}
 	}
-	return *this;
 }
 
 
@@ -31,6 +31,7 @@ namespace common
 			~GLFrame(void);
 			void init(rrframeheader &h, bool stereo);
 			GLFrame &operator= (CompressedFrame &cf);
+			void decompress(CompressedFrame &cf, tjhandle handle);
 			void redraw(void);
 			void drawTile(int x, int y, int width, int height);
 			void sync(void);
@@ -13,6 +13,7 @@
 // wxWindows Library License for more details.
 
 #include "VGLTransReceiver.h"
+#include "FrameTracer.h"
 #include "vglutil.h"
 
 using namespace util;
@@ -49,6 +50,7 @@ static unsigned short DisplayNumber(Display *dpy)
 		h.x = BYTESWAP16(h.x); \
 		h.y = BYTESWAP16(h.y); \
 		h.dpynum = BYTESWAP16(h.dpynum); \
+		h.frameid = BYTESWAP(h.frameid); \
 	} \
 }
 
@@ -81,12 +83,13 @@ static unsigned short DisplayNumber(Display *dpy)
 	h.subsamp = h1.subsamp; \
 	h.flags = h1.flags; \
 	h.dpynum = (unsigned short)h1.dpynum; \
+	h.frameid = 0; \
 }
 
 
-VGLTransReceiver::VGLTransReceiver(bool ipv6_, int drawMethod_) :
-	drawMethod(drawMethod_), listenSocket(NULL), thread(NULL), deadYet(false),
-	ipv6(ipv6_)
+VGLTransReceiver::VGLTransReceiver(bool ipv6_, int drawMethod_,
+	int nprocs_) : drawMethod(drawMethod_), nprocs(nprocs_), listenSocket(NULL),
+	thread(NULL), deadYet(false), ipv6(ipv6_)
 {
 	char *env = NULL;
 
@@ -133,7 +136,7 @@ void VGLTransReceiver::run(void)
 			listener = NULL;  socket = NULL;
 			socket = listenSocket->accept();  if(deadYet) break;
 			vglout.println("++ Connection from %s.", socket->remoteName());
-			listener = new Listener(socket, drawMethod);
+			listener = new Listener(socket, drawMethod, nprocs);
 			continue;
 		}
 		catch(std::exception &e)
@@ -158,13 +161,14 @@ void VGLTransReceiver::Listener::run(void)
 {
 	ClientWin *w = NULL;
 	Frame *f = NULL;
-	rrframeheader h;  rrframeheader_v1 h1;  bool haveHeader = false;
+	rrframeheader h, nextHeader;  rrframeheader_v1 h1;  bool haveHeader = false;
+	int nextHeaderBytes = 0, headerSize = sizeof_rrframeheader;
 	rrversion v;
 
 	try
 	{
 		recv((char *)&h1, sizeof_rrframeheader_v1);
-		ENDIANIZE(h1);
+		ENDIANIZE_V1(h1);
 		if(h1.framew != 0 && h1.frameh != 0 && h1.width != 0 && h1.height != 0
 			&& h1.winid != 0 && h1.size != 0 && h1.flags != RR_EOF)
 		{
@@ -185,6 +189,13 @@ void VGLTransReceiver::Listener::run(void)
 			&& !strncmp(env, "1", 1))
 			vglout.println("Server version: %d.%d", v.major, v.minor);
 		vglout.flush();
+		// Protocol v2.0 through v2.2 servers send the header without the frame
+		// ID.
+		if(v.major < 2 || (v.major == 2 && v.minor < 3))
+		{
+			headerSize = sizeof_rrframeheader_v2;
+			nextHeader.frameid = 0;
+		}
 
 		while(1)
 		{
@@ -202,14 +213,26 @@ void VGLTransReceiver::Listener::run(void)
 				}
 				else
 				{
-					recv((char *)&h, sizeof_rrframeheader);
+					// Some or all of the header may have been received along with the
+					// previous tile.
+					if(nextHeaderBytes < headerSize)
+						recv((char *)&nextHeader + nextHeaderBytes,
+							headerSize - nextHeaderBytes);
+					nextHeaderBytes = 0;
+					h = nextHeader;
 					ENDIANIZE(h);
 				}
+				// Protocol v2.3 and later:  the server limits the number of frames in
+				// flight, so it may ask for the frame to be acknowledged once it has
+				// been displayed.
+				bool ack = (h.flags == RR_EOF_ACK);
+				if(ack) h.flags = RR_EOF;
 				bool stereo = (h.flags == RR_LEFT || h.flags == RR_RIGHT);
 				unsigned short dpynum =
 					(v.major < 2 || (v.major == 2 && v.minor < 1)) ?
 					h.dpynum : DisplayNumber(maindpy);
 				ERRIFNOT(w = addWindow(dpynum, h.winid, stereo));
+				if(ack) w->enableAcks(socket, &sendMutex);
 
 				if(!stereo || h.flags == RR_LEFT || !f)
 				{
@@ -230,7 +253,22 @@ void VGLTransReceiver::Listener::run(void)
 				#endif
 				((CompressedFrame *)f)->init(h, h.flags);
 				if(h.flags != RR_EOF)
-					recv((char *)(h.flags == RR_RIGHT ? f->rbits : f->bits), h.size);
+				{
+					char *bits = (char *)(h.flags == RR_RIGHT ? f->rbits : f->bits);
+					double traceStart = FrameTracer::start();
+					if(v.major == 1 && v.minor == 0) recv(bits, h.size);
+					else
+					{
+						// Receive the tile along with as much of the next header as is
+						// already available, without waiting for the rest of it
+						SockBuf bufs[2] = {
+							{ bits, (int)h.size },
+							{ (char *)&nextHeader, headerSize }
+						};
+						nextHeaderBytes = recv(bufs, 2, h.size) - h.size;
+					}
+					FrameTracer::end("Receive", h.winid, h.frameid, traceStart);
+				}
 
 				if(!stereo || h.flags != RR_LEFT)
 				{
@@ -295,7 +333,7 @@ ClientWin *VGLTransReceiver::Listener::addWindow(int dpynum, Window win,
 	}
 	if(nwin >= MAXWIN) THROW("No free window IDs");
 	if(dpynum < 0 || dpynum > 65535 || win == None) THROW("Invalid argument");
-	windows[winid] = new ClientWin(dpynum, win, drawMethod, stereo);
+	windows[winid] = new ClientWin(dpynum, win, drawMethod, stereo, nprocs);
 
 	if(!windows[winid]) THROW("Could not create window instance");
 	nwin++;
@@ -318,6 +356,22 @@ void VGLTransReceiver::Listener::send(char *buf, int len)
 }
 
 
+int VGLTransReceiver::Listener::recv(SockBuf *bufs, int count, int minLen)
+{
+	try
+	{
+		if(socket) return socket->recv(bufs, count, minLen);
+	}
+	catch(...)
+	{
+		vglout.println("Error receiving data from server.  Server may have disconnected.");
+		vglout.println("   (this is normal if the application exited.)");
+		throw;
+	}
+	return minLen;
+}
+
+
 void VGLTransReceiver::Listener::recv(char *buf, int len)
 {
 	try
@@ -29,7 +29,7 @@ namespace client
 	{
 		public:
 
-			VGLTransReceiver(bool ipv6, int drawmethod);
+			VGLTransReceiver(bool ipv6, int drawmethod, int nprocs = 1);
 			void listen(unsigned short port);
 			unsigned short getPort(void) { return port; }
 			virtual ~VGLTransReceiver(void);
@@ -38,7 +38,7 @@ namespace client
 
 			void run(void);
 
-			int drawMethod;
+			int drawMethod, nprocs;
 			util::Socket *listenSocket;
 			util::CriticalSection listenMutex;
 			util::Thread *thread;
@@ -50,9 +50,9 @@ namespace client
 		{
 			public:
 
-				Listener(util::Socket *socket_, int drawMethod_) :
-					drawMethod(drawMethod_), nwin(0), socket(socket_), thread(NULL),
-					remoteName(NULL)
+				Listener(util::Socket *socket_, int drawMethod_, int nprocs_) :
+					drawMethod(drawMethod_), nprocs(nprocs_), nwin(0), socket(socket_),
+					thread(NULL), remoteName(NULL)
 				{
 					memset(windows, 0, sizeof(ClientWin *) * MAXWIN);
 					if(socket) remoteName = socket->remoteName();
@@ -78,12 +78,13 @@ namespace client
 
 				void send(char *buf, int len);
 				void recv(char *buf, int len);
+				int recv(util::SockBuf *bufs, int count, int minLen);
 
 			private:
 
 				void run(void);
 
-				int drawMethod;
+				int drawMethod, nprocs;
 				ClientWin *windows[MAXWIN];
 				int nwin;
 				ClientWin *addWindow(int dpynum, Window win, bool stereo = false);
@@ -92,6 +93,7 @@ namespace client
 				util::Socket *socket;
 				util::Thread *thread;
 				const char *remoteName;
+				util::CriticalSection sendMutex;
 		};
 	};
 }
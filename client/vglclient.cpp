@@ -43,6 +43,7 @@ bool deadYet;
 unsigned short port = 0;
 bool ipv6 = false;
 int drawMethod = RR_DRAWAUTO;
+int nprocs = 1;
 Display *maindpy = NULL;
 bool detach = false, force = false, child = false;
 char *logFile = NULL;
@@ -212,6 +213,8 @@ void usage(char **argv)
 	fprintf(stderr, "-port <p> = TCP port to use for connections from the VirtualGL Faker\n");
 	fprintf(stderr, "            (default: automatically select a free port)\n");
 	fprintf(stderr, "-ipv6 = Use IPv6 sockets\n");
+	fprintf(stderr, "-np <n> = Number of threads to use for decompressing the rendered frames\n");
+	fprintf(stderr, "          (default: 1, maximum: %d)\n", MAXPROCS);
 	fprintf(stderr, "-detach = Detach from console (used by vglconnect)\n");
 	fprintf(stderr, "-force = Force the VirtualGL Client to run, even if there is already another\n");
 	fprintf(stderr, "         instance running on the same X display (use with caution)\n");
@@ -288,6 +291,9 @@ void getEnvironment(void)
 	if((env = getenv("VGLCLIENT_IPV6")) != NULL && strlen(env) > 0
 		&& (temp = atoi(env)) == 1)
 		ipv6 = true;
+	if((env = getenv("VGLCLIENT_NPROCS")) != NULL && strlen(env) > 0
+		&& (temp = atoi(env)) > 0)
+		nprocs = min(temp, min(NumProcs(), MAXPROCS));
 }
 
 
@@ -313,6 +319,11 @@ int main(int argc, char *argv[])
 			{
 				port = (unsigned short)atoi(argv[++i]);
 			}
+			else if(!stricmp(argv[i], "-np") && i < argc - 1)
+			{
+				int temp = atoi(argv[++i]);
+				if(temp > 0) nprocs = min(temp, min(NumProcs(), MAXPROCS));
+			}
 			else if(!stricmp(argv[i], "-l") && i < argc - 1)
 			{
 				logFile = argv[++i];
@@ -378,7 +389,7 @@ int start(char *displayname)
 		if(!force) actualPort = instanceCheck(maindpy);
 		if(actualPort == 0)
 		{
-			receiver = new VGLTransReceiver(ipv6, drawMethod);
+			receiver = new VGLTransReceiver(ipv6, drawMethod, nprocs);
 			if(port == 0)
 			{
 				bool success = false;  unsigned short i = RR_DEFAULTPORT;
@@ -18,6 +18,15 @@
 #include <string.h>
 #include "vgllogo.h"
 #include "Frame.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define USEAVX2
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 using namespace util;
 using namespace common;
@@ -39,7 +48,9 @@ static int tjpf[PIXELFORMATS] =
 // Uncompressed frame
 
 Frame::Frame(bool primary_) : bits(NULL), rbits(NULL), pitch(0), flags(0),
-	pf(pf_get(-1)), isGL(false), isXV(false), stereo(false), primary(primary_)
+	pf(pf_get(-1)), isGL(false), isXV(false), stereo(false), damageBase(NULL),
+	damageX(0), damageY(0), damageWidth(0), damageHeight(0), primary(primary_),
+	tileHashes(NULL), nTileHashes(0), maxTileHashes(0), externalBits(false)
 {
 	memset(&hdr, 0, sizeof(rrframeheader));
 	ready.wait();
@@ -49,6 +60,7 @@ Frame::Frame(bool primary_) : bits(NULL), rbits(NULL), pitch(0), flags(0),
 Frame::~Frame(void)
 {
 	deInit();
+	free(tileHashes);
 }
 
 
@@ -56,7 +68,8 @@ void Frame::deInit(void)
 {
 	if(primary)
 	{
-		delete [] bits;  bits = NULL;
+		if(!externalBits) delete [] bits;
+		bits = NULL;  externalBits = false;
 		delete [] rbits;  rbits = NULL;
 	}
 }
@@ -74,8 +87,9 @@ void Frame::init(rrframeheader &h, int pixelFormat, int flags_, bool stereo_)
 	if(h.framew != hdr.framew || h.frameh != hdr.frameh
 		|| newpf->size != pf->size || !bits)
 	{
-		delete [] bits;
+		if(!externalBits) delete [] bits;
 		bits = new unsigned char[h.framew * h.frameh * newpf->size + 1];
+		externalBits = false;
 	}
 	if(stereo_)
 	{
@@ -91,6 +105,7 @@ void Frame::init(rrframeheader &h, int pixelFormat, int flags_, bool stereo_)
 		delete [] rbits;  rbits = NULL;
 	}
 	pf = newpf;  pitch = pf->size * h.framew;  stereo = stereo_;  hdr = h;
+	nTileHashes = 0;  damageBase = NULL;
 }
 
 
@@ -111,10 +126,41 @@ void Frame::init(unsigned char *bits_, int width, int pitch_, int height,
 	pitch = pitch_;
 	flags = flags_;
 	primary = false;
+	nTileHashes = 0;  damageBase = NULL;
 }
 
 
-Frame *Frame::getTile(int x, int y, int width, int height)
+// Use an externally allocated buffer, which must be at least
+// pitch * frameh + 1 bytes in size, for the (left eye) pixels of this frame.
+// The buffer is not freed by the frame, and the frame reverts to allocating
+// its own buffer if it is reinitialized with a different size.
+void Frame::setExternalBits(unsigned char *bits_)
+{
+	if(!bits_ || !primary) THROW("Invalid argument");
+
+	if(!externalBits) delete [] bits;
+	bits = bits_;  externalBits = true;
+}
+
+
+// If this frame is using an externally allocated buffer, then copy the pixels
+// into a buffer allocated by the frame, so that the external buffer can be
+// freed without losing the frame's contents.
+void Frame::detachExternalBits(void)
+{
+	if(!externalBits) return;
+
+	int size = pitch * hdr.frameh + 1;
+	unsigned char *newBits = new unsigned char[size];
+	memcpy(newBits, bits, size);
+	bits = newBits;  externalBits = false;
+}
+
+
+// Return a Frame instance that points to a region of this frame.  If tile is
+// non-NULL, then it must be a non-primary Frame instance, and it is reused
+// rather than allocating a new instance.
+Frame *Frame::getTile(int x, int y, int width, int height, Frame *tile)
 {
 	Frame *f;
 
@@ -122,8 +168,9 @@ Frame *Frame::getTile(int x, int y, int width, int height)
 	if(x < 0 || y < 0 || width < 1 || height < 1 || (x + width) > hdr.width
 		|| (y + height) > hdr.height)
 		throw Error("Frame::getTile", "Argument out of range");
+	if(tile && tile->primary) THROW("Invalid argument");
 
-	f = new Frame(false);
+	f = tile ? tile : new Frame(false);
 	f->hdr = hdr;
 	f->hdr.x = x;
 	f->hdr.y = y;
@@ -136,6 +183,7 @@ Frame *Frame::getTile(int x, int y, int width, int height)
 	f->isGL = isGL;
 	bool bu = (flags & FRAME_BOTTOMUP);
 	f->bits = &bits[pitch * (bu ? hdr.height - y - height : y) + pf->size * x];
+	f->rbits = NULL;
 	if(stereo && rbits)
 		f->rbits =
 			&rbits[pitch * (bu ? hdr.height - y - height : y) + pf->size * x];
@@ -143,63 +191,328 @@ Frame *Frame::getTile(int x, int y, int width, int height)
 }
 
 
-bool Frame::tileEquals(Frame *last, int x, int y, int width, int height)
+// Compare a rectangular region of two buffers.  This is memory-bound, so the
+// SIMD loops simply need to keep up with the memory bus without incurring the
+// per-row call overhead of memcmp().
+
+#ifdef USEAVX2
+
+__attribute__((target("avx2")))
+static bool regionEqualsAVX2(unsigned char *newBits, int newPitch,
+	unsigned char *oldBits, int oldPitch, int rowSize, int height)
 {
-	bool bu = (flags & FRAME_BOTTOMUP);
+	for(int i = 0; i < height; i++, newBits += newPitch, oldBits += oldPitch)
+	{
+		int j = 0;
 
-	if(x < 0 || y < 0 || width < 1 || height < 1 || (x + width) > hdr.width
-		|| (y + height) > hdr.height)
-		throw Error("Frame::tileEquals", "Argument out of range");
+		for(; j <= rowSize - 128; j += 128)
+		{
+			__m256i diff = _mm256_or_si256(
+				_mm256_or_si256(
+					_mm256_xor_si256(_mm256_loadu_si256((__m256i *)&newBits[j]),
+						_mm256_loadu_si256((__m256i *)&oldBits[j])),
+					_mm256_xor_si256(_mm256_loadu_si256((__m256i *)&newBits[j + 32]),
+						_mm256_loadu_si256((__m256i *)&oldBits[j + 32]))),
+				_mm256_or_si256(
+					_mm256_xor_si256(_mm256_loadu_si256((__m256i *)&newBits[j + 64]),
+						_mm256_loadu_si256((__m256i *)&oldBits[j + 64])),
+					_mm256_xor_si256(_mm256_loadu_si256((__m256i *)&newBits[j + 96]),
+						_mm256_loadu_si256((__m256i *)&oldBits[j + 96]))));
+			if(!_mm256_testz_si256(diff, diff)) return false;
+		}
+		for(; j <= rowSize - 32; j += 32)
+		{
+			__m256i diff =
+				_mm256_xor_si256(_mm256_loadu_si256((__m256i *)&newBits[j]),
+					_mm256_loadu_si256((__m256i *)&oldBits[j]));
+			if(!_mm256_testz_si256(diff, diff)) return false;
+		}
+		if(j < rowSize && memcmp(&newBits[j], &oldBits[j], rowSize - j))
+			return false;
+	}
+	return true;
+}
 
-	if(last && hdr.width == last->hdr.width && hdr.height == last->hdr.height
-		&& hdr.framew == last->hdr.framew && hdr.frameh == last->hdr.frameh
-		&& hdr.qual == last->hdr.qual && hdr.subsamp == last->hdr.subsamp
-		&& pf->id == last->pf->id && pf->size == last->pf->size
-		&& hdr.winid == last->hdr.winid && hdr.dpynum == last->hdr.dpynum)
+#endif
+
+static bool regionEquals(unsigned char *newBits, int newPitch,
+	unsigned char *oldBits, int oldPitch, int rowSize, int height)
+{
+	#ifdef USEAVX2
+	static int hasAVX2 = -1;
+	if(hasAVX2 < 0) hasAVX2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+	if(hasAVX2)
+		return regionEqualsAVX2(newBits, newPitch, oldBits, oldPitch, rowSize,
+			height);
+	#endif
+
+	for(int i = 0; i < height; i++, newBits += newPitch, oldBits += oldPitch)
 	{
-		if(bits && last->bits)
+		int j = 0;
+
+		#if defined(__SSE2__)
+		for(; j <= rowSize - 64; j += 64)
 		{
-			unsigned char *newBits =
-				&bits[pitch * (bu ? hdr.height - y - height : y) + pf->size * x];
-			unsigned char *oldBits =
-				&last->bits[last->pitch * (bu ? hdr.height - y - height : y) +
-					pf->size * x];
-			for(int i = 0; i < height; i++)
+			__m128i diff = _mm_or_si128(
+				_mm_or_si128(
+					_mm_xor_si128(_mm_loadu_si128((__m128i *)&newBits[j]),
+						_mm_loadu_si128((__m128i *)&oldBits[j])),
+					_mm_xor_si128(_mm_loadu_si128((__m128i *)&newBits[j + 16]),
+						_mm_loadu_si128((__m128i *)&oldBits[j + 16]))),
+				_mm_or_si128(
+					_mm_xor_si128(_mm_loadu_si128((__m128i *)&newBits[j + 32]),
+						_mm_loadu_si128((__m128i *)&oldBits[j + 32])),
+					_mm_xor_si128(_mm_loadu_si128((__m128i *)&newBits[j + 48]),
+						_mm_loadu_si128((__m128i *)&oldBits[j + 48]))));
+			if(_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128()))
+				!= 0xFFFF)
+				return false;
+		}
+		#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		for(; j <= rowSize - 64; j += 64)
+		{
+			uint8x16_t diff = vorrq_u8(
+				vorrq_u8(veorq_u8(vld1q_u8(&newBits[j]), vld1q_u8(&oldBits[j])),
+					veorq_u8(vld1q_u8(&newBits[j + 16]), vld1q_u8(&oldBits[j + 16]))),
+				vorrq_u8(
+					veorq_u8(vld1q_u8(&newBits[j + 32]), vld1q_u8(&oldBits[j + 32])),
+					veorq_u8(vld1q_u8(&newBits[j + 48]),
+						vld1q_u8(&oldBits[j + 48]))));
+			uint64x2_t diff64 = vreinterpretq_u64_u8(diff);
+			if(vgetq_lane_u64(diff64, 0) | vgetq_lane_u64(diff64, 1)) return false;
+		}
+		#endif
+		if(j < rowSize && memcmp(&newBits[j], &oldBits[j], rowSize - j))
+			return false;
+	}
+	return true;
+}
+
+
+// 64-bit hash of a rectangular region, using the accumulate/scramble
+// construction from XXH3.  Each 64-byte block of a row is accumulated into
+// eight 64-bit lanes, using a key that varies with the block's position in the
+// row, and the lanes are scrambled at the end of each row, so the hash is
+// sensitive to the position of each block as well as its contents.  The SSE2
+// and C implementations produce identical results.
+
+#define PRIME32_1  0x9E3779B1ULL
+#define PRIME64_1  0x9E3779B185EBCA87ULL
+#define PRIME64_2  0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3  0x165667B19E3779F9ULL
+
+static const unsigned long long hashKey[8] =
+{
+	0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL,
+	0x1F67B3B7A4A44072ULL, 0x78E5C0CC4EE679CBULL, 0x2172FFCC7DD05A82ULL,
+	0x8E2443F7744608B8ULL, 0x4C263A81E69035E0ULL
+};
+
+static inline unsigned long long load64(const unsigned char *ptr)
+{
+	unsigned long long val;
+	memcpy(&val, ptr, 8);
+	return val;
+}
+
+static inline void accumulate(unsigned long long &acc, unsigned long long data,
+	unsigned long long swapData, unsigned long long key)
+{
+	unsigned long long dataKey = data ^ key;
+	acc += (dataKey & 0xFFFFFFFFULL) * (dataKey >> 32) + swapData;
+}
+
+static unsigned long long regionHash(unsigned char *bits, int pitch,
+	int rowSize, int height, unsigned long long seed)
+{
+	unsigned long long acc[8];
+	int k;
+
+	for(k = 0; k < 8; k++) acc[k] = seed + hashKey[k] * (k + 1);
+
+	for(int i = 0; i < height; i++, bits += pitch)
+	{
+		int j = 0;
+		unsigned long long block = 0;
+
+		#if defined(__SSE2__)
+		__m128i vacc[4], vkey[4];
+		const __m128i vinc = _mm_set1_epi64x((long long)PRIME64_1);
+		for(k = 0; k < 4; k++)
+		{
+			vacc[k] = _mm_loadu_si128((__m128i *)&acc[k * 2]);
+			vkey[k] = _mm_loadu_si128((__m128i *)&hashKey[k * 2]);
+		}
+		for(; j <= rowSize - 64; j += 64, block++)
+		{
+			for(k = 0; k < 4; k++)
 			{
-				if(memcmp(&newBits[pitch * i], &oldBits[last->pitch * i],
-					pf->size * width))
-					return false;
+				__m128i data = _mm_loadu_si128((__m128i *)&bits[j + k * 16]);
+				__m128i dataKey = _mm_xor_si128(data, vkey[k]);
+				__m128i product = _mm_mul_epu32(dataKey,
+					_mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+				vacc[k] = _mm_add_epi64(vacc[k], _mm_add_epi64(product,
+					_mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))));
+				vkey[k] = _mm_add_epi64(vkey[k], vinc);
 			}
 		}
-		if(stereo && rbits && last->rbits)
+		for(k = 0; k < 4; k++) _mm_storeu_si128((__m128i *)&acc[k * 2], vacc[k]);
+		#else
+		for(; j <= rowSize - 64; j += 64, block++)
 		{
-			unsigned char *newBits =
-				&rbits[pitch * (bu ? hdr.height - y - height : y) + pf->size * x];
-			unsigned char *oldBits =
-				&last->rbits[last->pitch * (bu ? hdr.height - y - height : y) +
-					pf->size * x];
-			for(int i = 0; i < height; i++)
+			for(k = 0; k < 8; k += 2)
 			{
-				if(memcmp(&newBits[pitch * i], &oldBits[last->pitch * i],
-					pf->size * width))
-					return false;
+				unsigned long long data0 = load64(&bits[j + k * 8]),
+					data1 = load64(&bits[j + k * 8 + 8]);
+				accumulate(acc[k], data0, data1, hashKey[k] + block * PRIME64_1);
+				accumulate(acc[k + 1], data1, data0,
+					hashKey[k + 1] + block * PRIME64_1);
 			}
 		}
+		#endif
+
+		// Remaining 8-byte words, and then any remaining bytes
+		for(k = 0; j <= rowSize - 8; j += 8, k++)
+		{
+			unsigned long long data = load64(&bits[j]);
+			accumulate(acc[k], data, data, hashKey[k] + block * PRIME64_1);
+		}
+		if(j < rowSize)
+		{
+			unsigned long long data = 0;
+			memcpy(&data, &bits[j], rowSize - j);
+			accumulate(acc[k], data, (unsigned long long)(rowSize - j),
+				hashKey[k] + block * PRIME64_1);
+		}
+
+		for(k = 0; k < 8; k++)
+			acc[k] = (acc[k] ^ (acc[k] >> 47) ^ hashKey[k]) * PRIME32_1;
+	}
+
+	unsigned long long hash =
+		seed + (unsigned long long)rowSize * (unsigned long long)height * PRIME64_1;
+	for(k = 0; k < 8; k++)
+	{
+		unsigned long long lane = acc[k] * PRIME64_2;
+		hash = (hash ^ (lane ^ (lane >> 31))) * PRIME64_1;
+	}
+	hash ^= hash >> 33;  hash *= PRIME64_2;
+	hash ^= hash >> 29;  hash *= PRIME64_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+
+// Reset the per-tile hashes prior to comparing a new frame.  This must be
+// called from a single thread before any calls to tileEquals() with a hash
+// index, since each call to tileEquals() writes only the hash slot that
+// corresponds to its tile.
+void Frame::initTileHashes(int nTiles)
+{
+	if(nTiles < 0) throw(Error("Frame::initTileHashes", "Invalid argument"));
+	if(nTiles > maxTileHashes)
+	{
+		TileHash *newTileHashes =
+			(TileHash *)realloc(tileHashes, sizeof(TileHash) * nTiles);
+		if(!newTileHashes) THROW("Memory allocation error");
+		tileHashes = newTileHashes;  maxTileHashes = nTiles;
+	}
+	if(nTiles) memset(tileHashes, 0, sizeof(TileHash) * nTiles);
+	nTileHashes = nTiles;
+}
+
+
+// If hashIndex >= 0, then a hash of the tile is computed and stored in the
+// corresponding slot (see initTileHashes()), and the tile is compared with the
+// previous frame by comparing only the hashes, if the previous frame has a
+// hash for the same tile.  Otherwise, the pixels are compared directly.  If
+// this frame was derived from the previous frame and the tile lies outside of
+// the damaged region, then the tile is known to be unchanged without comparing
+// it at all.
+bool Frame::tileEquals(Frame *last, int x, int y, int width, int height,
+	int hashIndex)
+{
+	bool bu = (flags & FRAME_BOTTOMUP);
+	TileHash *th = NULL;
+
+	if(x < 0 || y < 0 || width < 1 || height < 1 || (x + width) > hdr.width
+		|| (y + height) > hdr.height || hashIndex >= nTileHashes)
+		throw Error("Frame::tileEquals", "Argument out of range");
+
+	bool sameFormat = (last && hdr.width == last->hdr.width
+		&& hdr.height == last->hdr.height && hdr.framew == last->hdr.framew
+		&& hdr.frameh == last->hdr.frameh && hdr.qual == last->hdr.qual
+		&& hdr.subsamp == last->hdr.subsamp && pf->id == last->pf->id
+		&& pf->size == last->pf->size && hdr.winid == last->hdr.winid
+		&& hdr.dpynum == last->hdr.dpynum);
+
+	if(sameFormat && damageBase == last
+		&& (x >= damageX + damageWidth || x + width <= damageX
+			|| y >= damageY + damageHeight || y + height <= damageY))
+	{
+		if(hashIndex >= 0 && hashIndex < last->nTileHashes)
+			tileHashes[hashIndex] = last->tileHashes[hashIndex];
+		return true;
+	}
+
+	int offset = pitch * (bu ? hdr.height - y - height : y) + pf->size * x;
+
+	if(hashIndex >= 0 && bits)
+	{
+		th = &tileHashes[hashIndex];
+		th->x = x;  th->y = y;  th->width = width;  th->height = height;
+		th->hash = regionHash(&bits[offset], pitch, pf->size * width, height, 0);
+		if(stereo && rbits)
+			th->hash = regionHash(&rbits[offset], pitch, pf->size * width, height,
+				th->hash);
+		th->valid = true;
+	}
+
+	if(sameFormat)
+	{
+		if(th && hashIndex < last->nTileHashes
+			&& (stereo && rbits) == (last->stereo && last->rbits))
+		{
+			TileHash *lastth = &last->tileHashes[hashIndex];
+			if(lastth->valid && lastth->x == x && lastth->y == y
+				&& lastth->width == width && lastth->height == height)
+				return lastth->hash == th->hash;
+		}
+
+		int lastOffset =
+			last->pitch * (bu ? hdr.height - y - height : y) + pf->size * x;
+
+		if(bits && last->bits
+			&& !regionEquals(&bits[offset], pitch, &last->bits[lastOffset],
+				last->pitch, pf->size * width, height))
+			return false;
+		if(stereo && rbits && last->rbits
+			&& !regionEquals(&rbits[offset], pitch, &last->rbits[lastOffset],
+				last->pitch, pf->size * width, height))
+			return false;
 		return true;
 	}
 	return false;
 }
 
 
-void Frame::makeAnaglyph(Frame &r, Frame &g, Frame &b)
+// The stereo generation methods operate on rows [startRow, endRow) of the
+// frame, so that the rows can be divided among multiple threads.
+
+void Frame::makeAnaglyph(Frame &r, Frame &g, Frame &b, int startRow,
+	int endRow)
 {
 	int i, j;
-	unsigned char *srcrptr = r.bits, *srcgptr = g.bits, *srcbptr = b.bits,
-		*dstptr = bits, *dstrptr, *dstgptr, *dstbptr;
 
 	if(pf->bpc != 8) THROW("Anaglyphic stereo requires 8 bits per component");
+	if(endRow < 0) endRow = hdr.frameh;
+
+	unsigned char *srcrptr = &r.bits[r.pitch * startRow],
+		*srcgptr = &g.bits[g.pitch * startRow],
+		*srcbptr = &b.bits[b.pitch * startRow],
+		*dstptr = &bits[pitch * startRow], *dstrptr, *dstgptr, *dstbptr;
 
-	for(j = 0; j < hdr.frameh; j++, srcrptr += r.pitch, srcgptr += g.pitch,
+	for(j = startRow; j < endRow; j++, srcrptr += r.pitch, srcgptr += g.pitch,
 		srcbptr += b.pitch, dstptr += pitch)
 	{
 		for(i = 0, dstrptr = &dstptr[pf->rindex], dstgptr = &dstptr[pf->gindex],
@@ -213,19 +526,21 @@ void Frame::makeAnaglyph(Frame &r, Frame &g, Frame &b)
 }
 
 
-void Frame::makePassive(Frame &stf, int mode)
+void Frame::makePassive(Frame &stf, int mode, int startRow, int endRow)
 {
-	unsigned char *srclptr = stf.bits, *srcrptr = stf.rbits;
-	unsigned char *dstptr = bits;
-
 	if(hdr.framew != stf.hdr.framew || hdr.frameh != stf.hdr.frameh
 		|| pitch != stf.pitch)
 		THROW("Frames are not the same size");
+	if(endRow < 0) endRow = hdr.frameh;
+
+	unsigned char *srclptr = &stf.bits[pitch * startRow],
+		*srcrptr = &stf.rbits[pitch * startRow];
+	unsigned char *dstptr = &bits[pitch * startRow];
 
 	if(mode == RRSTEREO_INTERLEAVED)
 	{
 		int rowSize = pf->size * hdr.framew;
-		for(int j = 0; j < hdr.frameh; j++)
+		for(int j = startRow; j < endRow; j++)
 		{
 			if(j % 2 == 0) memcpy(dstptr, srclptr, rowSize);
 			else memcpy(dstptr, srcrptr, rowSize);
@@ -234,22 +549,21 @@ void Frame::makePassive(Frame &stf, int mode)
 	}
 	else if(mode == RRSTEREO_TOPBOTTOM)
 	{
-		int rowSize = pf->size * hdr.framew;
-		srcrptr += pitch;
-		for(int j = 0; j < (hdr.frameh + 1) / 2; j++)
-		{
-			memcpy(dstptr, srclptr, rowSize);
-			srclptr += pitch * 2;  dstptr += pitch;
-		}
-		for(int j = (hdr.frameh + 1) / 2; j < hdr.frameh; j++)
+		// Row j of the top half comes from row j * 2 of the left eye buffer, and
+		// row j of the bottom half comes from row (j - half) * 2 + 1 of the right
+		// eye buffer.
+		int rowSize = pf->size * hdr.framew, half = (hdr.frameh + 1) / 2;
+		for(int j = startRow; j < endRow; j++)
 		{
-			memcpy(dstptr, srcrptr, rowSize);
-			srcrptr += pitch * 2;  dstptr += pitch;
+			if(j < half) memcpy(dstptr, &stf.bits[pitch * j * 2], rowSize);
+			else
+				memcpy(dstptr, &stf.rbits[pitch * ((j - half) * 2 + 1)], rowSize);
+			dstptr += pitch;
 		}
 	}
 	else if(mode == RRSTEREO_SIDEBYSIDE)
 	{
-		int pad = pitch - hdr.framew * pf->size, h = hdr.frameh;
+		int pad = pitch - hdr.framew * pf->size, h = endRow - startRow;
 		while(h > 0)
 		{
 			unsigned char *srclptr2 = srclptr;
@@ -300,6 +614,245 @@ void Frame::decompressRGB(Frame &f, int width, int height, bool rightEye)
 }
 
 
+// Lossless encoding
+//
+// Each tile is converted into a stream of packed 24-bit RGB pixels in
+// bottom-up order (the same order used by RGB encoding), and the stream is
+// encoded as a series of operations that predict pixels from the previous
+// pixel or the pixel in the previous row.  Each operation begins with a
+// control byte whose upper 2 bits specify the operation and whose lower 6 bits
+// specify the pixel count - 1.  If the lower 6 bits are all 1, then the pixel
+// count - 64 follows in 2 bytes (little-endian.)
+//
+// LL_LITERAL = count pixels follow (3 bytes per pixel, R, G, B)
+// LL_RUN = repeat the previous pixel (black at the start of the tile)
+// LL_COPYUP = copy the pixels from the previous row
+// LL_DELTA = add a constant (3 bytes, R, G, B, each modulo 256) to the pixels
+//            from the previous row
+//
+// Synthetic imagery consists mostly of flat regions and smooth gradients, which
+// reduce to runs of the last three operations.
+
+#define LL_LITERAL  0
+#define LL_RUN  1
+#define LL_COPYUP  2
+#define LL_DELTA  3
+#define LL_MAXCOUNT  (64 + 65535)
+
+// Worst case:  3 bytes per pixel, plus at most 4 bytes of control bytes for
+// every 64 pixels (for instance, a 64-pixel literal followed by a 1-pixel run
+// costs 196 bytes for 65 pixels.)
+#define LL_BUFSIZE(w, h) \
+	((unsigned long)(w) * (h) * 3 + ((unsigned long)(w) * (h) / 64 + 1) * 4)
+
+// Per-component subtraction and addition (modulo 256) of packed RGB pixels
+#define LL_H  0x808080U
+#define LL_SUB(a, b)  ((((a) | LL_H) - ((b) & ~LL_H)) ^ (((a) ^ ~(b)) & LL_H))
+#define LL_ADD(a, b) \
+	((((a) & ~LL_H) + ((b) & ~LL_H)) ^ (((a) ^ (b)) & LL_H))
+
+// The packed pixels are stored as RGBX on little-endian systems and XBGR on
+// big-endian systems, so R is always the least significant byte.
+#define LL_PF  (LittleEndian() ? PF_RGBX : PF_XBGR)
+
+
+static inline unsigned char *llPutOp(unsigned char *dst, int op, int count)
+{
+	count--;
+	if(count < 63) *dst++ = (unsigned char)((op << 6) | count);
+	else
+	{
+		count -= 63;
+		*dst++ = (unsigned char)((op << 6) | 63);
+		*dst++ = (unsigned char)(count & 0xFF);
+		*dst++ = (unsigned char)(count >> 8);
+	}
+	return dst;
+}
+
+
+static unsigned char *llPutLiteral(unsigned char *dst, unsigned int *pixels,
+	int count)
+{
+	while(count > 0)
+	{
+		int n = min(count, LL_MAXCOUNT);
+		dst = llPutOp(dst, LL_LITERAL, n);
+		for(int i = 0; i < n; i++)
+		{
+			unsigned int pixel = pixels[i];
+			*dst++ = (unsigned char)pixel;
+			*dst++ = (unsigned char)(pixel >> 8);
+			*dst++ = (unsigned char)(pixel >> 16);
+		}
+		pixels += n;  count -= n;
+	}
+	return dst;
+}
+
+
+// Encode the packed pixels of a width x height tile and return the number of
+// bytes written to dst, which must hold at least LL_BUFSIZE(width, height)
+// bytes.
+static unsigned int llEncode(unsigned int *pixels, int width, int height,
+	unsigned char *dst)
+{
+	unsigned char *dstStart = dst;
+	int n = width * height, p = 0, literalStart = 0;
+
+	while(p < n)
+	{
+		unsigned int prev = p > 0 ? pixels[p - 1] : 0;
+		int maxCount = min(n - p, LL_MAXCOUNT), run = 0, up = 0, op, count;
+
+		while(run < maxCount && pixels[p + run] == prev) run++;
+		if(p >= width)
+			while(up < maxCount && pixels[p + up] == pixels[p + up - width]) up++;
+
+		if(run > 0 || up > 0)
+		{
+			op = run >= up ? LL_RUN : LL_COPYUP;
+			count = max(run, up);
+		}
+		else if(p >= width)
+		{
+			// A delta operation costs as much as a literal pixel, so it is only
+			// worthwhile if it covers at least two pixels.
+			unsigned int delta = LL_SUB(pixels[p], pixels[p - width]) & 0xFFFFFF;
+			count = 1;
+			while(count < maxCount && (LL_SUB(pixels[p + count],
+				pixels[p + count - width]) & 0xFFFFFF) == delta)
+				count++;
+			if(count < 2) { p++;  continue; }
+			dst = llPutLiteral(dst, &pixels[literalStart], p - literalStart);
+			dst = llPutOp(dst, LL_DELTA, count);
+			*dst++ = (unsigned char)delta;
+			*dst++ = (unsigned char)(delta >> 8);
+			*dst++ = (unsigned char)(delta >> 16);
+			p += count;  literalStart = p;
+			continue;
+		}
+		else { p++;  continue; }
+
+		dst = llPutLiteral(dst, &pixels[literalStart], p - literalStart);
+		dst = llPutOp(dst, op, count);
+		p += count;  literalStart = p;
+	}
+	dst = llPutLiteral(dst, &pixels[literalStart], p - literalStart);
+
+	return (unsigned int)(dst - dstStart);
+}
+
+
+// Decode a lossless-encoded width x height tile into packed pixels
+static void llDecode(unsigned char *src, unsigned int size, int width,
+	int height, unsigned int *pixels)
+{
+	unsigned char *srcEnd = &src[size];
+	int n = width * height, p = 0;
+
+	while(p < n)
+	{
+		if(src >= srcEnd) THROW("Lossless image is truncated");
+		int op = *src >> 6, count = (*src & 63) + 1;
+		src++;
+		if(count == 64)
+		{
+			if(srcEnd - src < 2) THROW("Lossless image is truncated");
+			count += src[0] | (src[1] << 8);
+			src += 2;
+		}
+		if(count > n - p) THROW("Lossless image is corrupt");
+
+		switch(op)
+		{
+			case LL_LITERAL:
+				if(srcEnd - src < count * 3) THROW("Lossless image is truncated");
+				for(int i = 0; i < count; i++, src += 3)
+					pixels[p++] = src[0] | (src[1] << 8) | (src[2] << 16);
+				break;
+			case LL_RUN:
+			{
+				unsigned int prev = p > 0 ? pixels[p - 1] : 0;
+				for(int i = 0; i < count; i++) pixels[p++] = prev;
+				break;
+			}
+			case LL_COPYUP:
+				if(p < width) THROW("Lossless image is corrupt");
+				for(int i = 0; i < count; i++, p++) pixels[p] = pixels[p - width];
+				break;
+			case LL_DELTA:
+			{
+				if(p < width) THROW("Lossless image is corrupt");
+				if(srcEnd - src < 3) THROW("Lossless image is truncated");
+				unsigned int delta = src[0] | (src[1] << 8) | (src[2] << 16);
+				src += 3;
+				for(int i = 0; i < count; i++, p++)
+					pixels[p] = LL_ADD(pixels[p - width], delta) & 0xFFFFFF;
+				break;
+			}
+		}
+	}
+}
+
+
+void Frame::decompressLossless(CompressedFrame &cf, int width, int height,
+	bool rightEye)
+{
+	unsigned char *srcbits = rightEye ? cf.rbits : cf.bits;
+	unsigned int size = rightEye ? cf.rhdr.size : cf.hdr.size;
+
+	if(!srcbits || size < 1 || !bits || !hdr.size)
+		THROW("Frame not initialized");
+	if(pf->bpc < 8)
+		throw(Error("Lossless decompressor",
+			"Destination frame has the wrong pixel format"));
+	if(width != cf.hdr.width || height != cf.hdr.height)
+		THROW("Invalid argument");
+
+	unsigned int *pixels = cf.getPixelBuf((unsigned long)width * height);
+	llDecode(srcbits, size, width, height, pixels);
+
+	bool dstbu = (flags & FRAME_BOTTOMUP);
+	int srcStride = width * 4, dstStride = pitch;
+	int startLine = dstbu ? max(0, hdr.frameh - cf.hdr.y - height) : cf.hdr.y;
+	unsigned char *srcptr = (unsigned char *)pixels,
+		*dstptr = rightEye ? &rbits[pitch * startLine + cf.hdr.x * pf->size] :
+			&bits[pitch * startLine + cf.hdr.x * pf->size];
+
+	if(!dstbu)
+	{
+		srcptr = &srcptr[(height - 1) * srcStride];  srcStride = -srcStride;
+	}
+	pf_get(LL_PF)->convert(srcptr, width, srcStride, height, dstptr, dstStride,
+		pf);
+}
+
+
+void Frame::decompressJPEG(CompressedFrame &cf, tjhandle handle, int width,
+	int height, bool rightEye)
+{
+	unsigned char *srcbits = rightEye ? cf.rbits : cf.bits;
+	unsigned int size = rightEye ? cf.rhdr.size : cf.hdr.size;
+
+	if(!srcbits || size < 1 || !bits || !hdr.size)
+		THROW("Frame not initialized");
+	if(pf->bpc != 8)
+		throw(Error("JPEG decompressor",
+			"JPEG decompression requires 8 bits per component"));
+	if(!handle) THROW("Invalid argument");
+
+	bool dstbu = (flags & FRAME_BOTTOMUP);
+	int startLine = dstbu ? max(0, hdr.frameh - cf.hdr.y - height) : cf.hdr.y;
+	unsigned char *dstptr =
+		rightEye ? &rbits[pitch * startLine + cf.hdr.x * pf->size] :
+			&bits[pitch * startLine + cf.hdr.x * pf->size];
+
+	TRY_TJ(tjDecompress2(handle, srcbits, size, dstptr, width, pitch, height,
+		tjpf[pf->id], dstbu ? TJFLAG_BOTTOMUP : 0));
+}
+
+
 #define DRAWLOGO() \
 	switch(pf->size) \
 	{ \
@@ -386,6 +939,7 @@ void Frame::dumpHeader(rrframeheader &h)
 	vglout.print("hdr.qual    = %d\n", h.qual);
 	vglout.print("hdr.subsamp = %d\n", h.subsamp);
 	vglout.print("hdr.flags   = %d\n", h.flags);
+	vglout.print("hdr.frameid = %u\n", h.frameid);
 }
 
 
@@ -401,7 +955,8 @@ void Frame::checkHeader(rrframeheader &h)
 
 // Compressed frame
 
-CompressedFrame::CompressedFrame(void) : Frame(), tjhnd(NULL)
+CompressedFrame::CompressedFrame(void) : Frame(), allocs(0), tjhnd(NULL),
+	bitsSize(0), rbitsSize(0), pixelBuf(NULL), pixelBufSize(0)
 {
 	if(!(tjhnd = tjInitCompress())) THROW(tjGetErrorStr());
 	pf = pf_get(PF_RGB);
@@ -412,6 +967,7 @@ CompressedFrame::CompressedFrame(void) : Frame(), tjhnd(NULL)
 CompressedFrame::~CompressedFrame(void)
 {
 	if(tjhnd) tjDestroy(tjhnd);
+	delete [] pixelBuf;
 }
 
 CompressedFrame &CompressedFrame::operator= (Frame &f)
@@ -425,6 +981,7 @@ CompressedFrame &CompressedFrame::operator= (Frame &f)
 		case RRCOMP_RGB:  compressRGB(f);  break;
 		case RRCOMP_JPEG:  compressJPEG(f);  break;
 		case RRCOMP_YUV:  compressYUV(f);  break;
+		case RRCOMP_LOSSLESS:  compressLossless(f);  break;
 		default:  THROW("Invalid compression type");
 	}
 	return *this;
@@ -508,40 +1065,96 @@ void CompressedFrame::compressRGB(Frame &f)
 }
 
 
+void CompressedFrame::compressLossless(Frame &f)
+{
+	unsigned char *srcptr;
+	bool bu = (f.flags & FRAME_BOTTOMUP);
+
+	if(f.pf->bpc != 8)
+		throw(Error("Lossless compressor",
+			"Lossless encoding requires 8 bits per component"));
+
+	int width = f.hdr.width, height = f.hdr.height;
+	int srcStride = bu ? f.pitch : -f.pitch;
+	unsigned int *pixels = getPixelBuf((unsigned long)width * height);
+	PF *llpf = pf_get(LL_PF);
+
+	init(f.hdr, f.stereo ? RR_LEFT : 0);
+	srcptr = bu ? f.bits : &f.bits[f.pitch * (height - 1)];
+	f.pf->convert(srcptr, width, srcStride, height, (unsigned char *)pixels,
+		width * 4, llpf);
+	for(int i = 0; i < width * height; i++) pixels[i] &= 0xFFFFFF;
+	hdr.size = llEncode(pixels, width, height, bits);
+
+	if(f.stereo && f.rbits)
+	{
+		init(f.hdr, RR_RIGHT);
+		if(rbits)
+		{
+			srcptr = bu ? f.rbits : &f.rbits[f.pitch * (height - 1)];
+			f.pf->convert(srcptr, width, srcStride, height, (unsigned char *)pixels,
+				width * 4, llpf);
+			for(int i = 0; i < width * height; i++) pixels[i] &= 0xFFFFFF;
+			rhdr.size = llEncode(pixels, width, height, rbits);
+		}
+	}
+}
+
+
+// The scratch buffer is reallocated only if it is too small, for the same
+// reason as the image buffers.
+unsigned int *CompressedFrame::getPixelBuf(unsigned long count)
+{
+	if(count > pixelBufSize || !pixelBuf)
+	{
+		delete [] pixelBuf;
+		pixelBuf = new unsigned int[count];  pixelBufSize = count;  allocs++;
+	}
+	return pixelBuf;
+}
+
+
+// The image buffers are reallocated only if they are too small to hold the
+// largest possible compressed image with the new dimensions, so a
+// CompressedFrame instance can be reused for tiles of varying sizes without
+// incurring a heap round trip for each tile.
 void CompressedFrame::init(rrframeheader &h, int buffer)
 {
 	checkHeader(h);
 	if(h.flags == RR_EOF) { hdr = h;  return; }
+	unsigned long bufSize = tjBufSize(h.width, h.height, h.subsamp);
+	if(h.compress == RRCOMP_LOSSLESS)
+		bufSize = max(bufSize, LL_BUFSIZE(h.width, h.height));
 	switch(buffer)
 	{
 		case RR_LEFT:
-			if(h.width != hdr.width || h.height != hdr.height || !bits)
+			if(bufSize > bitsSize || !bits)
 			{
 				delete [] bits;
-				bits = new unsigned char[tjBufSize(h.width, h.height, h.subsamp)];
+				bits = new unsigned char[bufSize];  bitsSize = bufSize;  allocs++;
 			}
 			hdr = h;  hdr.flags = RR_LEFT;  stereo = true;
 			break;
 		case RR_RIGHT:
-			if(h.width != rhdr.width || h.height != rhdr.height || !rbits)
+			if(bufSize > rbitsSize || !rbits)
 			{
 				delete [] rbits;
-				rbits = new unsigned char[tjBufSize(h.width, h.height, h.subsamp)];
+				rbits = new unsigned char[bufSize];  rbitsSize = bufSize;  allocs++;
 			}
 			rhdr = h;  rhdr.flags = RR_RIGHT;  stereo = true;
 			break;
 		default:
-			if(h.width != hdr.width || h.height != hdr.height || !bits)
+			if(bufSize > bitsSize || !bits)
 			{
 				delete [] bits;
-				bits = new unsigned char[tjBufSize(h.width, h.height, h.subsamp)];
+				bits = new unsigned char[bufSize];  bitsSize = bufSize;  allocs++;
 			}
 			hdr = h;  hdr.flags = 0;  stereo = false;
 			break;
 	}
 	if(!stereo && rbits)
 	{
-		delete [] rbits;  rbits = NULL;
+		delete [] rbits;  rbits = NULL;  rbitsSize = 0;
 		memset(&rhdr, 0, sizeof(rrframeheader));
 	}
 	pitch = hdr.width * pf->size;
@@ -633,11 +1246,28 @@ void FBXFrame::init(rrframeheader &h)
 
 FBXFrame &FBXFrame::operator= (CompressedFrame &cf)
 {
-	int tjflags = 0;
-
 	if(!cf.bits || cf.hdr.size < 1)
 		THROW("JPEG not initialized");
 	init(cf.hdr);
+	if(cf.hdr.compress != RRCOMP_RGB && cf.hdr.compress != RRCOMP_LOSSLESS
+		&& !tjhnd)
+	{
+		if((tjhnd = tjInitDecompress()) == NULL)
+			throw(Error("FBXFrame::decompressor", tjGetErrorStr()));
+	}
+	decompress(cf, tjhnd);
+	return *this;
+}
+
+
+// Decompress a tile into a frame that has already been initialized with the
+// tile's frame dimensions.  Different tiles of the same frame can be
+// decompressed concurrently, as long as each thread uses its own TurboJPEG
+// instance.
+void FBXFrame::decompress(CompressedFrame &cf, tjhandle handle)
+{
+	if(!cf.bits || cf.hdr.size < 1)
+		THROW("JPEG not initialized");
 	if(!fb.xi) THROW("Frame not initialized");
 
 	int width = min(cf.hdr.width, fb.width - cf.hdr.x);
@@ -646,29 +1276,105 @@ FBXFrame &FBXFrame::operator= (CompressedFrame &cf)
 		&& cf.hdr.height <= height)
 	{
 		if(cf.hdr.compress == RRCOMP_RGB) decompressRGB(cf, width, height, false);
-		else
+		else if(cf.hdr.compress == RRCOMP_LOSSLESS)
+			decompressLossless(cf, width, height, false);
+		else decompressJPEG(cf, handle, width, height, false);
+	}
+}
+
+
+void FBXFrame::redraw(void)
+{
+	if(flags & FRAME_BOTTOMUP) TRY_FBX(fbx_flip(&fb, 0, 0, 0, 0));
+	TRY_FBX(fbx_write(&fb, 0, 0, 0, 0, fb.width, fb.height));
+}
+
+
+// Draw only the tiles that differ from the corresponding tiles in last, which
+// must contain the pixels that are currently displayed in the drawable, and
+// copy those tiles into last so that it continues to mirror the drawable.  If
+// last has a different size or format than this frame, then the whole frame is
+// drawn.  Tiles at the right and bottom edges of the frame are extended in the
+// same manner as in the VGL Transport, and runs of adjacent changed tiles
+// within a row are drawn with a single request.
+void FBXFrame::redraw(Frame &last, int tileSize)
+{
+	if(flags & FRAME_BOTTOMUP)
+	{
+		TRY_FBX(fbx_flip(&fb, 0, 0, 0, 0));
+		flags &= ~FRAME_BOTTOMUP;
+	}
+
+	if(!last.bits || last.hdr.width != hdr.width
+		|| last.hdr.height != hdr.height || last.pf->id != pf->id
+		|| hdr.width != fb.width || hdr.height != fb.height)
+	{
+		TRY_FBX(fbx_write(&fb, 0, 0, 0, 0, fb.width, fb.height));
+		rrframeheader h = hdr;
+		last.init(h, pf->id, 0);
+		for(int i = 0; i < hdr.height; i++)
+			memcpy(&last.bits[last.pitch * i], &bits[pitch * i],
+				pf->size * hdr.width);
+		return;
+	}
+
+	int tileSizeX = tileSize > 0 ? tileSize : hdr.width;
+	int tileSizeY = tileSize > 0 ? tileSize : hdr.height;
+	bool drawn = false;
+
+	for(int i = 0; i < hdr.height; i += tileSizeY)
+	{
+		int height = tileSizeY, y = i, runX = -1;
+
+		if(hdr.height - i < (3 * tileSizeY / 2))
 		{
-			if(pf->bpc != 8)
-				throw(Error("JPEG decompressor",
-					"JPEG decompression requires 8 bits per component"));
-			if(!tjhnd)
+			height = hdr.height - i;  i += tileSizeY;
+		}
+		for(int j = 0; j < hdr.width; j += tileSizeX)
+		{
+			int width = tileSizeX, x = j;
+
+			if(hdr.width - j < (3 * tileSizeX / 2))
+			{
+				width = hdr.width - j;  j += tileSizeX;
+			}
+			if(!tileEquals(&last, x, y, width, height))
+			{
+				if(runX < 0) runX = x;
+			}
+			else if(runX >= 0)
 			{
-				if((tjhnd = tjInitDecompress()) == NULL)
-					throw(Error("FBXFrame::decompressor", tjGetErrorStr()));
+				drawRegion(last, runX, y, x - runX, height);
+				runX = -1;  drawn = true;
 			}
-			TRY_TJ(tjDecompress2(tjhnd, cf.bits, cf.hdr.size,
-				(unsigned char *)&fb.bits[fb.pitch * cf.hdr.y + cf.hdr.x * pf->size],
-				width, fb.pitch, height, tjpf[pf->id], tjflags));
+		}
+		if(runX >= 0)
+		{
+			drawRegion(last, runX, y, hdr.width - runX, height);
+			drawn = true;
 		}
 	}
-	return *this;
+
+	if(drawn)
+	{
+		XFlush(fb.wh.dpy);
+		XSync(fb.wh.dpy, False);
+	}
 }
 
 
-void FBXFrame::redraw(void)
+// This is equivalent to fbx_write(), except that it does not wait for the X
+// server to process the request.
+void FBXFrame::drawRegion(Frame &last, int x, int y, int width, int height)
 {
-	if(flags & FRAME_BOTTOMUP) TRY_FBX(fbx_flip(&fb, 0, 0, 0, 0));
-	TRY_FBX(fbx_write(&fb, 0, 0, 0, 0, fb.width, fb.height));
+	if(!fb.pm || !fb.shm)
+		TRY_FBX(fbx_awrite(&fb, x, y, x, y, width, height));
+	if(fb.pm)
+		XCopyArea(fb.wh.dpy, fb.pm, fb.wh.d, fb.xgc, x, y, width, height, x, y);
+
+	for(int i = y; i < y + height; i++)
+		memcpy(&last.bits[last.pitch * i + pf->size * x],
+			&bits[pitch * i + pf->size * x], pf->size * width);
 }
 
 
@@ -33,6 +33,8 @@
 
 namespace common
 {
+	class CompressedFrame;
+
 	class Frame
 	{
 		public:
@@ -44,16 +46,27 @@ namespace common
 			void init(unsigned char *bits, int width, int pitch, int height,
 				int pixelFormat, int flags);
 			void deInit(void);
-			Frame *getTile(int x, int y, int width, int height);
-			bool tileEquals(Frame *last, int x, int y, int width, int height);
-			void makeAnaglyph(Frame &r, Frame &g, Frame &b);
-			void makePassive(Frame &stf, int mode);
+			void setExternalBits(unsigned char *bits);
+			void detachExternalBits(void);
+			Frame *getTile(int x, int y, int width, int height,
+				Frame *tile = NULL);
+			bool tileEquals(Frame *last, int x, int y, int width, int height,
+				int hashIndex = -1);
+			void initTileHashes(int nTiles);
+			void makeAnaglyph(Frame &r, Frame &g, Frame &b, int startRow = 0,
+				int endRow = -1);
+			void makePassive(Frame &stf, int mode, int startRow = 0,
+				int endRow = -1);
 			void signalReady(void) { ready.signal(); }
 			void waitUntilReady(void) { ready.wait(); }
 			void signalComplete(void) { complete.signal(); }
 			void waitUntilComplete(void) { complete.wait(); }
 			bool isComplete(void) { return !complete.isLocked(); }
 			void decompressRGB(Frame &f, int width, int height, bool rightEye);
+			void decompressLossless(CompressedFrame &cf, int width, int height,
+				bool rightEye);
+			void decompressJPEG(CompressedFrame &cf, tjhandle handle, int width,
+				int height, bool rightEye);
 			void addLogo(void);
 
 			rrframeheader hdr;
@@ -62,16 +75,31 @@ namespace common
 			int pitch, flags;
 			PF *pf;
 			bool isGL, isXV, stereo;
+			// If damageBase is non-NULL, then only the pixels within the damaged
+			// region (in top-down frame coordinates) can differ from damageBase.
+			Frame *damageBase;
+			int damageX, damageY, damageWidth, damageHeight;
 
 		protected:
 
 			void dumpHeader(rrframeheader &);
 			void checkHeader(rrframeheader &);
 
+			// Per-tile content hash, computed the first time that a tile is compared
+			// with the same tile in the previous frame
+			typedef struct
+			{
+				int x, y, width, height;
+				unsigned long long hash;
+				bool valid;
+			} TileHash;
+
 			util::Event ready;
 			util::Event complete;
 			friend class CompressedFrame;
 			bool primary;
+			TileHash *tileHashes;  int nTileHashes, maxTileHashes;
+			bool externalBits;
 	};
 }
 
@@ -90,13 +118,22 @@ namespace common
 			void compressYUV(Frame &f);
 			void compressJPEG(Frame &f);
 			void compressRGB(Frame &f);
+			void compressLossless(Frame &f);
 			void init(rrframeheader &h, int buffer);
 
 			rrframeheader rhdr;
+			// Number of times that the image buffers have been (re)allocated
+			long allocs;
 
 		private:
 
+			unsigned int *getPixelBuf(unsigned long count);
+
 			tjhandle tjhnd;
+			unsigned long bitsSize, rbitsSize;
+			// Scratch buffer of packed RGB pixels used by the lossless codec
+			unsigned int *pixelBuf;  unsigned long pixelBufSize;
+			friend class Frame;
 			friend class FBXFrame;
 	};
 }
@@ -118,10 +155,14 @@ namespace common
 			~FBXFrame(void);
 			void init(rrframeheader &h);
 			FBXFrame &operator= (CompressedFrame &cf);
+			void decompress(CompressedFrame &cf, tjhandle handle);
 			void redraw(void);
+			void redraw(Frame &last, int tileSize);
 
 		private:
 
+			void drawRegion(Frame &last, int x, int y, int width, int height);
+
 			fbx_wh wh;
 			fbx_struct fb;
 			tjhandle tjhnd;
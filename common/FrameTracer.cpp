@@ -0,0 +1,115 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+#include "FrameTracer.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <process.h>
+#define getpid  _getpid
+#else
+#include <unistd.h>
+#endif
+#include "Thread.h"
+#include "vglutil.h"
+#include "Log.h"
+
+using namespace util;
+using namespace common;
+
+
+FILE *FrameTracer::file = NULL;
+bool FrameTracer::init = false;
+bool FrameTracer::first = true;
+Timer FrameTracer::timer;
+CriticalSection FrameTracer::mutex;
+
+
+// Any occurrence of %p in the value of VGL_FRAMETRACE is replaced with the
+// process ID, so multiple processes can trace to separate files.
+
+void FrameTracer::open(void)
+{
+	CriticalSection::SafeLock l(mutex);
+	char *env = NULL;
+
+	if(init) return;
+	if((env = getenv("VGL_FRAMETRACE")) != NULL && strlen(env) > 0)
+	{
+		char fileName[1024];  size_t i = 0;
+		for(char *ptr = env; *ptr && i < sizeof(fileName) - 1; ptr++)
+		{
+			if(ptr[0] == '%' && ptr[1] == 'p')
+			{
+				snprintf(&fileName[i], sizeof(fileName) - i, "%d", (int)getpid());
+				i = strlen(fileName);  ptr++;
+			}
+			else fileName[i++] = *ptr;
+		}
+		fileName[i] = 0;
+		// The JSON array format is used, so that the trace remains usable even if
+		// the process exits abnormally before the closing bracket is written.
+		if((file = fopen(fileName, "w")) == NULL)
+			vglout.print("[VGL] WARNING: Could not open %s for writing\n",
+				fileName);
+		else
+		{
+			fprintf(file, "[");
+			atexit(close);
+		}
+	}
+	init = true;
+}
+
+
+void FrameTracer::close(void)
+{
+	CriticalSection::SafeLock l(mutex);
+
+	if(file)
+	{
+		fprintf(file, "\n]\n");
+		fclose(file);  file = NULL;
+	}
+}
+
+
+void FrameTracer::end(const char *stage, unsigned int winid,
+	unsigned int frameID, double startTime, int flow, int tile)
+{
+	if(!isEnabled() || startTime == 0.) return;
+
+	double now = timer.time();
+	int pid = (int)getpid();
+	unsigned long tid = Thread::threadID();
+
+	CriticalSection::SafeLock l(mutex);
+	if(!file) return;
+	fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"vgl\",\"ph\":\"X\","
+		"\"ts\":%.1f,\"dur\":%.1f,\"pid\":%d,\"tid\":%lu,"
+		"\"args\":{\"window\":\"0x%.8x\",\"frame\":%u", first ? "" : ",", stage,
+		startTime * 1000000., (now - startTime) * 1000000., pid, tid, winid,
+		frameID);
+	if(tile >= 0) fprintf(file, ",\"tile\":%d", tile);
+	fprintf(file, "}}");
+	first = false;
+
+	// Frame IDs are unique only within a particular window, so the window ID is
+	// included in the flow ID.  The flow event is bound to the slice that was
+	// just written.
+	if(flow != NOFLOW)
+		fprintf(file, ",\n{\"name\":\"Frame\",\"cat\":\"vgl\",\"ph\":\"%c\","
+			"\"id\":\"0x%.8x:%u\",\"ts\":%.1f,\"pid\":%d,\"tid\":%lu%s}",
+			(char)flow, winid, frameID, startTime * 1000000., pid, tid,
+			flow == FLOWEND ? ",\"bp\":\"e\"" : "");
+	fflush(file);
+}
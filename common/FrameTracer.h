@@ -0,0 +1,69 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+#ifndef __FRAMETRACER_H__
+#define __FRAMETRACER_H__
+
+#include <stdio.h>
+#include "Timer.h"
+#include "Mutex.h"
+
+
+namespace common
+{
+	// Records the time spent in each stage of the image pipeline, tagged with
+	// the window and frame ID from the frame header, and writes the stages to
+	// the file specified in VGL_FRAMETRACE using the Chrome trace event format.
+	// Flow events link the stages that a frame passes through, so a frame can
+	// be followed from the server to the client once the server and client
+	// traces have been merged.
+
+	class FrameTracer
+	{
+		public:
+
+			// Flow event types
+			enum { NOFLOW = 0, FLOWSTART = 's', FLOWSTEP = 't', FLOWEND = 'f' };
+
+			static bool isEnabled(void)
+			{
+				if(!init) open();
+				return file != NULL;
+			}
+
+			// Returns the current time (in seconds), or 0 if tracing is disabled
+			static double start(void)
+			{
+				if(!isEnabled()) return 0.;
+				return timer.time();
+			}
+
+			// Record a stage that began at startTime (as returned by start()) and
+			// ended now.  tile is the tile index, or -1 if the stage applies to the
+			// whole frame.
+			static void end(const char *stage, unsigned int winid,
+				unsigned int frameID, double startTime, int flow = NOFLOW,
+				int tile = -1);
+
+		private:
+
+			static void open(void);
+			static void close(void);
+
+			static FILE *file;
+			static bool init, first;
+			static util::Timer timer;
+			static util::CriticalSection mutex;
+	};
+}
+
+#endif  // __FRAMETRACER_H__
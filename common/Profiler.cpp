@@ -15,26 +15,56 @@
 #include "Profiler.h"
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include "vglutil.h"
 #ifdef _MSC_VER
 #define strdup  _strdup
 #endif
+#ifdef _WIN32
+#include <process.h>
+#define getpid  _getpid
+#else
+#include <unistd.h>
+#endif
 #include "Timer.h"
 #include "Log.h"
 
+using namespace util;
 using namespace common;
 
 
+FILE *Profiler::jsonFile = NULL;
+bool Profiler::jsonInit = false;
+CriticalSection Profiler::jsonMutex;
+
+
 Profiler::Profiler(const char *name_, double interval_) : interval(interval_),
 	mbytes(0.0), mpixels(0.0), totalTime(0.0), start(0.0), frames(0),
-	lastFrame(0.0)
+	lastFrame(0.0), allocs(0), trackAllocs(false), printStats(false),
+	samples(0), maxLatency(0.0)
 {
 	profile = false;  char *ev = NULL;
 	setName(name_);  freestr = false;
+	memset(histogram, 0, sizeof(long) * NBUCKETS);
 	if((ev = getenv("RRPROFILE")) != NULL && !strncmp(ev, "1", 1))
-		profile = true;
+		profile = printStats = true;
 	if((ev = getenv("VGL_PROFILE")) != NULL && !strncmp(ev, "1", 1))
-		profile = true;
+		profile = printStats = true;
+
+	// VGL_PROFILEJSON enables profiling without printing the statistics, and
+	// appends the statistics (including latency percentiles) to the specified
+	// file as JSON objects, one per line.
+	CriticalSection::SafeLock l(jsonMutex);
+	if(!jsonInit)
+	{
+		if((ev = getenv("VGL_PROFILEJSON")) != NULL && strlen(ev) > 0)
+		{
+			if((jsonFile = fopen(ev, "a")) == NULL)
+				vglout.print("[VGL] WARNING: Could not open %s for writing\n", ev);
+		}
+		jsonInit = true;
+	}
+	if(jsonFile) profile = true;
 }
 
 
@@ -66,6 +96,16 @@ void Profiler::startFrame(void)
 }
 
 
+// Record the number of heap allocations made while processing the current
+// frame.  Once this has been called, the average number of allocations per
+// frame is included in the profiler output.
+void Profiler::countAllocs(long allocs_)
+{
+	if(!profile) return;
+	allocs += allocs_;  trackAllocs = true;
+}
+
+
 void Profiler::endFrame(long pixels, long bytes, double incFrames)
 {
 	if(!profile) return;
@@ -73,6 +113,7 @@ void Profiler::endFrame(long pixels, long bytes, double incFrames)
 	if(start != 0.0)
 	{
 		totalTime += now - start;
+		addSample(now - start);
 		if(pixels) mpixels += (double)pixels / 1000000.;
 		if(bytes) mbytes += (double)bytes / 1000000.;
 		if(incFrames != 0.0) frames += incFrames;
@@ -98,8 +139,84 @@ void Profiler::endFrame(long pixels, long bytes, double incFrames)
 				mbytes * 8.0 / totalTime, mpixels * 3. / mbytes);
 			i = strlen(temps);
 		}
-		vglout.PRINT("%s\n", temps);
-		totalTime = 0.;  mpixels = 0.;  frames = 0.;  mbytes = 0.;
+		if(trackAllocs && frames)
+		{
+			snprintf(&temps[i], 255 - i, "- %7.2f allocs/frame",
+				(double)allocs / frames);
+			i = strlen(temps);
+		}
+		if(printStats) vglout.PRINT("%s\n", temps);
+		if(jsonFile) writeJSON(now);
+		totalTime = 0.;  mpixels = 0.;  frames = 0.;  mbytes = 0.;  allocs = 0;
+		memset(histogram, 0, sizeof(long) * NBUCKETS);
+		samples = 0;  maxLatency = 0.;
 		lastFrame = now;
 	}
 }
+
+
+void Profiler::addSample(double seconds)
+{
+	int bucket = 0;
+	double us = seconds * 1000000.;
+
+	if(us > 1.)
+	{
+		bucket = (int)(log(us) / log(2.) * (double)BUCKETSPEROCTAVE);
+		if(bucket >= NBUCKETS) bucket = NBUCKETS - 1;
+	}
+	histogram[bucket]++;  samples++;
+	if(seconds > maxLatency) maxLatency = seconds;
+}
+
+
+// Return the latency (in seconds) below which the specified fraction of the
+// samples in the current interval fall.  The result is the geometric midpoint
+// of the histogram bucket, so it is accurate to within about 4.5%.
+
+double Profiler::getPercentile(double fraction)
+{
+	if(samples < 1) return 0.;
+	long target = (long)ceil(fraction * (double)samples), count = 0;
+	if(target < 1) target = 1;
+	for(int i = 0; i < NBUCKETS; i++)
+	{
+		count += histogram[i];
+		if(count >= target)
+		{
+			double us = pow(2., (double)(i + 0.5) / (double)BUCKETSPEROCTAVE);
+			return min(us / 1000000., maxLatency);
+		}
+	}
+	return maxLatency;
+}
+
+
+void Profiler::writeJSON(double now)
+{
+	char stage[256];  size_t i = 0;
+
+	for(const char *ptr = name; *ptr && i < sizeof(stage) - 2; ptr++)
+	{
+		if(*ptr == '"' || *ptr == '\\') stage[i++] = '\\';
+		stage[i++] = *ptr;
+	}
+	while(i > 0 && stage[i - 1] == ' ') i--;
+	stage[i] = 0;
+
+	CriticalSection::SafeLock l(jsonMutex);
+	fprintf(jsonFile, "{\"time\": %.6f, \"pid\": %d, \"stage\": \"%s\", "
+		"\"interval\": %.6f, \"frames\": %.2f, \"mpixels_per_sec\": %.3f, "
+		"\"fps\": %.3f, \"mbits_per_sec\": %.3f, ", now, (int)getpid(), stage,
+		totalTime, frames, totalTime > 0. ? mpixels / totalTime : 0.,
+		totalTime > 0. ? frames / totalTime : 0.,
+		totalTime > 0. ? mbytes * 8. / totalTime : 0.);
+	if(trackAllocs)
+		fprintf(jsonFile, "\"allocs_per_frame\": %.2f, ",
+			frames ? (double)allocs / frames : 0.);
+	fprintf(jsonFile, "\"samples\": %ld, \"latency_ms\": {\"p50\": %.3f, "
+		"\"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f}}\n", samples,
+		getPercentile(0.5) * 1000., getPercentile(0.95) * 1000.,
+		getPercentile(0.99) * 1000., maxLatency * 1000.);
+	fflush(jsonFile);
+}
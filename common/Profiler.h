@@ -15,7 +15,9 @@
 #ifndef __PROFILER_H__
 #define __PROFILER_H__
 
+#include <stdio.h>
 #include "Timer.h"
+#include "Mutex.h"
 
 
 namespace common
@@ -30,15 +32,32 @@ namespace common
 			void setName(const char *name);
 			void startFrame(void);
 			void endFrame(long pixels, long bytes, double incFrames);
+			void countAllocs(long allocs);
 
 		private:
 
+			// Latency histogram with 8 logarithmically spaced buckets per octave,
+			// covering 1 microsecond to approximately 4.5 minutes
+			static const int BUCKETSPEROCTAVE = 8, NBUCKETS = 28 * 8;
+
+			void addSample(double seconds);
+			double getPercentile(double fraction);
+			void writeJSON(double now);
+
 			char *name;
 			double interval;
 			double mbytes, mpixels, totalTime, start, frames, lastFrame;
-			bool profile;
+			long allocs;
+			bool profile, trackAllocs, printStats;
 			util::Timer timer;
 			bool freestr;
+			long histogram[NBUCKETS], samples;
+			double maxLatency;
+
+			// Shared by all profiler instances in the process
+			static FILE *jsonFile;
+			static bool jsonInit;
+			static util::CriticalSection jsonMutex;
 	};
 }
 
@@ -34,7 +34,7 @@ using namespace common;
 #define NUMWIN  1
 
 bool useGL = false, useXV = false, doRgbBench = false, useRGB = false,
-	addLogo = false, anaglyph = false, check = false;
+	addLogo = false, anaglyph = false, check = false, doTileBench = false;
 
 
 void resizeWindow(Display *dpy, Window win, int width, int height, int myID)
@@ -597,6 +597,113 @@ void rgbBench(char *filename)
 }
 
 
+// Interframe comparison benchmark:  compare every tile of a 1920x1080 frame
+// with the same tile in the previous frame, using row-by-row memcmp() (the
+// reference), the SIMD comparison kernel, and per-tile hashes.
+
+#define TB_WIDTH  1920
+#define TB_HEIGHT  1080
+#define TB_TILESIZE  RR_DEFAULTTILESIZE
+#define TB_TILESX  ((TB_WIDTH + TB_TILESIZE - 1) / TB_TILESIZE)
+#define TB_TILESY  ((TB_HEIGHT + TB_TILESIZE - 1) / TB_TILESIZE)
+
+static bool memcmpTileEquals(Frame &f, Frame &last, int x, int y, int width,
+	int height)
+{
+	for(int i = 0; i < height; i++)
+	{
+		if(memcmp(&f.bits[f.pitch * (y + i) + f.pf->size * x],
+			&last.bits[last.pitch * (y + i) + last.pf->size * x],
+			f.pf->size * width))
+			return false;
+	}
+	return true;
+}
+
+
+static int compareTiles(Frame &f, Frame &last, int method)
+{
+	int changed = 0, n = 0;
+
+	if(method == 2) f.initTileHashes(TB_TILESX * TB_TILESY);
+	for(int y = 0; y < TB_HEIGHT; y += TB_TILESIZE)
+	{
+		int height = min(TB_TILESIZE, TB_HEIGHT - y);
+		for(int x = 0; x < TB_WIDTH; x += TB_TILESIZE, n++)
+		{
+			int width = min(TB_TILESIZE, TB_WIDTH - x);
+			bool equals;
+			if(method == 0) equals = memcmpTileEquals(f, last, x, y, width, height);
+			else equals = f.tileEquals(&last, x, y, width, height,
+				method == 2 ? n : -1);
+			if(!equals) changed++;
+		}
+	}
+	return changed;
+}
+
+
+void tileBench(void)
+{
+	const char *sceneName[3] = { "Static", "Partial", "Full" };
+	const char *methodName[3] = { "memcmp", "SIMD", "Hash" };
+	Frame frame[2];
+	rrframeheader hdr;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.width = hdr.framew = TB_WIDTH;
+	hdr.height = hdr.frameh = TB_HEIGHT;
+	frame[0].init(hdr, PF_BGRX, 0);
+	frame[1].init(hdr, PF_BGRX, 0);
+	for(int i = 0; i < frame[0].pitch * TB_HEIGHT; i++)
+		frame[0].bits[i] = frame[1].bits[i] = (unsigned char)(rand() % 256);
+
+	fprintf(stderr, "Interframe comparison (%d x %d, %d x %d tiles):\n",
+		TB_WIDTH, TB_HEIGHT, TB_TILESIZE, TB_TILESIZE);
+	fprintf(stderr, "Scene     Method  Changed      Mpixels/sec\n");
+
+	for(int scene = 0; scene < 3; scene++)
+	{
+		// Static:  no tiles change.  Partial:  every fourth tile changes.
+		// Full:  every tile changes.  The changed pixel is in the center of the
+		// tile, so the direct comparison methods must read half of the tile
+		// before they can exit early.
+		int expected = 0, n = 0;
+		memcpy(frame[1].bits, frame[0].bits, frame[0].pitch * TB_HEIGHT);
+		for(int y = 0; y < TB_HEIGHT; y += TB_TILESIZE)
+		{
+			for(int x = 0; x < TB_WIDTH; x += TB_TILESIZE, n++)
+			{
+				if(scene == 0 || (scene == 1 && n % 4 != 0)) continue;
+				int cy = min(y + TB_TILESIZE / 2, TB_HEIGHT - 1);
+				int cx = min(x + TB_TILESIZE / 2, TB_WIDTH - 1);
+				frame[1].bits[frame[1].pitch * cy + frame[1].pf->size * cx] ^= 0xFF;
+				expected++;
+			}
+		}
+
+		for(int method = 0; method < 3; method++)
+		{
+			// Hash the previous frame once, as if it had been compared with its
+			// predecessor.
+			if(method == 2) compareTiles(frame[0], frame[0], 2);
+
+			double tStart, tTotal = 0.;  int iter = 0, changed = 0;
+			do
+			{
+				tStart = GetTime();
+				changed = compareTiles(frame[1], frame[0], method);
+				tTotal += GetTime() - tStart;  iter++;
+			} while(tTotal < 1.);
+			fprintf(stderr, "%-9s %-7s %3d / %-3d %12.2f - %s\n", sceneName[scene],
+				methodName[method], changed, n, (double)TB_WIDTH *
+				(double)TB_HEIGHT * (double)iter / 1000000. / tTotal,
+				changed == expected ? "Passed." : "FAILED!");
+		}
+	}
+}
+
+
 void usage(char **argv)
 {
 	fprintf(stderr, "\nUSAGE: %s [options]\n\n", argv[0]);
@@ -608,6 +715,7 @@ void usage(char **argv)
 	fprintf(stderr, "-anaglyph = Test anaglyph creation\n");
 	fprintf(stderr, "-rgbbench <filename> = Benchmark the decoding of RGB-encoded frames.\n");
 	fprintf(stderr, "                       <filename> should be a BMP or PPM file.\n");
+	fprintf(stderr, "-tilebench = Benchmark interframe comparison\n");
 	fprintf(stderr, "-v = Verbose output (may affect benchmark results)\n");
 	fprintf(stderr, "-check = Check correctness of pixel paths (implies -rgb)\n\n");
 	exit(1);
@@ -648,6 +756,7 @@ int main(int argc, char **argv)
 		{
 			fileName = argv[++i];  doRgbBench = true;
 		}
+		else if(!stricmp(argv[i], "-tilebench")) doTileBench = true;
 		else if(!stricmp(argv[i], "-v")) verbose = true;
 		else if(!stricmp(argv[i], "-check")) { check = true;  useRGB = true; }
 		else usage(argv);
@@ -656,6 +765,7 @@ int main(int argc, char **argv)
 	try
 	{
 		if(doRgbBench) { rgbBench(fileName);  exit(0); }
+		if(doTileBench) { tileBench();  exit(0); }
 
 		ERRIFNOT(XInitThreads());
 		if(!(dpy = XOpenDisplay(0)))
@@ -17,7 +17,7 @@
 #define __RR_H
 
 #define RR_MAJOR_VERSION  2
-#define RR_MINOR_VERSION  1
+#define RR_MINOR_VERSION  3
 
 /* Argh! */
 #if !defined(__SUNPRO_CC) && !defined(__SUNPRO_C)
@@ -46,8 +46,13 @@ typedef struct _rrframeheader
   unsigned char compress;  /* Compression algorithm (see enum below) */
   unsigned short dpynum;   /* Display number on the client that contains the
                               window into which this frame will be drawn */
+  unsigned int frameid;    /* Sequence number of the frame within the window
+                              (protocol v2.3 and later) */
 } rrframeheader;
-#define sizeof_rrframeheader  26
+#define sizeof_rrframeheader  30
+/* Size of the header in protocol v2.0 through v2.2, which lacks the frameid
+   field */
+#define sizeof_rrframeheader_v2  26
 
 typedef struct _rrversion
 {
@@ -88,7 +93,9 @@ enum
   RR_EOF = 1,  /* this tile is an End-of-Frame marker and contains no real
                   image data */
   RR_LEFT,     /* this tile goes to the left buffer of a stereo frame */
-  RR_RIGHT     /* this tile goes to the right buffer of a stereo frame */
+  RR_RIGHT,    /* this tile goes to the right buffer of a stereo frame */
+  RR_EOF_ACK   /* same as RR_EOF, but the client must acknowledge the frame
+                  once it has been displayed (protocol v2.3 and later) */
 };
 
 /* Transport types */
@@ -99,10 +106,11 @@ enum rrtrans
 };
 
 /* Compression types */
-#define RR_COMPRESSOPT  5
+#define RR_COMPRESSOPT  6
 enum rrcomp
 {
-  RRCOMP_PROXY = 0, RRCOMP_JPEG, RRCOMP_RGB, RRCOMP_XV, RRCOMP_YUV
+  RRCOMP_PROXY = 0, RRCOMP_JPEG, RRCOMP_RGB, RRCOMP_XV, RRCOMP_YUV,
+  RRCOMP_LOSSLESS
 };
 
 /* Readback types */
@@ -111,22 +119,22 @@ enum rrread { RRREAD_NONE = 0, RRREAD_SYNC, RRREAD_PBO };
 
 static const enum rrtrans _Trans[RR_COMPRESSOPT] =
 {
-  RRTRANS_X11, RRTRANS_VGL, RRTRANS_VGL, RRTRANS_XV, RRTRANS_VGL
+  RRTRANS_X11, RRTRANS_VGL, RRTRANS_VGL, RRTRANS_XV, RRTRANS_VGL, RRTRANS_VGL
 };
 
 static const int _Minsubsamp[RR_COMPRESSOPT] =
 {
-  -1, 0, -1, 4, 4
+  -1, 0, -1, 4, 4, -1
 };
 
 static const int _Defsubsamp[RR_COMPRESSOPT] =
 {
-  1, 1, 1, 4, 4
+  1, 1, 1, 4, 4, 1
 };
 
 static const int _Maxsubsamp[RR_COMPRESSOPT] =
 {
-  -1, 4, -1, 4, 4
+  -1, 4, -1, 4, 4, -1
 };
 
 /* Stereo options */
@@ -142,9 +150,13 @@ enum rrstereo
 #define RR_DEFAULTPORT  4242
 #define RR_DEFAULTTILESIZE  256
 
-/* Maximum threads that be can be used for parallel image compression */
-/* (the algorithms don't scale beyond 3) */
-#define MAXPROCS  4
+/* Maximum threads that can be used for parallel image compression or
+   decompression */
+#define MAXPROCS  256
+
+/* Maximum number of pixel buffer objects that can be used for pipelined
+   readback */
+#define MAXPBOS  8
 
 #define MAXSTR  256
 
@@ -210,6 +222,18 @@ typedef struct _FakerConfig
   char amdgpuHack;
   char exitfunction[MAXSTR];
   char chromeHack;
+  int pbobufs;
+  char tilehash;
+  char damage;
+  char zerocopy;
+  char adaptive;
+  double maxbw;
+  double targetfps;
+  int maxinflight;
+  char capture[MAXSTR];
+  char attribcache[MAXSTR];
+  char pbpool;
+  char x11interframe;
 } FakerConfig;
 
 #if !defined(__SUNPRO_CC) && !defined(__SUNPRO_C)
@@ -92,6 +92,9 @@ namespace util
 			~Semaphore(void);
 			void wait(void);
 			bool tryWait();
+			// Returns false if the semaphore could not be acquired within timeout
+			// seconds
+			bool timedWait(double timeout);
 			void post(void);
 			long getValue(void);
 
@@ -0,0 +1,77 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+// Lock-free bounded queue implementation using a preallocated ring buffer
+
+#ifndef __RINGQ_H__
+#define __RINGQ_H__
+
+#include "Mutex.h"
+
+
+namespace util
+{
+	// This class has the same interface as GenericQ, but items are passed
+	// through a fixed-size array of slots, each of which carries a sequence
+	// number that tells producers and consumers whether the slot is free or
+	// full.  Thus, adding and removing items requires no locks and no heap
+	// allocation, and any number of threads can add and remove items
+	// concurrently.  The semaphores are used only to put a thread to sleep when
+	// the queue is empty (or full) and to wake it up again, so a hand-off
+	// between two threads that are both running incurs no system calls.
+
+	class RingQ
+	{
+		public:
+
+			typedef void (*SpoilCallback)(void *);
+
+			// capacity is rounded up to the next power of 2.  If the queue is full,
+			// then add() blocks until an item is removed.
+			RingQ(int capacity = 64);
+			~RingQ(void);
+			void add(void *item);
+			void spoil(void *item, SpoilCallback spoilCallback);
+			void get(void **item, bool nonBlocking = false);
+			// Wait at most timeout seconds for an item.  *item is set to NULL if the
+			// timeout expires.
+			void get(void **item, double timeout);
+			void release(void);
+			int items(void);
+
+		private:
+
+			bool tryAdd(void *item);
+			bool tryGet(void **item);
+
+			typedef struct
+			{
+				volatile unsigned int seq;
+				void *volatile item;
+			} Slot;
+
+			Slot *slots;
+			unsigned int mask;
+			// Keep the producer and consumer positions in separate cache lines, so
+			// that producers and consumers do not contend for the same line.
+			char pad0[64];
+			volatile unsigned int addPos;
+			char pad1[64];
+			volatile unsigned int getPos;
+			char pad2[64];
+			volatile int getWaiters, addWaiters;
+			Semaphore hasItem, hasSpace;
+			volatile int deadYet;
+	};
+}
+
+#endif  // __RINGQ_H__
@@ -60,6 +60,13 @@ typedef int SOCKET;
 
 namespace util
 {
+	// Describes one buffer in a scatter-gather I/O operation
+	typedef struct
+	{
+		char *buf;
+		int len;
+	} SockBuf;
+
 	class Socket
 	{
 		public:
@@ -74,6 +81,8 @@ namespace util
 			Socket *accept(void);
 			void send(char *buf, int len);
 			void recv(char *buf, int len);
+			void send(SockBuf *bufs, int count);
+			int recv(SockBuf *bufs, int count, int minLen);
 			const char *remoteName(void);
 
 		private:
@@ -81,6 +90,7 @@ namespace util
 			unsigned short setupListener(unsigned short port, bool reuseAddr);
 
 			static const int MAXCONN = 1024;
+			static const int MAXIOV = 64;
 			static int instanceCount;
 			static CriticalSection mutex;
 			SOCKET sd;
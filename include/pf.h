@@ -46,6 +46,10 @@ extern "C" {
 
 PF *pf_get(int id);
 
+/* Enable or disable the SIMD conversion routines (enabled by default.)  This is
+   mainly useful for benchmarking. */
+void pf_setsimd(int enable);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,213 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "AttribCache.h"
+#include "fakerconfig.h"
+#include "vglutil.h"
+#include "Log.h"
+
+using namespace util;
+using namespace server;
+
+
+#define PAD8(s)  (((s) + 7) & (~(size_t)7))
+
+
+static unsigned int checksum(const void *data, size_t size)
+{
+	const unsigned char *ptr = (const unsigned char *)data;
+	unsigned int hash = 2166136261U;  // FNV-1a
+
+	for(size_t i = 0; i < size; i++)
+	{
+		hash ^= ptr[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+
+AttribCache::AttribCache(const char *tag) : key(NULL), keySize(0), keyAlloc(0)
+{
+	if(strlen(fconfig.attribcache) < 1) return;
+	if(!(key = (char *)malloc(256))) return;
+	key[0] = 0;  keyAlloc = 256;
+	addKey("%s\n", tag);
+}
+
+
+AttribCache::~AttribCache(void)
+{
+	free(key);  key = NULL;
+}
+
+
+// Append a printf-style string to the key.  If memory cannot be allocated,
+// then the cache is disabled.
+
+void AttribCache::addKey(const char *format, ...)
+{
+	va_list arglist;
+
+	if(!key) return;
+	while(1)
+	{
+		size_t avail = keyAlloc - keySize;
+		va_start(arglist, format);
+		int len = vsnprintf(&key[keySize], avail, format, arglist);
+		va_end(arglist);
+		if(len < 0) goto bailout;
+		if((size_t)len < avail)
+		{
+			keySize += len;  return;
+		}
+		size_t newAlloc = max(keyAlloc * 2, keySize + len + 256);
+		char *newKey = (char *)realloc(key, newAlloc);
+		if(!newKey) goto bailout;
+		key = newKey;  keyAlloc = newAlloc;
+	}
+
+	bailout:
+	free(key);  key = NULL;
+}
+
+
+// The file name is derived from a 64-bit FNV-1a hash of the key.  The whole
+// key is stored in the file as well, so a hash collision only causes a cache
+// miss.
+
+char *AttribCache::getFileName(void)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for(size_t i = 0; i < keySize; i++)
+	{
+		hash ^= (unsigned char)key[i];
+		hash *= 1099511628211ULL;
+	}
+
+	size_t len = strlen(fconfig.attribcache) + 32;
+	char *fileName = (char *)malloc(len);
+	if(fileName)
+		snprintf(fileName, len, "%s/vgl-%.16llx", fconfig.attribcache, hash);
+	return fileName;
+}
+
+
+bool AttribCache::load(void *data, size_t dataSize)
+{
+	char *fileName = NULL;
+	int fd = -1;
+	struct stat sb;
+	unsigned char *map = NULL;
+	size_t mapSize = 0;
+	bool retval = false;
+
+	if(!key || !data) return false;
+	if(!(fileName = getFileName())) return false;
+
+	if((fd = open(fileName, O_RDONLY)) == -1 || fstat(fd, &sb) == -1)
+		goto bailout;
+	mapSize = (size_t)sb.st_size;
+	if(mapSize != sizeof(rrattribheader) + PAD8(keySize + 1) + dataSize)
+		goto bailout;
+	if((map = (unsigned char *)mmap(NULL, mapSize, PROT_READ, MAP_PRIVATE, fd,
+		0)) == MAP_FAILED)
+	{
+		map = NULL;  goto bailout;
+	}
+
+	{
+		rrattribheader *h = (rrattribheader *)map;
+		unsigned char *fileKey = &map[sizeof(rrattribheader)];
+		unsigned char *fileData = &fileKey[PAD8(keySize + 1)];
+
+		if(memcmp(h->signature, VGLATTR_SIGNATURE, sizeof_VGLATTR_SIGNATURE)
+			|| h->keySize != keySize + 1 || h->dataSize != dataSize
+			|| memcmp(fileKey, key, keySize + 1)
+			|| h->checksum != checksum(fileData, dataSize))
+			goto bailout;
+		memcpy(data, fileData, dataSize);
+		retval = true;
+	}
+
+	if(fconfig.verbose)
+		vglout.println("[VGL] Read cached attributes from %s", fileName);
+
+	bailout:
+	if(map) munmap(map, mapSize);
+	if(fd != -1) close(fd);
+	free(fileName);
+	return retval;
+}
+
+
+// The record is written to a temporary file, which is then renamed, so
+// multiple processes can safely populate the cache at the same time.
+
+void AttribCache::store(const void *data, size_t dataSize)
+{
+	char *fileName = NULL, *tempName = NULL;
+	int fd = -1;
+	bool tempCreated = false;
+	static const char pad[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	size_t padSize = PAD8(keySize + 1) - (keySize + 1);
+	rrattribheader h;
+
+	if(!key || !data) return;
+	if(!(fileName = getFileName())
+		|| !(tempName = (char *)malloc(strlen(fileName) + 8)))
+		goto bailout;
+	sprintf(tempName, "%s.XXXXXX", fileName);
+
+	if(mkdir(fconfig.attribcache, 0700) == -1 && errno != EEXIST)
+		goto bailout;
+	if((fd = mkstemp(tempName)) == -1) goto bailout;
+	tempCreated = true;
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.signature, VGLATTR_SIGNATURE, sizeof_VGLATTR_SIGNATURE);
+	h.keySize = (unsigned int)keySize + 1;
+	h.dataSize = (unsigned int)dataSize;
+	h.checksum = checksum(data, dataSize);
+	if(write(fd, &h, sizeof(h)) != (ssize_t)sizeof(h)
+		|| write(fd, key, keySize + 1) != (ssize_t)(keySize + 1)
+		|| write(fd, pad, padSize) != (ssize_t)padSize
+		|| write(fd, data, dataSize) != (ssize_t)dataSize)
+		goto bailout;
+	if(close(fd) == -1)
+	{
+		fd = -1;  goto bailout;
+	}
+	fd = -1;
+	if(rename(tempName, fileName) == -1) goto bailout;
+
+	if(fconfig.verbose)
+		vglout.println("[VGL] Wrote cached attributes to %s", fileName);
+	free(tempName);  free(fileName);
+	return;
+
+	bailout:
+	vglout.println("[VGL] WARNING: Could not write attribute cache file in %s",
+		fconfig.attribcache);
+	if(fd != -1) close(fd);
+	if(tempCreated) unlink(tempName);
+	free(tempName);  free(fileName);
+}
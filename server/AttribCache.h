@@ -0,0 +1,70 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+#ifndef __ATTRIBCACHE_H__
+#define __ATTRIBCACHE_H__
+
+#include <stddef.h>
+
+
+// Attribute cache file format
+//
+// Each file holds one record, which consists of an attribute cache header
+// followed by keySize bytes of key (including the terminating NUL), padding to
+// the next multiple of 8 bytes, and dataSize bytes of data.  The header and
+// data are stored in native byte order, since the file is only useful on the
+// machine that wrote it.
+
+#define VGLATTR_SIGNATURE  "VGLATR01"
+#define sizeof_VGLATTR_SIGNATURE  8
+
+typedef struct
+{
+	char signature[sizeof_VGLATTR_SIGNATURE];
+	unsigned int keySize;        // Size of the key, including the NUL
+	unsigned int dataSize;       // Size of the data
+	unsigned int checksum;       // FNV-1a hash of the data
+	unsigned int reserved;
+} rrattribheader;
+
+
+namespace server
+{
+	// Stores attributes that are expensive to obtain (because obtaining them
+	// requires round trips to the 2D X server or a temporary OpenGL context) in
+	// a file in the directory specified by VGL_ATTRIBCACHE, so that subsequent
+	// runs of the application can read them from the file instead.  The key
+	// must describe everything on which the attributes depend.  If
+	// VGL_ATTRIBCACHE is not set, then load() always fails and store() does
+	// nothing.
+
+	class AttribCache
+	{
+		public:
+
+			AttribCache(const char *tag);
+			~AttribCache(void);
+
+			bool isEnabled(void) { return key != NULL; }
+			void addKey(const char *format, ...);
+			bool load(void *data, size_t dataSize);
+			void store(const void *data, size_t dataSize);
+
+		private:
+
+			char *getFileName(void);
+
+			char *key;  size_t keySize, keyAlloc;
+	};
+}
+
+#endif  // __ATTRIBCACHE_H__
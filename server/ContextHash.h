@@ -23,6 +23,7 @@ typedef struct
 {
 	VGLFBConfig config;
 	Bool direct;
+	bool scissorIndexed;
 } ContextAttribs;
 
 
@@ -55,6 +56,7 @@ namespace faker
 				attribs = new ContextAttribs;
 				attribs->config = config;
 				attribs->direct = direct;
+				attribs->scissorIndexed = false;
 				HASH::add(ctx, NULL, attribs);
 			}
 
@@ -76,6 +78,28 @@ namespace faker
 				return -1;
 			}
 
+			// Damage tracking ignores the scissor test once a context has used
+			// per-viewport scissor rectangles.
+			bool isScissorIndexed(GLXContext ctx)
+			{
+				if(ctx)
+				{
+					ContextAttribs *attribs = HASH::find(ctx, NULL);
+					if(attribs) return attribs->scissorIndexed;
+				}
+				return false;
+			}
+
+			void setScissorIndexed(GLXContext ctx)
+			{
+				if(ctx)
+				{
+					util::CriticalSection::SafeLock l(mutex);
+					ContextAttribs *attribs = HASH::find(ctx, NULL);
+					if(attribs) attribs->scissorIndexed = true;
+				}
+			}
+
 			void remove(GLXContext ctx)
 			{
 				if(ctx) HASH::remove(ctx, NULL);
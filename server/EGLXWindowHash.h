@@ -72,6 +72,25 @@ namespace faker
 				return NULL;
 			}
 
+			// Draining may send a frame, which can block, so the hash mutex is not
+			// held while draining.
+			void drainReadback(Display *dpy, bool ifIdle)
+			{
+				EGLXVirtualWin *eglxvws[MAXDRAIN];  int neglxvws = 0;
+				if(!dpy) return;
+				{
+					util::CriticalSection::SafeLock l(mutex);
+					for(HashEntry *entry = start; entry != NULL && neglxvws < MAXDRAIN;
+						entry = entry->next)
+					{
+						if(entry->value->getX11Display() == dpy
+							&& entry->value->hasStaleReadback())
+							eglxvws[neglxvws++] = entry->value;
+					}
+				}
+				for(int i = 0; i < neglxvws; i++) eglxvws[i]->drainReadback(ifIdle);
+			}
+
 			// Find the EGLXVirtualWin instance corresponding to the real EGL
 			// surface, not the dummy EGL surface that we passed back to the 3D
 			// application.
@@ -100,6 +119,9 @@ namespace faker
 
 		private:
 
+			// Maximum number of windows drained per call
+			static const int MAXDRAIN = 64;
+
 			~EGLXWindowHash(void)
 			{
 				EGLXWindowHash::kill();
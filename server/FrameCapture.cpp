@@ -0,0 +1,111 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+#include <string.h>
+#include "FrameCapture.h"
+#include "fakerconfig.h"
+#include "vglutil.h"
+#include "Log.h"
+#include "Error.h"
+
+using namespace util;
+using namespace common;
+using namespace server;
+
+
+FrameCapture *FrameCapture::instance = NULL;
+CriticalSection FrameCapture::instanceMutex;
+
+
+// Encode the frame using the lossless codec and append it to the capture
+// file.  This is called by the rendering thread, so it slows down the
+// application, but the capture is an exact copy of what was rendered.
+
+void FrameCapture::write(Frame *f, unsigned int winid)
+{
+	CriticalSection::SafeLock l(mutex);
+
+	if(failed || !f || f->hdr.width < 1 || f->hdr.height < 1) return;
+	// The lossless codec supports only 8-bit-per-component pixel formats.
+	if(f->pf->bpc != 8)
+	{
+		vglout.println("[VGL] WARNING: Cannot capture frames with %d-bit "
+			"components.  Capture disabled.", f->pf->bpc);
+		if(file) { fclose(file);  file = NULL; }
+		failed = true;  return;
+	}
+	if(!file)
+	{
+		if((file = fopen(fconfig.capture, "wb")) == NULL
+			|| fwrite(VGLCAP_SIGNATURE, sizeof_VGLCAP_SIGNATURE, 1, file) != 1)
+		{
+			vglout.println("[VGL] WARNING: Could not open %s for writing",
+				fconfig.capture);
+			if(file) { fclose(file);  file = NULL; }
+			failed = true;  return;
+		}
+		if(fconfig.verbose)
+			vglout.println("[VGL] Capturing frames to %s", fconfig.capture);
+		start = timer.time();
+	}
+
+	double t = timer.time() - start;
+	// A capture error should never take down the application, so disable the
+	// capture instead of propagating the error.
+	try
+	{
+		f->getTile(0, 0, f->hdr.width, f->hdr.height, &tile);
+		tile.stereo = false;
+		tile.hdr.framew = tile.hdr.width;  tile.hdr.frameh = tile.hdr.height;
+		tile.hdr.compress = RRCOMP_LOSSLESS;  tile.hdr.qual = 100;
+		tile.hdr.subsamp = 1;
+		cframe.compressLossless(tile);
+	}
+	catch(std::exception &e)
+	{
+		vglout.println("[VGL] WARNING: Could not encode frame (%s).  "
+			"Capture disabled.", e.what());
+		fclose(file);  file = NULL;  failed = true;
+		return;
+	}
+
+	rrcaptureheader h;
+	memset(&h, 0, sizeof(rrcaptureheader));
+	h.sec = (unsigned int)t;
+	h.usec = (unsigned int)((t - (double)h.sec) * 1000000.);
+	h.winid = winid;
+	h.width = tile.hdr.width;  h.height = tile.hdr.height;
+	h.pixelFormat = (unsigned char)f->pf->id;
+	h.size = cframe.hdr.size;
+	if(!LittleEndian())
+	{
+		h.sec = BYTESWAP(h.sec);  h.usec = BYTESWAP(h.usec);
+		h.winid = BYTESWAP(h.winid);
+		h.width = BYTESWAP16(h.width);  h.height = BYTESWAP16(h.height);
+		h.size = BYTESWAP(h.size);
+	}
+	if(fwrite(&h, sizeof_rrcaptureheader, 1, file) != 1
+		|| fwrite(cframe.bits, cframe.hdr.size, 1, file) != 1)
+	{
+		vglout.println("[VGL] WARNING: Could not write to %s.  Capture disabled.",
+			fconfig.capture);
+		fclose(file);  file = NULL;  failed = true;
+	}
+}
+
+
+void FrameCapture::kill(void)
+{
+	CriticalSection::SafeLock l(mutex);
+
+	if(file) { fclose(file);  file = NULL; }
+}
@@ -0,0 +1,91 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+#ifndef __FRAMECAPTURE_H__
+#define __FRAMECAPTURE_H__
+
+#include <stdio.h>
+#include "Frame.h"
+#include "Timer.h"
+#include "Mutex.h"
+
+
+// Capture file format
+//
+// The file begins with an 8-byte signature, followed by one record for each
+// frame that the application rendered.  Each record consists of a capture
+// header (all fields little-endian) followed by size bytes of image data that
+// have been encoded using the lossless codec.
+
+#define VGLCAP_SIGNATURE  "VGLCAP01"
+#define sizeof_VGLCAP_SIGNATURE  8
+
+typedef struct
+{
+	unsigned int sec, usec;      // Time at which the frame was rendered,
+	                             // relative to the first captured frame
+	unsigned int winid;          // X11 window into which the frame was drawn
+	unsigned short width, height;
+	unsigned char pixelFormat;   // Pixel format (PF_*) of the rendered frame
+	unsigned char reserved[3];
+	unsigned int size;           // Size of the encoded image data
+} rrcaptureheader;
+#define sizeof_rrcaptureheader  24
+
+
+namespace server
+{
+	// Records the frames that the application renders to the file specified
+	// in VGL_CAPTURE, so that they can be replayed through the image transports
+	// using vglreplay.  The file is shared by all windows in the process.
+
+	class FrameCapture
+	{
+		public:
+
+			static FrameCapture *getInstance(void)
+			{
+				if(instance == NULL)
+				{
+					util::CriticalSection::SafeLock l(instanceMutex);
+					if(instance == NULL) instance = new FrameCapture;
+				}
+				return instance;
+			}
+
+			static bool isAlloc(void) { return instance != NULL; }
+
+			void write(common::Frame *f, unsigned int winid);
+			void kill(void);
+
+		private:
+
+			FrameCapture(void) : file(NULL), failed(false), start(0.), tile(false)
+			{
+			}
+
+			~FrameCapture(void) { kill(); }
+
+			FILE *file;  bool failed;
+			util::Timer timer;  double start;
+			common::Frame tile;
+			common::CompressedFrame cframe;
+			util::CriticalSection mutex;
+			static FrameCapture *instance;
+			static util::CriticalSection instanceMutex;
+	};
+}
+
+
+#define FRAMECAPTURE  (*(server::FrameCapture::getInstance()))
+
+#endif  // __FRAMECAPTURE_H__
@@ -15,11 +15,24 @@
 #ifndef __HASH_H__
 #define __HASH_H__
 
+#include <stddef.h>
+#include <string.h>
 #include "Mutex.h"
 #include "Error.h"
 
 
 // Generic hash table template class
+//
+// Entries are kept in a doubly-linked list (which subclasses may walk while
+// holding the mutex) and are also indexed by a bucket array, so lookups are
+// O(1) regardless of how many entries are in the table.  Subclasses whose
+// compare() method matches entries on something other than (key1, key2) must
+// override hashKey() so that all matching keys fall into the same bucket.
+// Entries can additionally be indexed by a secondary key (alias) of the same
+// type as key2, and a subclass can request a full linear scan for lookups
+// that cannot be resolved using either index.
+
+#define HASH_MINBUCKETS  64
 
 namespace faker
 {
@@ -35,6 +48,9 @@ namespace faker
 				HashValueType value;
 				int refCount;
 				struct HashEntryStruct *prev, *next;
+				struct HashEntryStruct *chain, *aliasChain;
+				size_t hash, aliasHash;
+				bool hasAlias;
 			} HashEntry;
 
 			void kill(void)
@@ -49,11 +65,18 @@ namespace faker
 			{
 				start = end = NULL;
 				count = 0;
+				nBuckets = HASH_MINBUCKETS;
+				buckets = new HashEntry *[nBuckets];
+				aliasBuckets = new HashEntry *[nBuckets];
+				memset(buckets, 0, sizeof(HashEntry *) * nBuckets);
+				memset(aliasBuckets, 0, sizeof(HashEntry *) * nBuckets);
 			}
 
 			virtual ~Hash(void)
 			{
 				kill();
+				delete [] buckets;  buckets = NULL;
+				delete [] aliasBuckets;  aliasBuckets = NULL;
 			}
 
 			int add(HashKeyType1 key1, HashKeyType2 key2, HashValueType value,
@@ -66,7 +89,11 @@ namespace faker
 
 				if((entry = findEntry(key1, key2)) != NULL)
 				{
-					if(value) entry->value = value;
+					if(value)
+					{
+						entry->value = value;
+						updateAlias(entry);
+					}
 					if(useRef) entry->refCount++;
 					return 0;
 				}
@@ -77,7 +104,11 @@ namespace faker
 				end = entry;
 				end->key1 = key1;  end->key2 = key2;  end->value = value;
 				if(useRef) end->refCount = 1;
+				end->hash = hashKey(key1, key2);
 				count++;
+				if(count > nBuckets * 2) rehash(nBuckets * 4);
+				else link(buckets, entry->hash, entry, &HashEntry::chain);
+				updateAlias(entry);
 				return 1;
 			}
 
@@ -88,7 +119,11 @@ namespace faker
 
 				if((entry = findEntry(key1, key2)) != NULL)
 				{
-					if(!entry->value) entry->value = attach(key1, key2);
+					if(!entry->value)
+					{
+						entry->value = attach(key1, key2);
+						updateAlias(entry);
+					}
 					return entry->value;
 				}
 				return (HashValueType)0;
@@ -113,7 +148,22 @@ namespace faker
 				HashEntry *entry = NULL;
 				util::CriticalSection::SafeLock l(mutex);
 
-				entry = start;
+				if(needScan(key1, key2))
+				{
+					entry = start;
+					while(entry != NULL)
+					{
+						if((entry->key1 == key1 && entry->key2 == key2)
+							|| compare(key1, key2, entry))
+						{
+							return entry;
+						}
+						entry = entry->next;
+					}
+					return NULL;
+				}
+
+				entry = buckets[hashKey(key1, key2) & (nBuckets - 1)];
 				while(entry != NULL)
 				{
 					if((entry->key1 == key1 && entry->key2 == key2)
@@ -121,7 +171,14 @@ namespace faker
 					{
 						return entry;
 					}
-					entry = entry->next;
+					entry = entry->chain;
+				}
+
+				entry = aliasBuckets[mix((size_t)key2) & (nBuckets - 1)];
+				while(entry != NULL)
+				{
+					if(compare(key1, key2, entry)) return entry;
+					entry = entry->aliasChain;
 				}
 				return NULL;
 			}
@@ -130,6 +187,9 @@ namespace faker
 			{
 				util::CriticalSection::SafeLock l(mutex);
 
+				unlink(buckets, entry->hash, entry, &HashEntry::chain);
+				if(entry->hasAlias)
+					unlink(aliasBuckets, entry->aliasHash, entry, &HashEntry::aliasChain);
 				if(entry->prev) entry->prev->next = entry->next;
 				if(entry->next) entry->next->prev = entry->prev;
 				if(entry == start) start = entry->next;
@@ -149,9 +209,106 @@ namespace faker
 			virtual bool compare(HashKeyType1 key1, HashKeyType2 key2,
 				HashEntry *entry) = 0;
 
+			// Return the bucket hash for the given keys.  Any two sets of keys for
+			// which compare() can return true must produce the same hash.
+			virtual size_t hashKey(HashKeyType1 key1, HashKeyType2 key2)
+			{
+				return mix((size_t)key1 ^ mix((size_t)key2));
+			}
+
+			// Return true and set alias to a secondary key under which the entry
+			// should also be found.  The alias is re-evaluated whenever the entry's
+			// value changes.
+			virtual bool getAlias(HashEntry *entry, HashKeyType2 &alias)
+			{
+				return false;
+			}
+
+			// Return true if a lookup for the given keys must scan all entries
+			virtual bool needScan(HashKeyType1 key1, HashKeyType2 key2)
+			{
+				return false;
+			}
+
+			static size_t mix(size_t h)
+			{
+				// 64-bit finalizer from MurmurHash3
+				unsigned long long x = (unsigned long long)h;
+				x ^= x >> 33;  x *= 0xff51afd7ed558ccdULL;
+				x ^= x >> 33;  x *= 0xc4ceb9fe1a85ec53ULL;
+				x ^= x >> 33;
+				return (size_t)x;
+			}
+
 			int count;
 			HashEntry *start, *end;
 			util::CriticalSection mutex;
+
+		private:
+
+			typedef HashEntry *HashEntry::*ChainPtr;
+
+			void link(HashEntry **table, size_t hash, HashEntry *entry,
+				ChainPtr chain)
+			{
+				size_t i = hash & (nBuckets - 1);
+				entry->*chain = table[i];
+				table[i] = entry;
+			}
+
+			void unlink(HashEntry **table, size_t hash, HashEntry *entry,
+				ChainPtr chain)
+			{
+				HashEntry **ptr = &table[hash & (nBuckets - 1)];
+				while(*ptr != NULL)
+				{
+					if(*ptr == entry)
+					{
+						*ptr = entry->*chain;  entry->*chain = NULL;
+						return;
+					}
+					ptr = &((*ptr)->*chain);
+				}
+			}
+
+			void updateAlias(HashEntry *entry)
+			{
+				HashKeyType2 alias;
+
+				if(entry->hasAlias)
+				{
+					unlink(aliasBuckets, entry->aliasHash, entry, &HashEntry::aliasChain);
+					entry->hasAlias = false;
+				}
+				if(entry->value && getAlias(entry, alias))
+				{
+					entry->aliasHash = mix((size_t)alias);
+					entry->hasAlias = true;
+					link(aliasBuckets, entry->aliasHash, entry, &HashEntry::aliasChain);
+				}
+			}
+
+			void rehash(int newNBuckets)
+			{
+				HashEntry *entry;
+
+				delete [] buckets;
+				delete [] aliasBuckets;
+				nBuckets = newNBuckets;
+				buckets = new HashEntry *[nBuckets];
+				aliasBuckets = new HashEntry *[nBuckets];
+				memset(buckets, 0, sizeof(HashEntry *) * nBuckets);
+				memset(aliasBuckets, 0, sizeof(HashEntry *) * nBuckets);
+				for(entry = start; entry != NULL; entry = entry->next)
+				{
+					link(buckets, entry->hash, entry, &HashEntry::chain);
+					if(entry->hasAlias)
+						link(aliasBuckets, entry->aliasHash, entry, &HashEntry::aliasChain);
+				}
+			}
+
+			int nBuckets;
+			HashEntry **buckets, **aliasBuckets;
 	};
 }
 
@@ -103,6 +103,22 @@ namespace faker
 				);
 			}
 
+			// Entries are matched by either Pixmap ID or 3D pixmap ID (never by
+			// display string alone), so hash only key2 and index the 3D pixmap ID as
+			// an alias.
+			size_t hashKey(char *key1, Pixmap key2)
+			{
+				return mix((size_t)key2);
+			}
+
+			bool getAlias(HashEntry *entry, Pixmap &alias)
+			{
+				VirtualPixmap *vpm = entry->value;
+				if(!vpm || !vpm->getGLXDrawable()) return false;
+				alias = vpm->getGLXDrawable();
+				return true;
+			}
+
 			static PixmapHash *instance;
 			static util::CriticalSection instanceMutex;
 	};
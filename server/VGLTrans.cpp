@@ -13,6 +13,7 @@
 // wxWindows Library License for more details.
 
 #include "VGLTrans.h"
+#include "FrameTracer.h"
 #include "Timer.h"
 #include "fakerconfig.h"
 #include "vglutil.h"
@@ -25,6 +26,13 @@ using namespace common;
 using namespace server;
 
 
+const double VGLTrans::IDLEREFRESH = 0.25;
+
+TileScheduler *TileScheduler::instance = NULL;
+CriticalSection TileScheduler::instanceMutex;
+volatile unsigned int TileScheduler::focusWin = 0;
+
+
 #define ENDIANIZE(h) \
 { \
 	if(!LittleEndian()) \
@@ -38,6 +46,7 @@ using namespace server;
 		h.x = BYTESWAP16(h.x); \
 		h.y = BYTESWAP16(h.y); \
 		h.dpynum = BYTESWAP16(h.dpynum); \
+		h.frameid = BYTESWAP(h.frameid); \
 	} \
 }
 
@@ -85,6 +94,7 @@ void VGLTrans::sendHeader(rrframeheader h, bool eof)
 		ENDIANIZE_V1(h1);
 		if(socket)
 		{
+			flush();
 			send((char *)&h1, sizeof_rrframeheader_v1);
 			recv(&reply, 1);
 			if(reply == 1)
@@ -101,6 +111,9 @@ void VGLTrans::sendHeader(rrframeheader h, bool eof)
 				v = version;
 				v.major = RR_MAJOR_VERSION;  v.minor = RR_MINOR_VERSION;
 				send((char *)&v, sizeof_rrversion);
+				if(fconfig.maxinflight >= 1
+					&& (version.major > 2 || (version.major == 2 && version.minor >= 3)))
+					maxInFlight = fconfig.maxinflight;
 			}
 			if(fconfig.verbose)
 				vglout.println("[VGL] Client version: %d.%d", version.major,
@@ -110,7 +123,11 @@ void VGLTrans::sendHeader(rrframeheader h, bool eof)
 	if((version.major < 2 || (version.major == 2 && version.minor < 1))
 		&& h.compress != RRCOMP_JPEG)
 		THROW("This compression mode requires VirtualGL Client v2.1 or later");
-	if(eof) h.flags = RR_EOF;
+	if((version.major < 2 || (version.major == 2 && version.minor < 2))
+		&& h.compress == RRCOMP_LOSSLESS)
+		THROW("Lossless compression requires VirtualGL Client v3.2 or later");
+	// The client acknowledges a frame only if the server requests it.
+	if(eof) h.flags = maxInFlight > 0 ? RR_EOF_ACK : RR_EOF;
 	if(version.major == 1 && version.minor == 0)
 	{
 		rrframeheader_v1 h1;
@@ -119,10 +136,13 @@ void VGLTrans::sendHeader(rrframeheader h, bool eof)
 		ENDIANIZE_V1(h1);
 		if(socket)
 		{
-			send((char *)&h1, sizeof_rrframeheader_v1);
+			if(batchCount >= MAXBATCH) flush();
+			memcpy(batchHeaders[batchCount], &h1, sizeof_rrframeheader_v1);
+			queue(batchHeaders[batchCount], sizeof_rrframeheader_v1);
 			if(eof)
 			{
 				char cts = 0;
+				flush();
 				recv(&cts, 1);
 				if(cts < 1 || cts > 2) THROW("CTS Error");
 			}
@@ -130,16 +150,110 @@ void VGLTrans::sendHeader(rrframeheader h, bool eof)
 	}
 	else
 	{
+		// Protocol v2.0 through v2.2 clients expect the header without the frame
+		// ID.
+		int size =
+			(version.major > 2 || (version.major == 2 && version.minor >= 3)) ?
+			sizeof_rrframeheader : sizeof_rrframeheader_v2;
 		ENDIANIZE(h);
-		send((char *)&h, sizeof_rrframeheader);
+		if(batchCount >= MAXBATCH) flush();
+		memcpy(batchHeaders[batchCount], &h, size);
+		queue(batchHeaders[batchCount], size);
+		if(eof)
+		{
+			flush();
+			if(maxInFlight > 0)
+			{
+				CriticalSection::SafeLock l(ackMutex);
+				inFlight++;
+			}
+		}
+	}
+}
+
+
+// Block until the number of frames that the client has not yet acknowledged
+// is below the limit
+
+void VGLTrans::waitForAcks(void)
+{
+	while(maxInFlight > 0)
+	{
+		{
+			CriticalSection::SafeLock l(ackMutex);
+			if(inFlight < maxInFlight) break;
+		}
+		char ack = 0;
+		double traceStart = FrameTracer::start();
+		recv(&ack, 1);
+		if(curFrame)
+			FrameTracer::end("Ack wait", curFrame->hdr.winid,
+				curFrame->hdr.frameid, traceStart);
+		if(ack != 1) THROW("Frame acknowledgement error");
+		CriticalSection::SafeLock l(ackMutex);
+		inFlight--;
+	}
+}
+
+
+// Add a buffer to the current batch.  The buffer must remain valid until the
+// batch is flushed.
+
+void VGLTrans::queue(char *buf, int len)
+{
+	if(batchCount >= MAXBATCH) flush();
+	batch[batchCount].buf = buf;  batch[batchCount].len = len;
+	batchCount++;
+}
+
+
+void VGLTrans::flush(void)
+{
+	if(batchCount < 1)
+	{
+		releaseBatch();  return;
+	}
+	try
+	{
+		if(socket)
+		{
+			Timer sendTimer;
+			sendTimer.start();
+			double traceStart = FrameTracer::start();
+			socket->send(batch, batchCount);
+			sendTime += sendTimer.elapsed();
+			if(curFrame)
+				FrameTracer::end("Send", curFrame->hdr.winid, curFrame->hdr.frameid,
+					traceStart);
+		}
+	}
+	catch(...)
+	{
+		batchCount = 0;  releaseBatch();
+		vglout.println("[VGL] ERROR: Could not send data to client.  Client may have disconnected.");
+		throw;
 	}
+	batchCount = 0;
+	releaseBatch();
+}
+
+
+void VGLTrans::releaseBatch(void)
+{
+	for(int i = 0; i < nBatchTiles; i++)
+		batchOwners[i]->releaseCompressedTile(batchTiles[i]);
+	nBatchTiles = 0;
 }
 
 
 VGLTrans::VGLTrans(void) : nprocs(fconfig.np), socket(NULL), thread(NULL),
-	deadYet(false), dpynum(0)
+	deadYet(false), dpynum(0), tiles(NULL), doneList(NULL), nTiles(0),
+	maxTiles(0), nextTile(0), nDone(0), curFrame(NULL), curLastFrame(NULL),
+	busySlots(0), prevJob(NULL), nextJob(NULL), queued(false), batchCount(0),
+	nBatchTiles(0), sendTime(0.), inFlight(0), maxInFlight(0)
 {
 	memset(&version, 0, sizeof(rrversion));
+	for(int i = 0; i < MAXPROCS; i++) comp[i] = NULL;
 	profTotal.setName("Total     ");
 	#ifdef USEHELGRIND
 	ANNOTATE_BENIGN_RACE_SIZED(&deadYet, sizeof(bool), );
@@ -150,6 +264,18 @@ VGLTrans::VGLTrans(void) : nprocs(fconfig.np), socket(NULL), thread(NULL),
 }
 
 
+VGLTrans::~VGLTrans(void)
+{
+	deadYet = true;  q.release();
+	if(thread) { thread->stop();  delete thread;  thread = NULL; }
+	if(TileScheduler::isAlloc()) TILESCHED.finish(this);
+	for(int i = 0; i < MAXPROCS; i++) { delete comp[i];  comp[i] = NULL; }
+	delete socket;  socket = NULL;
+	free(tiles);  tiles = NULL;
+	free(doneList);  doneList = NULL;
+}
+
+
 void VGLTrans::run(void)
 {
 	Frame *lastf = NULL, *f = NULL;
@@ -159,45 +285,75 @@ void VGLTrans::run(void)
 
 	try
 	{
-		VGLTrans::Compressor *comp[MAXPROCS];  Thread *cthread[MAXPROCS];
+		// This thread does nothing but send.  The shared TileScheduler threads
+		// pull tiles from this instance's work queue, and this thread sends each
+		// compressed tile as soon as it becomes available.  Thus, compression of
+		// subsequent tiles overlaps with transmission of earlier tiles, even if
+		// only one compression thread is used.
 		if(fconfig.verbose)
 			vglout.println("[VGL] Using %d compression threads on %d CPU cores",
 				nprocs, NumProcs());
 		for(i = 0; i < nprocs; i++)
-			comp[i] = new VGLTrans::Compressor(i, this);
-		if(nprocs > 1) for(i = 1; i < nprocs; i++)
-		{
-			cthread[i] = new Thread(comp[i]);
-			cthread[i]->start();
-		}
+			if(!comp[i]) comp[i] = new VGLTrans::Compressor(i, this);
 
 		while(!deadYet)
 		{
-			int np;
-			void *ftemp = NULL;
+			void *ftemp = NULL;  bool resend = false;
 
-			q.get(&ftemp);  f = (Frame *)ftemp;  if(deadYet) break;
-			if(!f) THROW("Queue has been shut down");
-			ready.signal();
-			np = nprocs;  if(f->hdr.compress == RRCOMP_YUV) np = 1;
-			if(np > 1)
+			// If the quality was reduced in order to keep up with the application,
+			// and the application stops rendering, then resend the last frame at
+			// full quality once the scene has been static for a while.
+			if(fconfig.adaptive && lastf && quality.isDegraded())
 			{
-				for(i = 1; i < np; i++)
-				{
-					cthread[i]->checkError();  comp[i]->go(f, lastf);
-				}
+				q.get(&ftemp, IDLEREFRESH);
+				if(deadYet) break;
+				if(!ftemp) resend = true;
 			}
-			comp[0]->compressSend(f, lastf);
-			bytes += comp[0]->bytes;
-			if(np > 1)
+			if(resend)
 			{
-				for(i = 1; i < np; i++)
+				f = lastf;
+				quality.restore(f->hdr);
 				{
-					comp[i]->stop();  cthread[i]->checkError();  comp[i]->send();
-					bytes += comp[i]->bytes;
+					CriticalSection::SafeLock l(processMutex);
+					bytes = processFrame(f, NULL);
 				}
+				waitForAcks();
+				if(fconfig.verbose)
+					vglout.println("[VGL] Scene is static.  Resent frame at full quality");
+				profTotal.endFrame(f->hdr.width * f->hdr.height, bytes, 1);
+				bytes = 0;
+				profTotal.startFrame();
+				continue;
+			}
+
+			if(!ftemp) q.get(&ftemp);
+			f = (Frame *)ftemp;  if(deadYet) break;
+			if(!f) THROW("Queue has been shut down");
+			ready.signal();
+			FrameTracer::end("Queue", f->hdr.winid, f->hdr.frameid,
+				queueTimes[f - frames], FrameTracer::FLOWSTEP);
+
+			bool adapt = fconfig.adaptive && f->hdr.compress == RRCOMP_JPEG;
+			bool fullFrame = adapt ? quality.apply(f->hdr) : false;
+			// The tiles of the last frame were sent at whatever quality was in
+			// effect at the time, and the controller will resend the whole frame
+			// once it restores the full quality.  Thus, tiles are compared based
+			// only on their pixels, so that a change in quality does not force
+			// every tile to be resent.
+			if(adapt && !fullFrame && lastf && lastf->hdr.compress == RRCOMP_JPEG)
+			{
+				lastf->hdr.qual = f->hdr.qual;  lastf->hdr.subsamp = f->hdr.subsamp;
 			}
-			sendHeader(f->hdr, true);
+			Timer frameTimer;
+			frameTimer.start();
+			sendTime = 0.;
+			{
+				CriticalSection::SafeLock l(processMutex);
+				bytes = processFrame(f, fullFrame ? NULL : lastf);
+			}
+			if(adapt)
+				quality.update(frameTimer.elapsed(), sendTime, bytes);
+			waitForAcks();
 
 			profTotal.endFrame(f->hdr.width * f->hdr.height, bytes, 1);
 			bytes = 0;
@@ -231,15 +387,6 @@ void VGLTrans::run(void)
 			lastf = f;
 		}
 
-		for(i = 0; i < nprocs; i++) comp[i]->shutdown();
-		if(nprocs > 1) for(i = 1; i < nprocs; i++)
-		{
-			cthread[i]->stop();
-			cthread[i]->checkError();
-			delete cthread[i];
-		}
-		for(i = 0; i < nprocs; i++) delete comp[i];
-
 	}
 	catch(std::exception &e)
 	{
@@ -250,6 +397,182 @@ void VGLTrans::run(void)
 }
 
 
+// Compress and send a frame, comparing it with lastf if interframe comparison
+// is enabled, and return the number of compressed bytes that were sent
+long VGLTrans::processFrame(Frame *f, Frame *lastf)
+{
+	long bytes = 0;
+	double traceStart = FrameTracer::start();
+
+	curFrame = f;
+	if(f->hdr.compress != RRCOMP_YUV)
+	{
+		int n = initTiles(f);
+		if(fconfig.interframe && fconfig.tilehash) f->initTileHashes(n);
+		curLastFrame = lastf;
+		TILESCHED.submit(this, n);
+		for(int t = 0; t < n; t++)
+		{
+			Compressor *owner = NULL;
+			CompressedFrame *ctile = NULL;
+			try
+			{
+				// Send the tiles that have been queued so far before waiting for
+				// the next one to be compressed.
+				if(!isTileCompleted(t)) flush();
+				ctile = getCompletedTile(t, &owner);
+				if(ctile) bytes += sendTile(ctile, owner);
+			}
+			catch(...)
+			{
+				cancelTiles();
+				TILESCHED.finish(this);
+				while(++t < n)
+				{
+					if((ctile = getCompletedTile(t, &owner)) != NULL)
+						owner->releaseCompressedTile(ctile);
+				}
+				batchCount = 0;  releaseBatch();
+				throw;
+			}
+		}
+		waitForCompressors();
+	}
+	else
+	{
+		comp[0]->compressSend(f);
+		bytes += comp[0]->bytes;
+	}
+	sendHeader(f->hdr, true);
+	FrameTracer::end("Transmit", f->hdr.winid, f->hdr.frameid, traceStart,
+		FrameTracer::FLOWSTEP);
+
+	return bytes;
+}
+
+
+// Wait until the shared compression threads have finished with the current
+// frame, and report any error that occurred while compressing it
+
+void VGLTrans::waitForCompressors(void)
+{
+	TILESCHED.finish(this);
+	if(compressError)
+	{
+		Error e = compressError;
+		compressError = Error();
+		throw e;
+	}
+}
+
+
+// Write the current quality and subsampling levels into the frame header.
+// The header contains the levels specified by the user, which serve as the
+// ceiling for the controller.  Returns true if the frame must be sent in its
+// entirety (because the quality was restored after a static scene, and tiles
+// that haven't changed since the last frame would otherwise remain at the
+// reduced quality.)
+
+bool VGLTrans::QualityController::apply(rrframeheader &hdr)
+{
+	// If the user changed the quality or subsampling, then the whole frame must
+	// be resent using the new settings.
+	if(hdr.qual != maxQual || hdr.subsamp != minSubsamp)
+	{
+		refresh = maxQual >= 0;
+		maxQual = qual = hdr.qual;  minSubsamp = subsamp = hdr.subsamp;
+		goodFrames = 0;
+	}
+	hdr.qual = qual;  hdr.subsamp = subsamp;
+	bool retval = refresh;
+	refresh = false;
+	return retval;
+}
+
+
+void VGLTrans::QualityController::restore(rrframeheader &hdr)
+{
+	qual = maxQual;  subsamp = minSubsamp;  goodFrames = 0;  refresh = false;
+	hdr.qual = qual;  hdr.subsamp = subsamp;
+}
+
+
+// Adjust the quality and subsampling levels for the next frame, based on how
+// long it took to compress and send the last frame (frameTime), how much of
+// that time was spent waiting on the network (sendTime), and how many bytes
+// were sent.
+
+void VGLTrans::QualityController::update(double frameTime, double sendTime,
+	long bytes)
+{
+	int oldQual = qual, oldSubsamp = subsamp;
+
+	if(maxQual < 0) return;
+
+	// Nothing changed, so this is a good time to restore the full quality.
+	if(bytes == 0)
+	{
+		if(isDegraded())
+		{
+			qual = maxQual;  subsamp = minSubsamp;  refresh = true;
+		}
+		goodFrames = 0;
+	}
+	else
+	{
+		double load = frameTime * fconfig.targetfps;
+		if(fconfig.maxbw > 0. && frameTime > 0.)
+		{
+			double mbits = (double)bytes * 8. / 1000000.;
+			double bwLoad = mbits / (fconfig.maxbw / fconfig.targetfps);
+			if(bwLoad > load) load = bwLoad;
+		}
+
+		// Grayscale and 4:2:0 (or greater) subsampling are left alone, since
+		// the former can't be degraded any further and the latter has already
+		// discarded most of the chroma.
+		bool canSubsamp = subsamp >= 1 && subsamp < 4 && minSubsamp >= 1;
+
+		if(load > 1.1)
+		{
+			goodFrames = 0;
+			int minQual = min(MINQUAL, maxQual);
+			// If compression, rather than the network, is the bottleneck, then
+			// chroma subsampling is the cheapest way to reduce the load.
+			if(sendTime < 0.5 * frameTime && canSubsamp)
+				subsamp *= 2;
+			else if(qual > minQual)
+			{
+				int step = (int)((load - 1.) * 20.);
+				if(step < QUALSTEP) step = QUALSTEP;
+				if(step > 4 * QUALSTEP) step = 4 * QUALSTEP;
+				qual -= step;
+				if(qual < minQual) qual = minQual;
+			}
+			else if(canSubsamp) subsamp *= 2;
+		}
+		else if(load < 0.75 && isDegraded())
+		{
+			if(++goodFrames >= GOODFRAMES)
+			{
+				goodFrames = 0;
+				if(qual < maxQual)
+				{
+					qual += QUALSTEP;
+					if(qual > maxQual) qual = maxQual;
+				}
+				else if(subsamp > minSubsamp) subsamp /= 2;
+			}
+		}
+		else goodFrames = 0;
+	}
+
+	if(fconfig.verbose && (qual != oldQual || subsamp != oldSubsamp))
+		vglout.println("[VGL] Adaptive quality:  JPEG quality = %d, subsamp = %d",
+			qual, subsamp);
+}
+
+
 Frame *VGLTrans::getFrame(int width, int height, int pixelFormat, int flags,
 	bool stereo)
 {
@@ -280,7 +603,9 @@ Frame *VGLTrans::getFrame(int width, int height, int pixelFormat, int flags,
 bool VGLTrans::isReady(void)
 {
 	if(thread) thread->checkError();
-	return q.items() <= 0;
+	if(q.items() > 0) return false;
+	CriticalSection::SafeLock l(ackMutex);
+	return maxInFlight < 1 || inFlight < maxInFlight;
 }
 
 
@@ -290,6 +615,20 @@ void VGLTrans::synchronize(void)
 }
 
 
+// Make any frames that use external pixel buffers (such as persistently mapped
+// PBOs) allocate their own buffers again, so that the external buffers can be
+// freed.  The frames keep their contents, since queued frames have yet to be
+// sent and the last frame sent is used for interframe comparison.  This must
+// be called from the thread that obtains and sends the frames.
+
+void VGLTrans::detachExternalBits(void)
+{
+	if(thread) thread->checkError();
+	CriticalSection::SafeLock l(processMutex);
+	for(int i = 0; i < NFRAMES; i++) frames[i].detachExternalBits();
+}
+
+
 static void _VGLTrans_spoilfct(void *f)
 {
 	if(f) ((Frame *)f)->signalComplete();
@@ -300,30 +639,22 @@ void VGLTrans::sendFrame(Frame *f)
 {
 	if(thread) thread->checkError();
 	f->hdr.dpynum = dpynum;
+	queueTimes[f - frames] = FrameTracer::start();
 	q.spoil((void *)f, _VGLTrans_spoilfct);
 }
 
 
-void VGLTrans::Compressor::compressSend(Frame *f, Frame *lastf)
+// Divide the frame into tiles and reset the work queue.  Tiles at the right
+// and bottom edges of the frame are extended, rather than creating a tile that
+// is less than half the tile size.
+int VGLTrans::initTiles(Frame *f)
 {
-	CompressedFrame cframe;
-
-	if(!f) return;
 	int tilesizex = fconfig.tilesize ? fconfig.tilesize : f->hdr.width;
 	int tilesizey = fconfig.tilesize ? fconfig.tilesize : f->hdr.height;
 	int i, j, n = 0;
 
-	if(f->hdr.compress == RRCOMP_YUV)
-	{
-		profComp.startFrame();
-		cframe = *f;
-		profComp.endFrame(f->hdr.framew * f->hdr.frameh, 0, 1);
-		parent->sendHeader(cframe.hdr);
-		parent->send((char *)cframe.bits, cframe.hdr.size);
-		return;
-	}
+	CriticalSection::SafeLock l(tileMutex);
 
-	bytes = 0;
 	for(i = 0; i < f->hdr.height; i += tilesizey)
 	{
 		int height = tilesizey, y = i;
@@ -340,44 +671,243 @@ void VGLTrans::Compressor::compressSend(Frame *f, Frame *lastf)
 			{
 				width = f->hdr.width - j;  j += tilesizex;
 			}
-			if(n % nprocs != myRank) continue;
-			if(fconfig.interframe)
+			if(n >= maxTiles)
 			{
-				if(f->tileEquals(lastf, x, y, width, height)) continue;
+				int newMaxTiles = maxTiles ? maxTiles * 2 : 64;
+				Tile *newTiles =
+					(Tile *)realloc(tiles, sizeof(Tile) * newMaxTiles);
+				if(!newTiles) THROW("Memory allocation error");
+				tiles = newTiles;
+				int *newDoneList =
+					(int *)realloc(doneList, sizeof(int) * newMaxTiles);
+				if(!newDoneList) THROW("Memory allocation error");
+				doneList = newDoneList;  maxTiles = newMaxTiles;
 			}
-			Frame *tile = f->getTile(x, y, width, height);
-			CompressedFrame *ctile = NULL;
-			if(myRank > 0) { ctile = new CompressedFrame(); }
-			else ctile = &cframe;
-			profComp.startFrame();
-			*ctile = *tile;
-			double frames = (double)(tile->hdr.width * tile->hdr.height) /
-				(double)(tile->hdr.framew * tile->hdr.frameh);
-			profComp.endFrame(tile->hdr.width * tile->hdr.height, 0, frames);
-			bytes += ctile->hdr.size;
-			if(ctile->stereo) bytes += ctile->rhdr.size;
-			delete tile;
-			if(myRank == 0)
-			{
-				parent->sendHeader(ctile->hdr);
-				parent->send((char *)ctile->bits, ctile->hdr.size);
-				if(ctile->stereo && ctile->rbits)
-				{
-					parent->sendHeader(ctile->rhdr);
-					parent->send((char *)ctile->rbits, ctile->rhdr.size);
-				}
-			}
-			else
+			tiles[n].x = x;  tiles[n].y = y;
+			tiles[n].width = width;  tiles[n].height = height;
+			tiles[n].cframe = NULL;  tiles[n].owner = NULL;
+		}
+	}
+	nTiles = n;  nextTile = 0;  nDone = 0;
+	return n;
+}
+
+
+// Claim the next tile in the work queue, or return -1 if there are none left
+int VGLTrans::getNextTile(void)
+{
+	CriticalSection::SafeLock l(tileMutex);
+
+	if(nextTile >= nTiles) return -1;
+	return nextTile++;
+}
+
+
+void VGLTrans::tileDone(int index, CompressedFrame *cframe, Compressor *owner)
+{
+	{
+		CriticalSection::SafeLock l(tileMutex);
+		tiles[index].cframe = cframe;  tiles[index].owner = owner;
+		doneList[nDone++] = index;
+	}
+	tileReady.signal();
+}
+
+
+// Remove all unclaimed tiles from the work queue and mark them as done, so the
+// sender will not wait for them
+void VGLTrans::cancelTiles(void)
+{
+	{
+		CriticalSection::SafeLock l(tileMutex);
+		for(int i = nextTile; i < nTiles; i++) doneList[nDone++] = i;
+		nextTile = nTiles;
+	}
+	tileReady.signal();
+}
+
+
+// Returns true if at least n + 1 tiles have been compressed, i.e. if
+// getCompletedTile(n) would not block
+bool VGLTrans::isTileCompleted(int n)
+{
+	CriticalSection::SafeLock l(tileMutex);
+
+	return nDone > n;
+}
+
+
+bool VGLTrans::hasPendingTiles(void)
+{
+	CriticalSection::SafeLock l(tileMutex);
+
+	return nextTile < nTiles;
+}
+
+
+// Wait until at least n + 1 tiles have been compressed, and take ownership of
+// the (n + 1)th tile to be completed (NULL if the tile was unchanged or could
+// not be compressed.)  Tiles are returned in the order in which they finished,
+// which is not necessarily the order in which they appear in the frame.  The
+// compressed tile must be returned to the pool of the compressor that
+// produced it (owner) once it has been sent.
+CompressedFrame *VGLTrans::getCompletedTile(int n, Compressor **owner)
+{
+	while(true)
+	{
+		{
+			CriticalSection::SafeLock l(tileMutex);
+			if(nDone > n)
 			{
-				store(ctile);
+				Tile &tile = tiles[doneList[n]];
+				CompressedFrame *cframe = tile.cframe;
+				tile.cframe = NULL;
+				if(owner) *owner = tile.owner;
+				return cframe;
 			}
 		}
+		tileReady.wait();
+	}
+}
+
+
+// Queue a compressed tile for transmission.  The batch takes ownership of the
+// tile, even if an error occurs.
+
+long VGLTrans::sendTile(CompressedFrame *cframe, Compressor *owner)
+{
+	long bytes = cframe->hdr.size;
+
+	try
+	{
+		// Make sure that the headers and payloads of the tile fit into the
+		// current batch, so the tile won't be released while it is still
+		// referenced.
+		if(batchCount > MAXBATCH - 4 || nBatchTiles >= MAXBATCH) flush();
+		sendHeader(cframe->hdr);
+		queue((char *)cframe->bits, cframe->hdr.size);
+		if(cframe->stereo && cframe->rbits)
+		{
+			sendHeader(cframe->rhdr);
+			queue((char *)cframe->rbits, cframe->rhdr.size);
+			bytes += cframe->rhdr.size;
+		}
+	}
+	catch(...)
+	{
+		owner->releaseCompressedTile(cframe);
+		throw;
+	}
+	batchTiles[nBatchTiles] = cframe;  batchOwners[nBatchTiles] = owner;
+	nBatchTiles++;
+	return bytes;
+}
+
+
+bool VGLTrans::Compressor::compressTile(Frame *f, Frame *lastf, int index,
+	CompressedFrame &ctile)
+{
+	Tile &t = parent->tiles[index];
+
+	if(fconfig.interframe)
+	{
+		if(f->tileEquals(lastf, t.x, t.y, t.width, t.height,
+			fconfig.tilehash ? index : -1))
+			return false;
+	}
+	f->getTile(t.x, t.y, t.width, t.height, &tile);
+	long allocsBefore = ctile.allocs;
+	double traceStart = FrameTracer::start();
+	profComp.startFrame();
+	ctile = tile;
+	double frames = (double)(tile.hdr.width * tile.hdr.height) /
+		(double)(tile.hdr.framew * tile.hdr.frameh);
+	profComp.countAllocs(allocs + ctile.allocs - allocsBefore);
+	allocs = 0;
+	profComp.endFrame(tile.hdr.width * tile.hdr.height, 0, frames);
+	FrameTracer::end("Compress", f->hdr.winid, f->hdr.frameid, traceStart,
+		FrameTracer::NOFLOW, index);
+	return true;
+}
+
+
+CompressedFrame *VGLTrans::Compressor::getCompressedTile(void)
+{
+	CriticalSection::SafeLock l(poolMutex);
+
+	if(poolCount > 0) return pool[--poolCount];
+	allocs++;
+	return new CompressedFrame();
+}
+
+
+void VGLTrans::Compressor::releaseCompressedTile(CompressedFrame *ctile)
+{
+	if(!ctile) return;
+	CriticalSection::SafeLock l(poolMutex);
+
+	if(poolCount >= poolMax)
+	{
+		int newPoolMax = poolMax ? poolMax * 2 : 16;
+		CompressedFrame **newPool = (CompressedFrame **)realloc(pool,
+			sizeof(CompressedFrame *) * newPoolMax);
+		if(!newPool) { delete ctile;  return; }
+		pool = newPool;  poolMax = newPoolMax;
 	}
+	pool[poolCount++] = ctile;
+}
+
+
+// YUV encoding:  encode and send the whole frame from the calling thread
+void VGLTrans::Compressor::compressSend(Frame *f)
+{
+	CompressedFrame cframe;
+
+	if(!f) return;
+
+	double traceStart = FrameTracer::start();
+	profComp.startFrame();
+	cframe = *f;
+	profComp.endFrame(f->hdr.framew * f->hdr.frameh, 0, 1);
+	FrameTracer::end("Compress", f->hdr.winid, f->hdr.frameid, traceStart);
+	parent->sendHeader(cframe.hdr);
+	parent->queue((char *)cframe.bits, cframe.hdr.size);
+	parent->flush();
+	bytes = cframe.hdr.size;
+}
+
+
+// Claim the next tile in the work queue, compress it, and hand it off to the
+// sender.  Returns false if there were no tiles left.
+
+bool VGLTrans::Compressor::compressNextTile(void)
+{
+	int i;
+
+	if((i = parent->getNextTile()) < 0) return false;
+	CompressedFrame *ctile = getCompressedTile();
+	try
+	{
+		if(!compressTile(parent->curFrame, parent->curLastFrame, i, *ctile))
+		{
+			releaseCompressedTile(ctile);  ctile = NULL;
+		}
+	}
+	catch(...)
+	{
+		releaseCompressedTile(ctile);
+		parent->tileDone(i, NULL, this);
+		parent->cancelTiles();
+		throw;
+	}
+	parent->tileDone(i, ctile, this);
+	return true;
 }
 
 
 void VGLTrans::send(char *buf, int len)
 {
+	flush();
 	try
 	{
 		if(socket) socket->send(buf, len);
@@ -408,6 +938,15 @@ void VGLTrans::connect(char *displayName, unsigned short port)
 {
 	char *serverName = NULL;
 
+	if(!displayName)
+	{
+		// Local test only:  compress the frames but don't send them anywhere
+		version.major = RR_MAJOR_VERSION;  version.minor = RR_MINOR_VERSION;
+		thread = new Thread(this);
+		thread->start();
+		return;
+	}
+
 	try
 	{
 		if(!displayName || strlen(displayName) <= 0)
@@ -471,20 +1010,138 @@ void VGLTrans::connect(char *displayName, unsigned short port)
 }
 
 
-void VGLTrans::Compressor::send(void)
+void TileScheduler::Worker::run(void)
+{
+	while(true)
+	{
+		parent->work.wait();  if(parent->deadYet) break;
+		while(parent->compressNextTile()) {}
+	}
+}
+
+
+void TileScheduler::submit(VGLTrans *trans, int nTiles)
 {
-	for(int i = 0; i < storedFrames; i++)
+	CriticalSection::SafeLock l(mutex);
+
+	if(!trans->queued)
+	{
+		trans->prevJob = tail;  trans->nextJob = NULL;
+		if(tail) tail->nextJob = trans;
+		else head = trans;
+		tail = trans;  trans->queued = true;
+	}
+
+	// Start only as many threads as the queued instances can use at once, up
+	// to the number of CPU cores
+	int maxWorkers = 0;
+	for(VGLTrans *t = head; t; t = t->nextJob) maxWorkers += t->nprocs;
+	maxWorkers = min(maxWorkers, min(NumProcs(), MAXPROCS));
+	while(nWorkers < maxWorkers)
+	{
+		Worker *worker = new Worker(this);
+		worker->start();
+		workers[nWorkers++] = worker;
+	}
+
+	int posts = min(nTiles, trans->nprocs);
+	for(int i = 0; i < posts; i++) work.post();
+}
+
+
+void TileScheduler::unlink(VGLTrans *trans)
+{
+	if(!trans->queued) return;
+	if(trans->prevJob) trans->prevJob->nextJob = trans->nextJob;
+	else head = trans->nextJob;
+	if(trans->nextJob) trans->nextJob->prevJob = trans->prevJob;
+	else tail = trans->prevJob;
+	trans->prevJob = trans->nextJob = NULL;  trans->queued = false;
+}
+
+
+void TileScheduler::finish(VGLTrans *trans)
+{
+	while(true)
 	{
-		CompressedFrame *cf = cframes[i];
-		ERRIFNOT(cf);
-		parent->sendHeader(cf->hdr);
-		parent->send((char *)cf->bits, cf->hdr.size);
-		if(cf->stereo && cf->rbits)
 		{
-			parent->sendHeader(cf->rhdr);
-			parent->send((char *)cf->rbits, cf->rhdr.size);
+			CriticalSection::SafeLock l(mutex);
+			unlink(trans);
+			if(trans->busySlots <= 0) return;
 		}
-		delete cf;
+		trans->slotsIdle.wait();
+	}
+}
+
+
+// Compress one tile from the instance that is next in line.  Returns false if
+// no instance has a tile that can be compressed right now.  A worker keeps
+// calling this until it returns false, so an instance whose compressors are
+// all busy will be served by those compressors' workers once they finish.
+
+bool TileScheduler::compressNextTile(void)
+{
+	VGLTrans *trans = NULL;
+	VGLTrans::Compressor *c = NULL;
+	unsigned int focus = focusWin;
+
+	{
+		CriticalSection::SafeLock l(mutex);
+
+		for(VGLTrans *t = head; t; t = t->nextJob)
+		{
+			if(t->busySlots >= t->nprocs || !t->hasPendingTiles()) continue;
+			if(focus && t->curFrame && t->curFrame->hdr.winid == focus)
+			{
+				trans = t;  break;
+			}
+			if(!trans) trans = t;
+		}
+		if(!trans) return false;
+		for(int i = 0; i < trans->nprocs; i++)
+		{
+			if(trans->comp[i] && !trans->comp[i]->busy)
+			{
+				c = trans->comp[i];  break;
+			}
+		}
+		if(!c) return false;
+		c->busy = true;  trans->busySlots++;
+		// Round robin:  move the instance to the back of the line.
+		unlink(trans);
+		trans->prevJob = tail;
+		if(tail) tail->nextJob = trans;
+		else head = trans;
+		tail = trans;  trans->queued = true;
+	}
+
+	try
+	{
+		c->compressNextTile();
+	}
+	catch(std::exception &e)
+	{
+		CriticalSection::SafeLock l(mutex);
+		if(!trans->compressError) trans->compressError = e;
+	}
+
+	CriticalSection::SafeLock l(mutex);
+	c->busy = false;  trans->busySlots--;
+	// The instance may be destroyed as soon as the mutex is released, so this
+	// must be the last time it is accessed.
+	if(trans->busySlots <= 0) trans->slotsIdle.signal();
+	return true;
+}
+
+
+void TileScheduler::kill(void)
+{
+	deadYet = true;
+	for(int i = 0; i < nWorkers; i++) work.post();
+	for(int i = 0; i < nWorkers; i++)
+	{
+		delete workers[i];  workers[i] = NULL;
 	}
-	storedFrames = 0;
+	nWorkers = 0;
+	deadYet = false;
 }
@@ -19,7 +19,7 @@
 #include "Thread.h"
 #include "rr.h"
 #include "Frame.h"
-#include "GenericQ.h"
+#include "RingQ.h"
 #include "Profiler.h"
 #ifdef USEHELGRIND
 	#include <valgrind/helgrind.h>
@@ -28,123 +28,261 @@
 
 namespace server
 {
+	class TileScheduler;
+
 	class VGLTrans : public util::Runnable
 	{
 		public:
 
 			VGLTrans(void);
 
-			virtual ~VGLTrans(void)
-			{
-				deadYet = true;  q.release();
-				if(thread) { thread->stop();  delete thread;  thread = NULL; }
-				delete socket;  socket = NULL;
-			}
+			virtual ~VGLTrans(void);
 
 			common::Frame *getFrame(int, int, int, int, bool stereo);
 			bool isReady(void);
 			void synchronize(void);
+			void detachExternalBits(void);
 			void sendFrame(common::Frame *);
 			void run(void);
 			void sendHeader(rrframeheader h, bool eof = false);
 			void send(char *, int);
+			void queue(char *, int);
+			void flush(void);
 			void save(char *, int);
 			void recv(char *, int);
+			void waitForAcks(void);
 			void connect(char *, unsigned short);
 
 			int nprocs;
 
 		private:
 
+			friend class TileScheduler;
+			class Compressor;
+
+			// Adjusts the JPEG quality and chroma subsampling of each frame so that
+			// the frame rate or bandwidth target can be met.  The quality and
+			// subsampling specified by the user are never exceeded.
+			class QualityController
+			{
+				public:
+
+					QualityController(void) : qual(-1), subsamp(-1), maxQual(-1),
+						minSubsamp(-1), goodFrames(0), refresh(false) {}
+
+					bool apply(rrframeheader &hdr);
+					void restore(rrframeheader &hdr);
+					void update(double frameTime, double sendTime, long bytes);
+					bool isDegraded(void)
+					{
+						return qual != maxQual || subsamp != minSubsamp;
+					}
+
+				private:
+
+					static const int MINQUAL = 20, QUALSTEP = 5, GOODFRAMES = 10;
+
+					int qual, subsamp, maxQual, minSubsamp, goodFrames;
+					bool refresh;
+			};
+
+			long processFrame(common::Frame *f, common::Frame *lastf);
+			void waitForCompressors(void);
+
+			// Describes one tile of the frame that is currently being compressed
+			typedef struct
+			{
+				int x, y, width, height;
+				common::CompressedFrame *cframe;
+				Compressor *owner;
+			} Tile;
+
+			int initTiles(common::Frame *f);
+			int getNextTile(void);
+			void tileDone(int index, common::CompressedFrame *cframe,
+				Compressor *owner);
+			void cancelTiles(void);
+			bool isTileCompleted(int n);
+			bool hasPendingTiles(void);
+			common::CompressedFrame *getCompletedTile(int n, Compressor **owner);
+			long sendTile(common::CompressedFrame *cframe, Compressor *owner);
+			void releaseBatch(void);
+
 			util::Socket *socket;
 			static const int NFRAMES = 4;
 			util::CriticalSection mutex;
 			common::Frame frames[NFRAMES];
+			double queueTimes[NFRAMES];  // When each frame was queued (tracing)
 			util::Event ready;
-			util::GenericQ q;
+			util::RingQ q;
+			// Held by the sender thread while it is reading the pixels of a frame
+			util::CriticalSection processMutex;
 			util::Thread *thread;  bool deadYet;
 			common::Profiler profTotal;
 			int dpynum;
 			rrversion version;
+			Tile *tiles;  int *doneList, nTiles, maxTiles, nextTile, nDone;
+			common::Frame *curFrame, *curLastFrame;
+			util::CriticalSection tileMutex;
+			util::Event tileReady;
 
-		class Compressor : public util::Runnable
+			// The compressors are not threads.  They hold the per-thread state
+			// (tile descriptor, pool of compressed tiles, and profiler) that the
+			// shared TileScheduler threads use while compressing tiles for this
+			// instance.  The following are protected by the scheduler's mutex.
+			Compressor *comp[MAXPROCS];  int busySlots;
+			util::Event slotsIdle;
+			util::Error compressError;
+			VGLTrans *prevJob, *nextJob;  bool queued;
+
+			// Headers and payloads are queued and sent with a single scatter-gather
+			// send() call whenever the sender would otherwise have to wait.  The
+			// compressed tiles referenced by the batch are returned to their
+			// compressors' pools once the batch has been sent.
+			static const int MAXBATCH = 64;
+			util::SockBuf batch[MAXBATCH];  int batchCount;
+			char batchHeaders[MAXBATCH][sizeof(rrframeheader)];
+			common::CompressedFrame *batchTiles[MAXBATCH];
+			Compressor *batchOwners[MAXBATCH];  int nBatchTiles;
+			double sendTime;
+
+			// If the client acknowledges each frame that it has displayed, then no
+			// more than maxInFlight frames are allowed to be unacknowledged at any
+			// given time.
+			int inFlight, maxInFlight;
+			util::CriticalSection ackMutex;
+
+			QualityController quality;
+			// Resend the last frame at full quality if no new frames have been
+			// received within this many seconds
+			static const double IDLEREFRESH;
+
+		class Compressor
 		{
 			public:
 
-				Compressor(int myRank_, VGLTrans *parent_) : bytes(0),
-					storedFrames(0), cframes(NULL), frame(NULL), lastFrame(NULL),
-					myRank(myRank_), deadYet(false), parent(parent_)
+				Compressor(int myRank_, VGLTrans *parent_) : bytes(0), busy(false),
+					tile(false), pool(NULL), poolCount(0), poolMax(0), allocs(0),
+					myRank(myRank_), parent(parent_)
 				{
-					if(parent) nprocs = parent->nprocs;
-					ready.wait();  complete.wait();
 					char temps[20];
 					snprintf(temps, 20, "Compress %d", myRank);
 					profComp.setName(temps);
-					#ifdef USEHELGRIND
-					ANNOTATE_BENIGN_RACE_SIZED(&deadYet, sizeof(bool), );
-					#endif
 				}
 
 				virtual ~Compressor(void)
 				{
-					shutdown();
-					free(cframes);  cframes = NULL;
+					for(int i = 0; i < poolCount; i++) delete pool[i];
+					free(pool);  pool = NULL;
 				}
 
-				void run(void)
+				void compressSend(common::Frame *frame);
+				bool compressNextTile(void);
+				void releaseCompressedTile(common::CompressedFrame *ctile);
+
+				long bytes;
+				bool busy;
+
+			private:
+
+				bool compressTile(common::Frame *frame, common::Frame *lastFrame,
+					int index, common::CompressedFrame &ctile);
+				common::CompressedFrame *getCompressedTile(void);
+
+				// Each compressor reuses a single tile descriptor and maintains its own
+				// pool of compressed tiles, which are returned to the pool by the sender
+				// once they have been transmitted.
+				common::Frame tile;
+				common::CompressedFrame **pool;  int poolCount, poolMax;
+				util::CriticalSection poolMutex;
+				long allocs;
+				int myRank;
+				common::Profiler profComp;
+				VGLTrans *parent;
+		};
+	};
+
+
+	// A process-wide pool of threads that compresses tiles for all VGL
+	// Transport instances, so that applications with many windows don't end up
+	// with more compression threads than there are CPU cores.  The threads take
+	// turns compressing one tile from each instance that has tiles waiting,
+	// except that the instance whose window most recently received input is
+	// always served first.  No more than VGL_NPROCS tiles from a given instance
+	// are compressed at the same time.
+
+	class TileScheduler
+	{
+		public:
+
+			static TileScheduler *getInstance(void)
+			{
+				if(instance == NULL)
 				{
-					while(!deadYet)
+					util::CriticalSection::SafeLock l(instanceMutex);
+					if(instance == NULL) instance = new TileScheduler;
+				}
+				return instance;
+			}
+
+			static bool isAlloc(void) { return instance != NULL; }
+
+			static void setFocus(unsigned int winid) { focusWin = winid; }
+
+			// Make the tiles of the frame that trans is currently sending available
+			// to the worker threads
+			void submit(VGLTrans *trans, int nTiles);
+			// Stop scheduling tiles for trans, and wait until the worker threads
+			// are no longer using its compressors
+			void finish(VGLTrans *trans);
+			void kill(void);
+
+		private:
+
+			class Worker : public util::Runnable
+			{
+				public:
+
+					Worker(TileScheduler *parent_) : parent(parent_), thread(NULL) {}
+
+					virtual ~Worker(void)
 					{
-						try
-						{
-							ready.wait();  if(deadYet) break;
-							compressSend(frame, lastFrame);
-							complete.signal();
-						}
-						catch(...)
-						{
-							complete.signal();  throw;
-						}
+						if(thread) { thread->stop();  delete thread;  thread = NULL; }
 					}
-				}
 
-				void go(common::Frame *frame_, common::Frame *lastFrame_)
-				{
-					frame = frame_;  lastFrame = lastFrame_;
-					ready.signal();
-				}
+					void start(void)
+					{
+						thread = new util::Thread(this);
+						thread->start();
+					}
 
-				void stop(void)
-				{
-					complete.wait();
-				}
+				private:
 
-				void shutdown(void) { deadYet = true;  ready.signal(); }
-				void compressSend(common::Frame *frame, common::Frame *lastFrame);
-				void send(void);
+					void run(void);
 
-				long bytes;
+					TileScheduler *parent;
+					util::Thread *thread;
+			};
 
-			private:
+			TileScheduler(void) : nWorkers(0), head(NULL), tail(NULL),
+				deadYet(false) {}
+			~TileScheduler(void) { kill(); }
 
-				void store(common::CompressedFrame *cf)
-				{
-					storedFrames++;
-					if(!(cframes = (common::CompressedFrame **)realloc(cframes,
-						sizeof(common::CompressedFrame *) * storedFrames)))
-						THROW("Memory allocation error");
-					cframes[storedFrames - 1] = cf;
-				}
+			void unlink(VGLTrans *trans);
+			bool compressNextTile(void);
 
-				int storedFrames;  common::CompressedFrame **cframes;
-				common::Frame *frame, *lastFrame;
-				int myRank, nprocs;
-				util::Event ready, complete;  bool deadYet;
-				util::CriticalSection mutex;
-				common::Profiler profComp;
-				VGLTrans *parent;
-		};
+			Worker *workers[MAXPROCS];  int nWorkers;
+			VGLTrans *head, *tail;
+			util::CriticalSection mutex;
+			util::Semaphore work;
+			bool deadYet;
+			static volatile unsigned int focusWin;
+			static TileScheduler *instance;
+			static util::CriticalSection instanceMutex;
 	};
 }
 
+
+#define TILESCHED  (*(server::TileScheduler::getInstance()))
+
 #endif  // __VGLTRANS_H__
@@ -1,6 +1,6 @@
 // Copyright (C)2004 Landmark Graphics Corporation
 // Copyright (C)2005, 2006 Sun Microsystems, Inc.
-// Copyright (C)2009-2015, 2017-2021, 2024 D. R. Commander
+// Copyright (C)2009-2015, 2017-2021, 2024, 2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -26,6 +26,23 @@ using namespace util;
 using namespace faker;
 
 
+// When VGL_PBPOOL is enabled, Pbuffers that are created during an interactive
+// resize are rounded up to a size class, so that subsequent small size changes
+// can be handled by rendering into a sub-rectangle of the existing Pbuffer.
+// Each dimension is rounded up to the next multiple of one quarter of the
+// largest power of 2 that does not exceed it (but at least 64 pixels), which
+// wastes no more than 25% of either dimension on large windows.
+
+#define PBPOOL_MIN_STEP  64
+
+static int sizeClass(int size)
+{
+	int step = PBPOOL_MIN_STEP;
+	while(step * 8 <= size && step < 0x10000000) step <<= 1;
+	return (size + step - 1) / step * step;
+}
+
+
 static Window create_window(Display *dpy, XVisualInfo *vis, int width,
 	int height)
 {
@@ -49,14 +66,16 @@ static Window create_window(Display *dpy, XVisualInfo *vis, int width,
 // Pbuffer constructor
 
 VirtualDrawable::OGLDrawable::OGLDrawable(Display *dpy_, int width_,
-	int height_, VGLFBConfig config_) : cleared(false), stereo(false),
-	glxDraw(0), dpy(dpy_), edpy(EGL_NO_DISPLAY), width(width_), height(height_),
-	depth(0), config(config_), glFormat(0), pm(0), win(0), isPixmap(false)
+	int height_, VGLFBConfig config_, int allocWidth_, int allocHeight_) :
+	cleared(false), stereo(false), glxDraw(0), dpy(dpy_), edpy(EGL_NO_DISPLAY),
+	width(width_), height(height_), allocWidth(max(allocWidth_, width_)),
+	allocHeight(max(allocHeight_, height_)), depth(0), config(config_),
+	glFormat(0), pm(0), win(0), isPixmap(false)
 {
 	if(!config_ || width_ < 1 || height_ < 1) THROW("Invalid argument");
 
-	int pbattribs[] = { GLX_PBUFFER_WIDTH, width, GLX_PBUFFER_HEIGHT, height,
-		GLX_PRESERVED_CONTENTS, True, None };
+	int pbattribs[] = { GLX_PBUFFER_WIDTH, allocWidth,
+		GLX_PBUFFER_HEIGHT, allocHeight, GLX_PRESERVED_CONTENTS, True, None };
 	glxDraw = backend::createPbuffer(dpy, config, pbattribs);
 	if(!glxDraw) THROW("Could not create Pbuffer");
 
@@ -69,8 +88,8 @@ VirtualDrawable::OGLDrawable::OGLDrawable(Display *dpy_, int width_,
 VirtualDrawable::OGLDrawable::OGLDrawable(EGLDisplay edpy_, int width_,
 	int height_, EGLConfig config_, const EGLint *pbAttribs_) : cleared(false),
 	stereo(false), glxDraw(0), dpy(NULL), edpy(edpy_), width(width_),
-	height(height_), depth(0), config((VGLFBConfig)config_), glFormat(0), pm(0),
-	win(0), isPixmap(false)
+	height(height_), allocWidth(width_), allocHeight(height_), depth(0),
+	config((VGLFBConfig)config_), glFormat(0), pm(0), win(0), isPixmap(false)
 {
 	if(!edpy_ || width_ < 1 || height_ < 1 || !config_ || !pbAttribs_)
 		THROW("Invalid argument");
@@ -97,7 +116,8 @@ VirtualDrawable::OGLDrawable::OGLDrawable(EGLDisplay edpy_, int width_,
 VirtualDrawable::OGLDrawable::OGLDrawable(int width_, int height_, int depth_,
 	VGLFBConfig config_, const int *attribs) : cleared(false), stereo(false),
 	glxDraw(0), edpy(EGL_NO_DISPLAY), width(width_), height(height_),
-	depth(depth_), config(config_), glFormat(0), pm(0), win(0), isPixmap(true)
+	allocWidth(width_), allocHeight(height_), depth(depth_), config(config_),
+	glFormat(0), pm(0), win(0), isPixmap(true)
 {
 	if(!config_ || width_ < 1 || height_ < 1 || depth_ < 0)
 		THROW("Invalid argument");
@@ -231,11 +251,17 @@ VirtualDrawable::VirtualDrawable(Display *dpy_, Drawable x11Draw_)
 	config = 0;
 	ctx = 0;
 	direct = -1;
-	pbo = 0;
+	memset(pbo, 0, sizeof(GLuint) * MAXPBOS);
+	pboDepth = 1;  pboHead = pboPrimed = 0;  pboStale = pboDrain = false;
+	pboTime = pboInterval = 0.;
+	pboX = pboY = pboWidth = pboPitch = pboHeight = pboReadBuf = -1;
+	pboFormat = GL_NONE;
 	numSync = numFrames = 0;
 	lastFormat = -1;
 	usePBO = (fconfig.readback == RRREAD_PBO);
+	nMappedPBOs = 0;
 	alreadyPrinted = alreadyWarned = alreadyWarnedRenderMode = false;
+	alreadyWarnedZeroCopy = false;
 	ext = NULL;
 	eventMask = 0;
 }
@@ -265,14 +291,47 @@ int VirtualDrawable::init(int width, int height, VGLFBConfig config_)
 		THROW("VirtualDrawable::init() method not supported with EGL/X11");
 
 	CriticalSection::SafeLock l(mutex);
-	if(oglDraw && oglDraw->getWidth() == width && oglDraw->getHeight() == height
-		&& FBCID(oglDraw->getFBConfig()) == FBCID(config_))
-		return 0;
-	oglDraw = new OGLDrawable(dpy, width, height, config_);
+	int allocWidth = width, allocHeight = height;
+	if(oglDraw && FBCID(oglDraw->getFBConfig()) == FBCID(config_))
+	{
+		if(oglDraw->getWidth() == width && oglDraw->getHeight() == height)
+			return 0;
+		if(fconfig.pbpool)
+		{
+			// This is a resize.  If the new size fits within the existing Pbuffer,
+			// and the existing Pbuffer is no larger than the size class of the new
+			// size, then reuse it.  Otherwise, round the new Pbuffer's size up to
+			// the next size class, so that further small size changes fit within
+			// it.  Thus, a Pbuffer never wastes more than the rounding allows, and
+			// it never has to be swapped out behind the application's back.  The
+			// initial Pbuffer always has the exact size of the window, so an
+			// application that never resizes the window never renders to a
+			// sub-rectangle.
+			allocWidth = sizeClass(width);  allocHeight = sizeClass(height);
+			if(oglDraw->getAllocWidth() <= allocWidth
+				&& oglDraw->getAllocHeight() <= allocHeight
+				&& oglDraw->setSize(width, height))
+				return 0;
+		}
+	}
+	// Release the persistently mapped PBOs before replacing the Pbuffer, since
+	// the readback context must be made current with a compatible drawable in
+	// order to release them.
 	if(config && FBCID(config_) != FBCID(config) && ctx)
 	{
+		if(nMappedPBOs) releaseMappedPBOs();
 		backend::destroyContext(dpy, ctx);  ctx = 0;
 	}
+	try
+	{
+		oglDraw = new OGLDrawable(dpy, width, height, config_, allocWidth,
+			allocHeight);
+	}
+	catch(...)
+	{
+		if(allocWidth == width && allocHeight == height) throw;
+		oglDraw = new OGLDrawable(dpy, width, height, config_);
+	}
 	config = config_;
 	return 1;
 }
@@ -287,6 +346,7 @@ void VirtualDrawable::setDirect(Bool direct_)
 	CriticalSection::SafeLock l(mutex);
 	if(direct_ != direct && ctx)
 	{
+		if(nMappedPBOs) releaseMappedPBOs();
 		backend::destroyContext(dpy, ctx);  ctx = 0;
 	}
 	direct = direct_;
@@ -344,6 +404,9 @@ void VirtualDrawable::initReadbackContext(void)
 			if((ctx = backend::createContext(dpy, config, NULL, direct, NULL)) == 0)
 				THROW("Could not create OpenGL context for readback");
 		}
+		// Any PBOs we created belonged to the previous readback context.
+		memset(pbo, 0, sizeof(GLuint) * MAXPBOS);
+		pboHead = pboPrimed = 0;  pboStale = false;
 	}
 }
 
@@ -398,7 +461,7 @@ bool VirtualDrawable::checkRenderMode(void)
 
 void VirtualDrawable::readPixels(GLint x, GLint y, GLint width, GLint pitch,
 	GLint height, GLenum glFormat, PF *pf, GLubyte *bits, GLint readBuf,
-	bool stereo)
+	bool stereo, bool pipeline)
 {
 	double t0 = 0.0, tRead, tTotal;
 	GLenum type = GL_UNSIGNED_BYTE;
@@ -422,6 +485,42 @@ void VirtualDrawable::readPixels(GLint x, GLint y, GLint width, GLint pitch,
 	}
 	lastFormat = currentFormat;
 
+	// Pipelined (multi-PBO) readback delivers the pixels from an earlier
+	// readback of the same buffer, so it is only used if the caller allows it
+	// and if each frame consists of a single readback.
+	int depth = 1;
+	if(pipeline && !stereo && currentFormat != GL_RED && !fconfig.autotest)
+		depth = fconfig.pbobufs;
+	if(depth < 1 || depth > MAXPBOS) depth = 1;
+
+	// Draining delivers the most recent frame in the PBO ring without reading
+	// back a new frame, which requires that the ring contain a frame with the
+	// same geometry.  Otherwise, the most recent frame has already been
+	// swapped to the front buffer, so read it from there.
+	bool drain = false;
+	if(pboDrain)
+	{
+		drain = pboStale && usePBO && depth > 1 && depth == pboDepth && x == pboX
+			&& y == pboY && width == pboWidth && pitch == pboPitch
+			&& height == pboHeight && glFormat == pboFormat
+			&& readBuf == pboReadBuf;
+		if(!drain)
+		{
+			if(edpy == EGL_NO_DISPLAY)
+				readBuf = readBuf == GL_BACK_LEFT ? GL_FRONT_LEFT :
+					(readBuf == GL_BACK_RIGHT ? GL_FRONT_RIGHT : GL_FRONT);
+			depth = 1;
+		}
+	}
+	if(depth != pboDepth || x != pboX || y != pboY || width != pboWidth
+		|| pitch != pboPitch || height != pboHeight || glFormat != pboFormat
+		|| readBuf != pboReadBuf)
+	{
+		pboDepth = depth;  pboHead = pboPrimed = 0;
+		pboX = x;  pboY = y;  pboWidth = width;  pboPitch = pitch;
+		pboHeight = height;  pboFormat = glFormat;  pboReadBuf = readBuf;
+	}
+
 	if(!checkRenderMode()) return;
 
 	initReadbackContext();
@@ -435,7 +534,68 @@ void VirtualDrawable::readPixels(GLint x, GLint y, GLint width, GLint pitch,
 	else if(pitch % 2 == 0) _glPixelStorei(GL_PACK_ALIGNMENT, 2);
 	else if(pitch % 1 == 0) _glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
-	if(usePBO)
+	// If only a region of the frame is being read back, then the destination
+	// rows are wider than the region.
+	int rowSize = width * pf->size;
+	_glPixelStorei(GL_PACK_ROW_LENGTH,
+		rowSize < pitch && pitch % pf->size == 0 ? pitch / pf->size : 0);
+	int bufSize = rowSize < pitch ? pitch * (height - 1) + rowSize :
+		pitch * height;
+
+	// Zero-copy readback:  If the destination lies within a persistently mapped
+	// PBO, then read back directly into that PBO.
+	MappedPBO *mapped = NULL;
+	if(pboDepth == 1)
+	{
+		for(int i = 0; i < nMappedPBOs; i++)
+		{
+			if(bits >= mappedPBO[i].bits
+				&& bits + bufSize <= mappedPBO[i].bits + mappedPBO[i].size)
+			{
+				mapped = &mappedPBO[i];  break;
+			}
+		}
+	}
+
+	if(drain)
+	{
+		// The ring contains pboPrimed frames, the most recent of which was read
+		// into the PBO before pboHead.  Once it has been delivered, every frame in
+		// the ring is older than the frame that the transport has, so the ring
+		// must be primed again.
+		TRY_GL();
+		profReadback.startFrame();
+		_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT,
+			pbo[(pboHead + pboDepth - 1) % pboDepth]);
+		unsigned char *pboBits = (unsigned char *)_glMapBuffer(
+			GL_PIXEL_PACK_BUFFER_EXT, GL_READ_ONLY);
+		if(!pboBits) THROW("Could not map pixel buffer object");
+		if(rowSize < pitch)
+		{
+			for(int i = 0; i < height; i++)
+				memcpy(&bits[pitch * i], &pboBits[pitch * i], rowSize);
+		}
+		else memcpy(bits, pboBits, pitch * height);
+		if(!_glUnmapBuffer(GL_PIXEL_PACK_BUFFER_EXT))
+			THROW("Could not unmap pixel buffer object");
+		_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, 0);
+		pboPrimed = 0;  pboStale = false;
+		profReadback.endFrame(width * height, 0, 1);
+		CATCH_GL("Could not read pixels");
+		return;
+	}
+
+	if(mapped)
+	{
+		if(!alreadyPrinted && fconfig.verbose)
+		{
+			vglout.println("[VGL] Using zero-copy PBO readback (%s --> %s)",
+				formatString(oglDraw->getFormat()), formatString(glFormat));
+			alreadyPrinted = true;
+		}
+		_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, mapped->pbo);
+	}
+	else if(usePBO)
 	{
 		if(!ext)
 		{
@@ -443,22 +603,28 @@ void VirtualDrawable::readPixels(GLint x, GLint y, GLint width, GLint pitch,
 			if(!ext || !strstr(ext, "GL_ARB_pixel_buffer_object"))
 				THROW("GL_ARB_pixel_buffer_object extension not available");
 		}
-		if(!pbo) _glGenBuffers(1, &pbo);
-		if(!pbo) THROW("Could not generate pixel buffer object");
+		if(!pbo[pboHead]) _glGenBuffers(1, &pbo[pboHead]);
+		if(!pbo[pboHead]) THROW("Could not generate pixel buffer object");
 		if(!alreadyPrinted && fconfig.verbose)
 		{
 			vglout.println("[VGL] Using pixel buffer objects for readback (%s --> %s)",
 				formatString(oglDraw->getFormat()), formatString(glFormat));
+			if(pboDepth > 1)
+				vglout.println("[VGL]    Pipelining readback across %d PBOs (latency = %d frame%s)",
+					pboDepth, pboDepth - 1, pboDepth > 2 ? "s" : "");
 			alreadyPrinted = true;
 		}
-		_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, pbo);
+		_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, pbo[pboHead]);
 		int size = 0;
 		_glGetBufferParameteriv(GL_PIXEL_PACK_BUFFER_EXT, GL_BUFFER_SIZE, &size);
-		if(size != pitch * height)
-			_glBufferData(GL_PIXEL_PACK_BUFFER_EXT, pitch * height, NULL,
-				GL_STREAM_READ);
+		// When VGL_PBPOOL is enabled, the PBO is allocated with room to grow, and
+		// it is reused as long as it is no more than twice as large as necessary.
+		if(fconfig.pbpool ? (size < bufSize || size / 2 > bufSize) :
+			size != bufSize)
+			_glBufferData(GL_PIXEL_PACK_BUFFER_EXT,
+				fconfig.pbpool ? sizeClass(bufSize) : bufSize, NULL, GL_STREAM_READ);
 		_glGetBufferParameteriv(GL_PIXEL_PACK_BUFFER_EXT, GL_BUFFER_SIZE, &size);
-		if(size != pitch * height)
+		if(size < bufSize)
 			THROW("Could not set PBO size");
 	}
 	else
@@ -471,20 +637,56 @@ void VirtualDrawable::readPixels(GLint x, GLint y, GLint width, GLint pitch,
 		}
 	}
 
+	pboStale = false;
 	TRY_GL();
 	profReadback.startFrame();
 	if(usePBO) t0 = GetTime();
 	backend::readPixels(x, y, width, height, glFormat, type,
-		usePBO ? NULL : bits);
+		mapped ? (GLvoid *)(bits - mapped->bits) : (usePBO ? NULL : bits));
 
-	if(usePBO)
+	if(mapped)
+	{
+		// The PBO is mapped coherently, so the pixels are visible to the CPU as
+		// soon as the GPU has finished writing them.
+		GLsync fence = _glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, 0);
+		if(!fence) THROW("Could not create fence sync object");
+		GLenum ret = _glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+			GL_TIMEOUT_IGNORED);
+		_glDeleteSync(fence);
+		if(ret == GL_WAIT_FAILED) THROW("Could not wait for fence sync object");
+	}
+	else if(usePBO)
 	{
 		tRead = GetTime() - t0;
+
+		// Map the oldest PBO in the ring.  Once the ring is full, that is the PBO
+		// that was read into pboDepth - 1 frames ago, which the GPU has most
+		// likely finished transferring by now.  While the ring is filling, the
+		// first frame is delivered repeatedly rather than delivering a newer
+		// frame and then an older one.
+		if(pboPrimed < pboDepth) pboPrimed++;
+		int mapIndex = (pboHead - pboPrimed + 1 + pboDepth) % pboDepth;
+		if(mapIndex != pboHead)
+			_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, pbo[mapIndex]);
+		pboStale = (mapIndex != pboHead);
+		pboHead = (pboHead + 1) % pboDepth;
+		if(pboDepth > 1)
+		{
+			if(pboTime > 0.) pboInterval = t0 - pboTime;
+			pboTime = t0;
+		}
+
 		unsigned char *pboBits = NULL;
 		pboBits = (unsigned char *)_glMapBuffer(GL_PIXEL_PACK_BUFFER_EXT,
 			GL_READ_ONLY);
 		if(!pboBits) THROW("Could not map pixel buffer object");
-		memcpy(bits, pboBits, pitch * height);
+		if(rowSize < pitch)
+		{
+			for(int i = 0; i < height; i++)
+				memcpy(&bits[pitch * i], &pboBits[pitch * i], rowSize);
+		}
+		else memcpy(bits, pboBits, pitch * height);
 		if(!_glUnmapBuffer(GL_PIXEL_PACK_BUFFER_EXT))
 			THROW("Could not unmap pixel buffer object");
 		_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, 0);
@@ -555,6 +757,100 @@ void VirtualDrawable::readPixels(GLint x, GLint y, GLint width, GLint pitch,
 }
 
 
+// Zero-copy readback:  Replace the pixel buffer of a transport frame with a
+// persistently mapped PBO, so that readPixels() reads back directly into the
+// memory that the transport consumes.  Returns false if persistently mapped
+// PBOs are not available, in which case the frame is unchanged.
+
+bool VirtualDrawable::attachMappedPBO(common::Frame *f)
+{
+	int size = f->pitch * f->hdr.frameh + 1, i;
+
+	for(i = 0; i < nMappedPBOs; i++)
+		if(mappedPBO[i].frame == f) break;
+	if(i < nMappedPBOs && mappedPBO[i].bits == f->bits
+		&& mappedPBO[i].size == size)
+		return true;
+
+	initReadbackContext();
+	TempContext tc(edpy != EGL_NO_DISPLAY ? (Display *)edpy : dpy,
+		getGLXDrawable(), getGLXDrawable(), ctx, edpy != EGL_NO_DISPLAY);
+
+	const char *extensions = (const char *)_glGetString(GL_EXTENSIONS);
+	if(!extensions || !strstr(extensions, "GL_ARB_buffer_storage")
+		|| !strstr(extensions, "GL_ARB_sync"))
+	{
+		if(!alreadyWarnedZeroCopy && fconfig.verbose)
+		{
+			vglout.println("[VGL] NOTICE: Zero-copy readback requires the GL_ARB_buffer_storage and");
+			vglout.println("[VGL]    GL_ARB_sync extensions.  Using normal readback.");
+			alreadyWarnedZeroCopy = true;
+		}
+		return false;
+	}
+
+	// If the frame was reinitialized with a different size, then it no longer
+	// uses its previous PBO.
+	if(i < nMappedPBOs)
+	{
+		_glDeleteBuffers(1, &mappedPBO[i].pbo);
+		mappedPBO[i] = mappedPBO[--nMappedPBOs];
+	}
+	if(nMappedPBOs >= MAXMAPPEDPBOS) return false;
+
+	GLuint newPBO = 0;
+	unsigned char *bits = NULL;
+	GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+		| GL_MAP_COHERENT_BIT;
+
+	TRY_GL();
+	_glGenBuffers(1, &newPBO);
+	if(!newPBO) THROW("Could not generate pixel buffer object");
+	_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, newPBO);
+	_glBufferStorage(GL_PIXEL_PACK_BUFFER_EXT, size, NULL,
+		flags | GL_CLIENT_STORAGE_BIT);
+	bits = (unsigned char *)_glMapBufferRange(GL_PIXEL_PACK_BUFFER_EXT, 0, size,
+		flags);
+	_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, 0);
+	if(!bits)
+	{
+		_glDeleteBuffers(1, &newPBO);
+		THROW("Could not map pixel buffer object");
+	}
+	CATCH_GL("Could not create persistently mapped pixel buffer object");
+
+	mappedPBO[nMappedPBOs].frame = f;
+	mappedPBO[nMappedPBOs].pbo = newPBO;
+	mappedPBO[nMappedPBOs].bits = bits;
+	mappedPBO[nMappedPBOs].size = size;
+	nMappedPBOs++;
+	f->setExternalBits(bits);
+	return true;
+}
+
+
+// Unmap and delete the persistently mapped PBOs.  This must be called before
+// the readback context is destroyed, and derived classes must ensure that the
+// frames using the PBOs no longer reference them.
+
+void VirtualDrawable::releaseMappedPBOs(void)
+{
+	if(ctx && oglDraw && nMappedPBOs)
+	{
+		TempContext tc(edpy != EGL_NO_DISPLAY ? (Display *)edpy : dpy,
+			getGLXDrawable(), getGLXDrawable(), ctx, edpy != EGL_NO_DISPLAY);
+		for(int i = 0; i < nMappedPBOs; i++)
+		{
+			_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, mappedPBO[i].pbo);
+			_glUnmapBuffer(GL_PIXEL_PACK_BUFFER_EXT);
+			_glBindBuffer(GL_PIXEL_PACK_BUFFER_EXT, 0);
+			_glDeleteBuffers(1, &mappedPBO[i].pbo);
+		}
+	}
+	nMappedPBOs = 0;
+}
+
+
 void VirtualDrawable::copyPixels(GLint srcX, GLint srcY, GLint width,
 	GLint height, GLint destX, GLint destY, GLXDrawable draw, GLint readBuf,
 	GLint drawBuf)
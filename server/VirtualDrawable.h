@@ -1,6 +1,6 @@
 // Copyright (C)2004 Landmark Graphics Corporation
 // Copyright (C)2005 Sun Microsystems, Inc.
-// Copyright (C)2009-2015, 2017-2021 D. R. Commander
+// Copyright (C)2009-2015, 2017-2021, 2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -29,7 +29,7 @@ namespace faker
 		public:
 
 			VirtualDrawable(Display *dpy, Drawable x11Draw);
-			~VirtualDrawable(void);
+			virtual ~VirtualDrawable(void);
 			int init(int width, int height, VGLFBConfig config);
 			void setDirect(Bool direct);
 			void clear(void);
@@ -52,7 +52,8 @@ namespace faker
 			{
 				public:
 
-					OGLDrawable(Display *dpy, int width, int height, VGLFBConfig config);
+					OGLDrawable(Display *dpy, int width, int height, VGLFBConfig config,
+						int allocWidth = 0, int allocHeight = 0);
 					OGLDrawable(int width, int height, int depth, VGLFBConfig config,
 						const int *attribs);
 					OGLDrawable(EGLDisplay edpy, int width, int height, EGLConfig config,
@@ -68,6 +69,20 @@ namespace faker
 
 					int getWidth(void) { return width; }
 					int getHeight(void) { return height; }
+
+					// A Pbuffer may be larger than the drawable that it backs, in which
+					// case the drawable occupies the lower left corner of the Pbuffer.
+					bool setSize(int width_, int height_)
+					{
+						if(isPixmap || edpy != EGL_NO_DISPLAY || width_ > allocWidth
+							|| height_ > allocHeight)
+							return false;
+						width = width_;  height = height_;
+						return true;
+					}
+					int getAllocWidth(void) { return allocWidth; }
+					int getAllocHeight(void) { return allocHeight; }
+
 					int getDepth(void) { return depth; }
 					int getRGBSize(void) { return rgbSize; }
 					VGLFBConfig getFBConfig(void) { return config; }
@@ -84,7 +99,7 @@ namespace faker
 					GLXDrawable glxDraw;
 					Display *dpy;
 					EGLDisplay edpy;
-					int width, height, depth, rgbSize;
+					int width, height, allocWidth, allocHeight, depth, rgbSize;
 					VGLFBConfig config;
 					GLenum glFormat;
 					Pixmap pm;
@@ -95,7 +110,10 @@ namespace faker
 			void initReadbackContext(void);
 			bool checkRenderMode(void);
 			void readPixels(GLint x, GLint y, GLint width, GLint pitch, GLint height,
-				GLenum glFormat, PF *pf, GLubyte *bits, GLint readBuf, bool stereo);
+				GLenum glFormat, PF *pf, GLubyte *bits, GLint readBuf, bool stereo,
+				bool pipeline = false);
+			bool attachMappedPBO(common::Frame *f);
+			virtual void releaseMappedPBOs(void);
 
 			util::CriticalSection mutex;
 			Display *dpy;  Drawable x11Draw;
@@ -107,9 +125,34 @@ namespace faker
 			common::Profiler profReadback;
 			int autotestFrameCount;
 
-			GLuint pbo;
+			GLuint pbo[MAXPBOS];
+			int pboDepth, pboHead, pboPrimed;
+			// True if the most recent frame has been read into a PBO but not yet
+			// delivered to the image transport
+			bool pboStale;
+			// If true, then the next pipelined readback delivers the most recent
+			// frame in the PBO ring rather than reading back a new frame.
+			bool pboDrain;
+			// Time of the most recent pipelined readback and the interval between
+			// it and the one before it
+			double pboTime, pboInterval;
+			GLint pboX, pboY, pboWidth, pboPitch, pboHeight, pboReadBuf;
+			GLenum pboFormat;
 			int numSync, numFrames, lastFormat;
 			bool usePBO;
+
+			// Persistently mapped PBOs used for zero-copy readback.  Each one
+			// serves as the pixel buffer of a single transport frame.
+			typedef struct
+			{
+				common::Frame *frame;
+				GLuint pbo;
+				unsigned char *bits;
+				int size;
+			} MappedPBO;
+			static const int MAXMAPPEDPBOS = 8;
+			MappedPBO mappedPBO[MAXMAPPEDPBOS];  int nMappedPBOs;
+			bool alreadyWarnedZeroCopy;
 			bool alreadyPrinted, alreadyWarned, alreadyWarnedRenderMode;
 			const char *ext;
 			unsigned long eventMask;
@@ -1,6 +1,6 @@
 // Copyright (C)2004 Landmark Graphics Corporation
 // Copyright (C)2005, 2006 Sun Microsystems, Inc.
-// Copyright (C)2009-2015, 2017-2021, 2025 D. R. Commander
+// Copyright (C)2009-2015, 2017-2021, 2025-2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -17,8 +17,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include "fakerconfig.h"
+#include "FrameCapture.h"
+#include "FrameTracer.h"
 #include "glxvisual.h"
 #include "vglutil.h"
+#include "WorkerPool.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define USEAVX2
+#endif
 
 using namespace util;
 using namespace common;
@@ -42,6 +49,175 @@ static const int trans2pf[RRTRANS_FORMATOPT] =
 	(mode >= RRSTEREO_INTERLEAVED && mode <= RRSTEREO_SIDEBYSIDE)
 
 
+// Post-processing jobs.  Each of these operates on a band of rows, so that
+// WorkerPool can divide the rows among multiple threads.
+
+// Software gamma correction is a table lookup for each component.  With 8-bit
+// components, the scalar code looks up two components at a time using
+// gamma_lut16, and the AVX2 code uses gathers to look up sixteen components at
+// a time.  Gathers read 32 bits at each index, so they read 16 bits past the
+// end of each gamma table.  Those bits are discarded, and the gamma tables are
+// followed by other members of FakerConfig.
+
+#ifdef USEAVX2
+
+__attribute__((target("avx2")))
+static int gammaRowAVX2(unsigned char *bits, int rowSize)
+{
+	const int *lut = (const int *)fconfig.gamma_lut16;
+	__m256i mask = _mm256_set1_epi32(0xFFFF);
+	int i = 0;
+
+	for(; i <= rowSize - 32; i += 32)
+	{
+		__m256i v0 = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i *)&bits[i])),
+			v1 = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i *)&bits[i + 16]));
+		v0 = _mm256_and_si256(_mm256_i32gather_epi32(lut, v0, 2), mask);
+		v1 = _mm256_and_si256(_mm256_i32gather_epi32(lut, v1, 2), mask);
+		_mm256_storeu_si256((__m256i *)&bits[i],
+			_mm256_permute4x64_epi64(_mm256_packus_epi32(v0, v1), 0xD8));
+	}
+	return i;
+}
+
+
+__attribute__((target("avx2")))
+static int gammaRow10AVX2(unsigned char *bits, int width, PF *pf)
+{
+	const int *lut = (const int *)fconfig.gamma_lut10;
+	__m256i mask = _mm256_set1_epi32(1023);
+	__m128i rshift = _mm_cvtsi32_si128(pf->rshift),
+		gshift = _mm_cvtsi32_si128(pf->gshift),
+		bshift = _mm_cvtsi32_si128(pf->bshift);
+	int i = 0;
+
+	for(; i <= width - 8; i += 8)
+	{
+		__m256i v = _mm256_loadu_si256((__m256i *)&bits[i * 4]);
+		__m256i r = _mm256_i32gather_epi32(lut,
+			_mm256_and_si256(_mm256_srl_epi32(v, rshift), mask), 2);
+		__m256i g = _mm256_i32gather_epi32(lut,
+			_mm256_and_si256(_mm256_srl_epi32(v, gshift), mask), 2);
+		__m256i b = _mm256_i32gather_epi32(lut,
+			_mm256_and_si256(_mm256_srl_epi32(v, bshift), mask), 2);
+		_mm256_storeu_si256((__m256i *)&bits[i * 4], _mm256_or_si256(
+			_mm256_sll_epi32(_mm256_and_si256(r, mask), rshift),
+			_mm256_or_si256(_mm256_sll_epi32(_mm256_and_si256(g, mask), gshift),
+				_mm256_sll_epi32(_mm256_and_si256(b, mask), bshift))));
+	}
+	return i;
+}
+
+#endif
+
+
+class GammaJob : public BandJob
+{
+	public:
+
+		GammaJob(GLint width_, GLint pitch_, PF *pf_, GLubyte *bits_) :
+			width(width_), pitch(pitch_), pf(pf_), bits(bits_)
+		{
+			#ifdef USEAVX2
+			static int hasAVX2 = -1;
+			if(hasAVX2 < 0) hasAVX2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+			useAVX2 = hasAVX2 == 1;
+			#endif
+		}
+
+		void process(int startRow, int endRow)
+		{
+			for(int j = startRow; j < endRow; j++)
+			{
+				if(pf->bpc == 10) gammaRow10(&bits[pitch * j]);
+				else gammaRow(&bits[pitch * j]);
+			}
+		}
+
+	private:
+
+		void gammaRow10(unsigned char *row)
+		{
+			int i = 0;
+			#ifdef USEAVX2
+			if(useAVX2) i = gammaRow10AVX2(row, width, pf);
+			#endif
+			unsigned int *srcPixel = (unsigned int *)row + i;
+			for(; i < width; i++)
+			{
+				unsigned int r = fconfig.gamma_lut10[(*srcPixel >> pf->rshift) & 1023];
+				unsigned int g = fconfig.gamma_lut10[(*srcPixel >> pf->gshift) & 1023];
+				unsigned int b = fconfig.gamma_lut10[(*srcPixel >> pf->bshift) & 1023];
+				*srcPixel++ =
+					(r << pf->rshift) | (g << pf->gshift) | (b << pf->bshift);
+			}
+		}
+
+		void gammaRow(unsigned char *row)
+		{
+			int i = 0, rowSize = width * pf->size;
+			#ifdef USEAVX2
+			if(useAVX2) i = gammaRowAVX2(row, rowSize);
+			#endif
+			for(; i <= rowSize - 2; i += 2)
+			{
+				unsigned short *ptr = (unsigned short *)&row[i];
+				*ptr = fconfig.gamma_lut16[*ptr];
+			}
+			if(i < rowSize) row[i] = fconfig.gamma_lut[row[i]];
+		}
+
+		GLint width, pitch;
+		PF *pf;
+		GLubyte *bits;
+		#ifdef USEAVX2
+		bool useAVX2;
+		#endif
+};
+
+
+class AnaglyphJob : public BandJob
+{
+	public:
+
+		AnaglyphJob(Frame *f_, Frame &r_, Frame &g_, Frame &b_) : f(f_), r(r_),
+			g(g_), b(b_)
+		{
+		}
+
+		void process(int startRow, int endRow)
+		{
+			f->makeAnaglyph(r, g, b, startRow, endRow);
+		}
+
+	private:
+
+		Frame *f, &r, &g, &b;
+};
+
+
+class PassiveJob : public BandJob
+{
+	public:
+
+		PassiveJob(Frame *f_, Frame &stf_, int mode_) : f(f_), stf(stf_),
+			mode(mode_)
+		{
+		}
+
+		void process(int startRow, int endRow)
+		{
+			f->makePassive(stf, mode, startRow, endRow);
+		}
+
+	private:
+
+		Frame *f, &stf;
+		int mode;
+};
+
+
+
 // This class encapsulates the 3D off-screen drawable, its most recent
 // ancestor, and information specific to its corresponding X window
 
@@ -55,6 +231,7 @@ VirtualWin::VirtualWin(Display *dpy_, Window win) :
 	xvtrans = NULL;
 	#endif
 	vglconn = NULL;
+	frameID = 0;
 	profGamma.setName("Gamma     ");
 	profAnaglyph.setName("Anaglyph  ");
 	profPassive.setName("Stereo Gen");
@@ -68,6 +245,7 @@ VirtualWin::VirtualWin(Display *dpy_, Window win) :
 	newConfig = false;
 	swapInterval = 0;
 	alreadyWarnedPluginRenderMode = false;
+	resetDamage(NULL, GL_NONE);
 	XWindowAttributes xwa;
 	if(!XGetWindowAttributes(dpy, win, &xwa) || !xwa.visual)
 		throw(Error(__FUNCTION__, "Invalid window", -1));
@@ -75,7 +253,7 @@ VirtualWin::VirtualWin(Display *dpy_, Window win) :
 	{
 		if(!(eventdpy = _XOpenDisplay(DisplayString(dpy))))
 			THROW("Could not clone X display connection");
-		XSelectInput(eventdpy, win, StructureNotifyMask);
+		XSelectInput(eventdpy, win, StructureNotifyMask | ExposureMask);
 		if(fconfig.verbose)
 			vglout.println("[VGL] Selecting structure notify events in window 0x%.8x",
 				win);
@@ -121,6 +299,19 @@ int VirtualWin::init(int w, int h, VGLFBConfig config_)
 }
 
 
+// The VGL Transport frames may be using persistently mapped PBOs that are about
+// to be destroyed along with the readback context, and those frames may still
+// be queued for transmission, so make the frames copy their pixels into
+// buffers of their own before releasing the PBOs.
+
+void VirtualWin::releaseMappedPBOs(void)
+{
+	CriticalSection::SafeLock l(mutex);
+	if(vglconn) vglconn->detachExternalBits();
+	VirtualDrawable::releaseMappedPBOs();
+}
+
+
 // The resize doesn't actually occur until the next time updatedrawable() is
 // called
 
@@ -196,13 +387,15 @@ void VirtualWin::checkResize(void)
 	if(eventdpy)
 	{
 		XSync(dpy, False);
-		while(XPending(eventdpy) > 0)
+		while(_XPending(eventdpy) > 0)
 		{
 			XEvent event;
 			_XNextEvent(eventdpy, &event);
 			if(event.type == ConfigureNotify && event.xconfigure.window == x11Draw
 				&& event.xconfigure.width > 0 && event.xconfigure.height > 0)
 				resize(event.xconfigure.width, event.xconfigure.height);
+			else if(event.type == Expose && event.xexpose.window == x11Draw)
+				expose();
 		}
 	}
 }
@@ -268,7 +461,57 @@ void VirtualWin::enableWMDeleteHandler(void)
 }
 
 
-void VirtualWin::readback(GLint drawBuf, bool spoilLast, bool sync)
+// Pipelined readback delivers each frame only after the application has
+// rendered VGL_PBOBUFS - 1 more frames, so once the application stops
+// rendering, the most recent frames are still in flight.  In that case, deliver
+// the most recent frame from the PBO ring, which the GPU has finished
+// transferring by now, without reading back a new frame.  If ifIdle is true,
+// then this is done only if the application has not swapped buffers for at
+// least twice its recent frame interval (and at least DRAIN_IDLE_TIME
+// seconds), so that applications that poll for events once per frame do not
+// defeat pipelining.
+
+#define DRAIN_IDLE_TIME  0.1
+
+void VirtualWin::drainReadback(bool ifIdle)
+{
+	CriticalSection::SafeLock l(mutex);
+	if(!pboStale || deletedByWM) return;
+	if(ifIdle
+		&& GetTime() - pboTime < max(DRAIN_IDLE_TIME, pboInterval * 2.))
+		return;
+	pboDrain = true;
+	try
+	{
+		readback(GL_BACK, false, false, true);
+	}
+	catch(...)
+	{
+		pboDrain = false;
+		throw;
+	}
+	pboDrain = false;
+}
+
+
+// Part of the window has been exposed, so the X11 Transport can no longer
+// assume that the window contains the last frame that it drew.
+
+void VirtualWin::expose(void)
+{
+	CriticalSection::SafeLock l(mutex);
+	if(x11trans) x11trans->invalidate();
+}
+
+
+// If pipeline is true, then the frame can be read back using pipelined
+// (multi-PBO) readback, which delivers a frame that was rendered earlier.  This
+// is only appropriate when the frame is being read back in response to a
+// buffer swap, so the caller must ensure that drainReadback() is called once
+// the application stops swapping buffers.
+
+void VirtualWin::readback(GLint drawBuf, bool spoilLast, bool sync,
+	bool pipeline)
 {
 	fconfig_reloadenv();
 	bool doStereo = false;  int stereoMode = fconfig.stereo;
@@ -283,6 +526,9 @@ void VirtualWin::readback(GLint drawBuf, bool spoilLast, bool sync)
 
 	int compress = fconfig.compress;
 	if(sync && strlen(fconfig.transport) == 0) compress = RRCOMP_PROXY;
+	// With VGL_SYNC, the 2D X server must contain the current frame by the time
+	// the application regains control.
+	if(sync) pipeline = false;
 
 	if(isStereo() && stereoMode != RRSTEREO_LEYE && stereoMode != RRSTEREO_REYE)
 	{
@@ -325,21 +571,26 @@ void VirtualWin::readback(GLint drawBuf, bool spoilLast, bool sync)
 		}
 	}
 
+	// Damage tracking is only used with the VGL Transport.
+	if(strlen(fconfig.transport) > 0 || _Trans[compress] != RRTRANS_VGL)
+		resetDamage(NULL, GL_NONE);
+
 	if(strlen(fconfig.transport) > 0)
 	{
-		sendPlugin(drawBuf, spoilLast, sync, doStereo, stereoMode);
+		sendPlugin(drawBuf, spoilLast, sync, doStereo, stereoMode, pipeline);
 		return;
 	}
 
 	switch(compress)
 	{
 		case RRCOMP_PROXY:
-			sendX11(drawBuf, spoilLast, sync, doStereo, stereoMode);
+			sendX11(drawBuf, spoilLast, sync, doStereo, stereoMode, pipeline);
 			break;
 
 		case RRCOMP_JPEG:
 		case RRCOMP_RGB:
 		case RRCOMP_YUV:
+		case RRCOMP_LOSSLESS:
 			if(!vglconn)
 			{
 				vglconn = new VGLTrans();
@@ -348,7 +599,7 @@ void VirtualWin::readback(GLint drawBuf, bool spoilLast, bool sync)
 					fconfig.port);
 			}
 			sendVGL(drawBuf, spoilLast, doStereo, stereoMode, compress, fconfig.qual,
-				fconfig.subsamp);
+				fconfig.subsamp, pipeline);
 			break;
 		#ifdef USEXV
 		case RRCOMP_XV:
@@ -390,7 +641,7 @@ TempContext *VirtualWin::setupPluginTempContext(GLint drawBuf)
 
 
 void VirtualWin::sendPlugin(GLint drawBuf, bool spoilLast, bool sync,
-	bool doStereo, int stereoMode)
+	bool doStereo, int stereoMode, bool pipeline)
 {
 	Frame f;
 	int w = oglDraw->getWidth(), h = oglDraw->getHeight();
@@ -458,7 +709,7 @@ void VirtualWin::sendPlugin(GLint drawBuf, bool spoilLast, bool sync,
 				if(doStereo || stereoMode == RRSTEREO_LEYE) readBuf = LEYE(drawBuf);
 				if(stereoMode == RRSTEREO_REYE) readBuf = REYE(drawBuf);
 				readPixels(0, 0, rrframe->w, rrframe->pitch, rrframe->h, GL_NONE, f.pf,
-					rrframe->bits, readBuf, doStereo);
+					rrframe->bits, readBuf, doStereo, pipeline);
 				if(doStereo && rrframe->rbits)
 					readPixels(0, 0, rrframe->w, rrframe->pitch, rrframe->h, GL_NONE,
 						f.pf, rrframe->rbits, REYE(drawBuf), doStereo);
@@ -478,7 +729,7 @@ void VirtualWin::sendPlugin(GLint drawBuf, bool spoilLast, bool sync,
 
 
 void VirtualWin::sendVGL(GLint drawBuf, bool spoilLast, bool doStereo,
-	int stereoMode, int compress, int qual, int subsamp)
+	int stereoMode, int compress, int qual, int subsamp, bool pipeline)
 {
 	int w = oglDraw->getWidth(), h = oglDraw->getHeight();
 
@@ -500,15 +751,18 @@ void VirtualWin::sendVGL(GLint drawBuf, bool spoilLast, bool doStereo,
 	if(!fconfig.spoil) vglconn->synchronize();
 	ERRIFNOT(f = vglconn->getFrame(w, h, pixelFormat, FRAME_BOTTOMUP,
 		doStereo && stereoMode == RRSTEREO_QUADBUF));
+	double traceStart = FrameTracer::start();
 	if(doStereo && IS_ANAGLYPHIC(stereoMode))
 	{
 		stereoFrame.deInit();
 		makeAnaglyph(f, drawBuf, stereoMode);
+		resetDamage(NULL, GL_NONE);
 	}
 	else if(doStereo && IS_PASSIVE(stereoMode))
 	{
 		rFrame.deInit();  gFrame.deInit();  bFrame.deInit();
 		makePassive(f, drawBuf, glFormat, stereoMode);
+		resetDamage(NULL, GL_NONE);
 	}
 	else
 	{
@@ -516,11 +770,22 @@ void VirtualWin::sendVGL(GLint drawBuf, bool spoilLast, bool doStereo,
 		GLint readBuf = drawBuf;
 		if(doStereo || stereoMode == RRSTEREO_LEYE) readBuf = LEYE(drawBuf);
 		if(stereoMode == RRSTEREO_REYE) readBuf = REYE(drawBuf);
-		readPixels(0, 0, f->hdr.framew, f->pitch, f->hdr.frameh, glFormat, f->pf,
-			f->bits, readBuf, doStereo);
-		if(doStereo && f->rbits)
-			readPixels(0, 0, f->hdr.framew, f->pitch, f->hdr.frameh, glFormat, f->pf,
-				f->rbits, REYE(drawBuf), doStereo);
+		if(fconfig.zerocopy && !doStereo && fconfig.pbobufs <= 1)
+			attachMappedPBO(f);
+		if(doStereo || !readDamage(f, glFormat, readBuf))
+		{
+			readPixels(0, 0, f->hdr.framew, f->pitch, f->hdr.frameh, glFormat,
+				f->pf, f->bits, readBuf, doStereo, pipeline);
+			if(doStereo && f->rbits)
+				readPixels(0, 0, f->hdr.framew, f->pitch, f->hdr.frameh, glFormat,
+					f->pf, f->rbits, REYE(drawBuf), doStereo);
+		}
+		// The logo is drawn on top of the frame, so a frame with a logo cannot be
+		// used as the basis for the next frame.  Pipelined readback returns an
+		// earlier frame, so the frame doesn't reflect the current damage.
+		if(fconfig.damage && !doStereo && !fconfig.logo && fconfig.pbobufs <= 1)
+			resetDamage(f, readBuf);
+		else resetDamage(NULL, GL_NONE);
 	}
 	f->hdr.winid = x11Draw;
 	f->hdr.framew = f->hdr.width;
@@ -530,14 +795,113 @@ void VirtualWin::sendVGL(GLint drawBuf, bool spoilLast, bool doStereo,
 	f->hdr.qual = qual;
 	f->hdr.subsamp = subsamp;
 	f->hdr.compress = (unsigned char)compress;
+	f->hdr.frameid = ++frameID;
 	if(!syncdpy) { XSync(dpy, False);  syncdpy = true; }
+	if(strlen(fconfig.capture) > 0) FRAMECAPTURE.write(f, x11Draw);
 	if(fconfig.logo) f->addLogo();
+	FrameTracer::end("Readback", f->hdr.winid, f->hdr.frameid,
+		traceStart, FrameTracer::FLOWSTART);
 	vglconn->sendFrame(f);
 }
 
 
+// Damage tracking
+
+void VirtualWin::addDamage(int x, int y, int width, int height)
+{
+	if(width < 1 || height < 1) return;
+
+	CriticalSection::SafeLock l(mutex);
+
+	if(damageX1 <= damageX0 || damageY1 <= damageY0)
+	{
+		damageX0 = x;  damageY0 = y;
+		damageX1 = x + width;  damageY1 = y + height;
+	}
+	else
+	{
+		damageX0 = min(damageX0, x);  damageY0 = min(damageY0, y);
+		damageX1 = max(damageX1, x + width);
+		damageY1 = max(damageY1, y + height);
+	}
+}
+
+
+void VirtualWin::addDamage(void)
+{
+	CriticalSection::SafeLock l(mutex);
+
+	damageAll = true;
+}
+
+
+// Start tracking damage relative to the specified frame, which has just been
+// read back from the specified buffer.  If base is NULL, then the next frame
+// will be read back in its entirety.
+void VirtualWin::resetDamage(Frame *base, GLint readBuf)
+{
+	damageX0 = damageY0 = damageX1 = damageY1 = 0;  damageAll = false;
+	damageBase = base;  damageReadBuf = readBuf;
+	if(base)
+	{
+		damageWidth = base->hdr.framew;  damageHeight = base->hdr.frameh;
+		damagePF = base->pf->id;
+	}
+	else damageWidth = damageHeight = damagePF = -1;
+	damageGamma = fconfig.gamma;
+}
+
+
+// Read back only the damaged region of the off-screen drawable, and copy the
+// rest of the frame from the previous frame, which is known to contain the
+// same pixels.  Returns false if the whole frame must be read back.
+bool VirtualWin::readDamage(Frame *f, GLenum glFormat, GLint readBuf)
+{
+	int width = f->hdr.framew, height = f->hdr.frameh, ps = f->pf->size;
+
+	// The drawing functions do not track damage for EGL/X11 windows.
+	if(!fconfig.damage || edpy != EGL_NO_DISPLAY || !damageBase || damageAll
+		|| fconfig.logo || fconfig.pbobufs > 1 || readBuf != damageReadBuf
+		|| width != damageWidth || height != damageHeight
+		|| f->pf->id != damagePF || f->pitch != damageBase->pitch
+		|| fconfig.gamma != damageGamma)
+		return false;
+
+	int x0 = max(damageX0, 0), y0 = max(damageY0, 0);
+	int x1 = min(damageX1, width), y1 = min(damageY1, height);
+	if(x1 <= x0 || y1 <= y0) x0 = y0 = x1 = y1 = 0;
+
+	// If the previous frame was spoiled, then the VGL Transport may have handed
+	// us the same buffer, in which case it already contains the undamaged
+	// pixels.  Both the frame and the off-screen drawable are bottom-up, so
+	// row y of the frame corresponds to row y of the drawable.
+	if(f != damageBase)
+	{
+		unsigned char *src = damageBase->bits, *dst = f->bits;
+		for(int y = 0; y < height; y++, src += f->pitch, dst += f->pitch)
+		{
+			if(y < y0 || y >= y1) memcpy(dst, src, width * ps);
+			else
+			{
+				if(x0 > 0) memcpy(dst, src, x0 * ps);
+				if(x1 < width)
+					memcpy(&dst[x1 * ps], &src[x1 * ps], (width - x1) * ps);
+			}
+		}
+	}
+	if(x1 > x0)
+		readPixels(x0, y0, x1 - x0, f->pitch, y1 - y0, glFormat, f->pf,
+			&f->bits[f->pitch * y0 + ps * x0], readBuf, false);
+
+	f->damageBase = damageBase;
+	f->damageX = x0;  f->damageY = height - y1;
+	f->damageWidth = x1 - x0;  f->damageHeight = y1 - y0;
+	return true;
+}
+
+
 void VirtualWin::sendX11(GLint drawBuf, bool spoilLast, bool sync,
-	bool doStereo, int stereoMode)
+	bool doStereo, int stereoMode, bool pipeline)
 {
 	int width = oglDraw->getWidth(), height = oglDraw->getHeight();
 
@@ -564,9 +928,11 @@ void VirtualWin::sendX11(GLint drawBuf, bool spoilLast, bool sync,
 			if(stereoMode == RRSTEREO_REYE) readBuf = REYE(drawBuf);
 			else if(stereoMode == RRSTEREO_LEYE) readBuf = LEYE(drawBuf);
 			readPixels(0, 0, min(width, f->hdr.framew), f->pitch,
-				min(height, f->hdr.frameh), GL_NONE, f->pf, f->bits, readBuf, false);
+				min(height, f->hdr.frameh), GL_NONE, f->pf, f->bits, readBuf, false,
+				pipeline);
 		}
 	}
+	if(strlen(fconfig.capture) > 0) FRAMECAPTURE.write(f, x11Draw);
 	if(fconfig.logo) f->addLogo();
 	x11trans->sendFrame(f, sync);
 }
@@ -649,7 +1015,8 @@ void VirtualWin::makeAnaglyph(Frame *f, int drawBuf, int stereoMode)
 	readPixels(0, 0, bFrame.hdr.framew, bFrame.pitch, bFrame.hdr.frameh, GL_BLUE,
 		bFrame.pf, bFrame.bits, bbuf, false);
 	profAnaglyph.startFrame();
-	f->makeAnaglyph(rFrame, gFrame, bFrame);
+	AnaglyphJob job(f, rFrame, gFrame, bFrame);
+	WORKERPOOL.run(job, f->hdr.frameh, fconfig.np);
 	profAnaglyph.endFrame(f->hdr.framew * f->hdr.frameh, 0, 1);
 }
 
@@ -665,16 +1032,18 @@ void VirtualWin::makePassive(Frame *f, int drawBuf, GLenum glFormat,
 		stereoFrame.hdr.frameh, glFormat, stereoFrame.pf, stereoFrame.rbits,
 		REYE(drawBuf), true);
 	profPassive.startFrame();
-	f->makePassive(stereoFrame, stereoMode);
+	PassiveJob job(f, stereoFrame, stereoMode);
+	WORKERPOOL.run(job, f->hdr.frameh, fconfig.np);
 	profPassive.endFrame(f->hdr.framew * f->hdr.frameh, 0, 1);
 }
 
 
 void VirtualWin::readPixels(GLint x, GLint y, GLint width, GLint pitch,
-	GLint height, GLenum glFormat, PF *pf, GLubyte *bits, GLint buf, bool stereo)
+	GLint height, GLenum glFormat, PF *pf, GLubyte *bits, GLint buf, bool stereo,
+	bool pipeline)
 {
 	VirtualDrawable::readPixels(x, y, width, pitch, height, glFormat, pf, bits,
-		buf, stereo);
+		buf, stereo, pipeline);
 
 	// Gamma correction
 	if(fconfig.gamma != 0.0 && fconfig.gamma != 1.0 && fconfig.gamma != -1.0)
@@ -688,35 +1057,8 @@ void VirtualWin::readPixels(GLint x, GLint y, GLint width, GLint pitch,
 				vglout.println("[VGL] Using software gamma correction (correction factor=%f)\n",
 					fconfig.gamma);
 		}
-		if(pf->bpc == 10)
-		{
-			int h = height;
-			while(h--)
-			{
-				int w = width;
-				unsigned int *srcPixel = (unsigned int *)bits;
-				while(w--)
-				{
-					unsigned int r =
-						fconfig.gamma_lut10[(*srcPixel >> pf->rshift) & 1023];
-					unsigned int g =
-						fconfig.gamma_lut10[(*srcPixel >> pf->gshift) & 1023];
-					unsigned int b =
-						fconfig.gamma_lut10[(*srcPixel >> pf->bshift) & 1023];
-					*srcPixel++ =
-						(r << pf->rshift) | (g << pf->gshift) | (b << pf->bshift);
-				}
-				bits += pitch;
-			}
-		}
-		else
-		{
-			unsigned short *ptr1, *ptr2 = (unsigned short *)(&bits[pitch * height]);
-			for(ptr1 = (unsigned short *)bits; ptr1 < ptr2; ptr1++)
-				*ptr1 = fconfig.gamma_lut16[*ptr1];
-			if((pitch * height) % 2 != 0)
-				bits[pitch * height - 1] = fconfig.gamma_lut[bits[pitch * height - 1]];
-		}
+		GammaJob job(width, pitch, pf, bits);
+		WORKERPOOL.run(job, height, fconfig.np);
 		profGamma.endFrame(width * height, 0, stereo ? 0.5 : 1);
 	}
 }
@@ -40,13 +40,19 @@ namespace faker
 			void resize(int width, int height);
 			void checkResize(void);
 			void initFromWindow(VGLFBConfig config);
-			void readback(GLint drawBuf, bool spoilLast, bool sync);
+			void readback(GLint drawBuf, bool spoilLast, bool sync,
+				bool pipeline = false);
+			void drainReadback(bool ifIdle);
+			bool hasStaleReadback(void) { return pboStale; }
 			void swapBuffers(void);
 			bool isStereo(void);
 			void wmDeleted(void);
 			void enableWMDeleteHandler(void);
+			void expose(void);
 			int getSwapInterval(void) { return swapInterval; }
 			void setSwapInterval(int swapInterval_) { swapInterval = swapInterval_; }
+			void addDamage(int x, int y, int width, int height);
+			void addDamage(void);
 
 			bool dirty, rdirty;
 
@@ -54,16 +60,20 @@ namespace faker
 
 			int init(int w, int h, VGLFBConfig config);
 			void readPixels(GLint x, GLint y, GLint width, GLint pitch, GLint height,
-				GLenum glFormat, PF *pf, GLubyte *bits, GLint buf, bool stereo);
+				GLenum glFormat, PF *pf, GLubyte *bits, GLint buf, bool stereo,
+				bool pipeline = false);
 			void makeAnaglyph(common::Frame *f, int drawBuf, int stereoMode);
 			void makePassive(common::Frame *f, int drawBuf, GLenum glFormat,
 				int stereoMode);
 			void sendVGL(GLint drawBuf, bool spoilLast, bool doStereo,
-				int stereoMode, int compress, int qual, int subsamp);
+				int stereoMode, int compress, int qual, int subsamp, bool pipeline);
+			bool readDamage(common::Frame *f, GLenum glFormat, GLint readBuf);
+			void releaseMappedPBOs(void);
+			void resetDamage(common::Frame *base, GLint readBuf);
 			void sendX11(GLint drawBuf, bool spoilLast, bool sync, bool doStereo,
-				int stereoMode);
+				int stereoMode, bool pipeline);
 			void sendPlugin(GLint drawBuf, bool spoilLast, bool sync, bool doStereo,
-				int stereoMode);
+				int stereoMode, bool pipeline);
 			#ifdef USEXV
 			void sendXV(GLint drawBuf, bool spoilLast, bool sync, bool doStereo,
 				int stereoMode);
@@ -78,6 +88,7 @@ namespace faker
 			server::XVTrans *xvtrans;
 			#endif
 			server::VGLTrans *vglconn;
+			unsigned int frameID;
 			common::Profiler profGamma, profAnaglyph, profPassive;
 			bool syncdpy;
 			server::TransPlugin *plugin;
@@ -88,6 +99,13 @@ namespace faker
 			bool newConfig;
 			int swapInterval;
 			bool alreadyWarnedPluginRenderMode;
+
+			// Region of the off-screen drawable (in OpenGL window coordinates) that
+			// may have been rendered to since damageBase was read back
+			int damageX0, damageY0, damageX1, damageY1;  bool damageAll;
+			common::Frame *damageBase;
+			int damageWidth, damageHeight, damagePF;  GLint damageReadBuf;
+			double damageGamma;
 	};
 }
 
@@ -75,6 +75,11 @@ namespace faker
 					&& (!key1 || !strcasecmp(key1, entry->key1));
 			}
 
+			size_t hashKey(char *key1, XVisualInfo *key2)
+			{
+				return mix((size_t)key2);
+			}
+
 			void detach(HashEntry *entry)
 			{
 				if(entry) free(entry->key1);
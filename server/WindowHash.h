@@ -86,6 +86,25 @@ namespace faker
 				HASH::remove(DisplayString(dpy), glxd);
 			}
 
+			// Draining may send a frame, which can block, so the hash mutex is not
+			// held while draining.
+			void drainReadback(Display *dpy, bool ifIdle)
+			{
+				VirtualWin *vws[MAXDRAIN];  int nvws = 0;
+				if(!dpy) return;
+				{
+					util::CriticalSection::SafeLock l(mutex);
+					for(HashEntry *ptr = start; ptr != NULL && nvws < MAXDRAIN;
+						ptr = ptr->next)
+					{
+						VirtualWin *vw = ptr->value;
+						if(vw && dpy == vw->getX11Display() && vw->hasStaleReadback())
+							vws[nvws++] = vw;
+					}
+				}
+				for(int i = 0; i < nvws; i++) vws[i]->drainReadback(ifIdle);
+			}
+
 			void remove(Display *dpy)
 			{
 				if(!dpy) return;
@@ -104,6 +123,9 @@ namespace faker
 
 		private:
 
+			// Maximum number of windows drained per call
+			static const int MAXDRAIN = 64;
+
 			~WindowHash(void)
 			{
 				WindowHash::kill();
@@ -114,6 +136,7 @@ namespace faker
 				if(entry)
 				{
 					free(entry->key1);
+					if(entry->value) faker::windowEpoch++;
 					delete entry->value;
 				}
 			}
@@ -136,6 +159,18 @@ namespace faker
 				);
 			}
 
+			size_t hashKey(char *key1, Window key2)
+			{
+				return mix((size_t)key2);
+			}
+
+			// The off-screen drawable ID changes whenever the VirtualWin instance is
+			// resized, so it cannot be indexed.
+			bool needScan(char *key1, Window key2)
+			{
+				return key1 == NULL;
+			}
+
 			static WindowHash *instance;
 			static util::CriticalSection instanceMutex;
 	};
@@ -0,0 +1,121 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+#include "WorkerPool.h"
+#include "vglutil.h"
+
+using namespace util;
+using namespace server;
+
+
+WorkerPool *WorkerPool::instance = NULL;
+CriticalSection WorkerPool::instanceMutex;
+
+
+void WorkerPool::Worker::run(void)
+{
+	while(true)
+	{
+		ready.wait();  if(deadYet) break;
+		try
+		{
+			job->process(startRow, endRow);
+		}
+		catch(std::exception &e)
+		{
+			jobError = new Error(GET_METHOD(e), e.what());
+		}
+		complete.signal();
+	}
+}
+
+
+void WorkerPool::run(BandJob &job, int height, int nThreads)
+{
+	int nBands = min(min(nThreads, MAXPROCS), height / MINBANDROWS);
+	Worker *claimed[MAXPROCS];  int nClaimed = 0;
+
+	// The mutex is held only while claiming workers, so jobs from different
+	// windows can run concurrently.
+	if(nBands > 1)
+	{
+		CriticalSection::SafeLock l(mutex);
+
+		for(int i = 0; i < nWorkers && nClaimed < nBands - 1; i++)
+		{
+			if(!workers[i]->busy)
+			{
+				workers[i]->busy = true;
+				claimed[nClaimed++] = workers[i];
+			}
+		}
+		while(nClaimed < nBands - 1 && nWorkers < maxWorkers)
+		{
+			Worker *worker = new Worker;
+			worker->start();
+			worker->busy = true;
+			workers[nWorkers++] = claimed[nClaimed++] = worker;
+		}
+	}
+	nBands = nClaimed + 1;
+
+	if(nBands <= 1)
+	{
+		job.process(0, height);
+		return;
+	}
+
+	for(int i = 1; i < nBands; i++)
+		claimed[i - 1]->go(&job, height * i / nBands, height * (i + 1) / nBands);
+
+	Error *error = NULL;
+	try
+	{
+		job.process(0, height / nBands);
+	}
+	catch(std::exception &e)
+	{
+		error = new Error(GET_METHOD(e), e.what());
+	}
+	// All of the workers must finish before the job goes out of scope, even if
+	// one of them failed.
+	for(int i = 1; i < nBands; i++)
+	{
+		Error *workerError = claimed[i - 1]->wait();
+		if(!error) error = workerError;
+		else delete workerError;
+	}
+
+	{
+		CriticalSection::SafeLock l(mutex);
+		for(int i = 1; i < nBands; i++) claimed[i - 1]->busy = false;
+	}
+
+	if(error)
+	{
+		Error e = *error;
+		delete error;
+		throw e;
+	}
+}
+
+
+void WorkerPool::kill(void)
+{
+	CriticalSection::SafeLock l(mutex);
+
+	for(int i = 0; i < nWorkers; i++)
+	{
+		delete workers[i];  workers[i] = NULL;
+	}
+	nWorkers = 0;
+}
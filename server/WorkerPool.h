@@ -0,0 +1,134 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+#ifndef __WORKERPOOL_H__
+#define __WORKERPOOL_H__
+
+#include "Thread.h"
+#include "Mutex.h"
+#include "rr.h"
+#include "vglutil.h"
+
+
+namespace server
+{
+	// An operation that can be performed independently on each horizontal band
+	// of a frame
+	class BandJob
+	{
+		public:
+
+			virtual ~BandJob(void) {}
+			virtual void process(int startRow, int endRow) = 0;
+	};
+
+
+	// A process-wide pool of worker threads that is used to post-process
+	// rendered frames (gamma correction, anaglyph generation, and passive stereo
+	// generation) in parallel.  The calling thread processes the first band
+	// itself.  The pool is shared by all windows, so each job claims idle
+	// workers for its duration.  The pool never has more workers than there are
+	// CPU cores, so a job that finds no idle workers processes fewer bands.
+
+	class WorkerPool
+	{
+		public:
+
+			static WorkerPool *getInstance(void)
+			{
+				if(instance == NULL)
+				{
+					util::CriticalSection::SafeLock l(instanceMutex);
+					if(instance == NULL) instance = new WorkerPool;
+				}
+				return instance;
+			}
+
+			static bool isAlloc(void) { return instance != NULL; }
+
+			// Divide rows [0, height) into at most nThreads bands and process them
+			// concurrently.  This returns once all bands have been processed.
+			void run(BandJob &job, int height, int nThreads);
+			void kill(void);
+
+		private:
+
+			// Bands smaller than this aren't worth the synchronization overhead.
+			static const int MINBANDROWS = 32;
+
+			class Worker : public util::Runnable
+			{
+				public:
+
+					Worker(void) : busy(false), job(NULL), startRow(0), endRow(0),
+						jobError(NULL), deadYet(false), thread(NULL)
+					{
+						ready.wait();  complete.wait();
+					}
+
+					virtual ~Worker(void)
+					{
+						deadYet = true;  ready.signal();
+						if(thread) { thread->stop();  delete thread;  thread = NULL; }
+						delete jobError;
+					}
+
+					void start(void)
+					{
+						thread = new util::Thread(this);
+						thread->start();
+					}
+
+					void go(BandJob *job_, int startRow_, int endRow_)
+					{
+						job = job_;  startRow = startRow_;  endRow = endRow_;
+						ready.signal();
+					}
+
+					// Returns NULL if the band was processed successfully, or an error
+					// (which the caller must delete) if it failed.
+					util::Error *wait(void)
+					{
+						complete.wait();
+						util::Error *error = jobError;
+						jobError = NULL;
+						return error;
+					}
+
+					bool busy;
+
+				private:
+
+					void run(void);
+
+					BandJob *job;
+					int startRow, endRow;
+					util::Error *jobError;
+					util::Event ready, complete;  bool deadYet;
+					util::Thread *thread;
+			};
+
+			WorkerPool(void) : nWorkers(0), maxWorkers(min(NumProcs(), MAXPROCS))
+			{}
+			~WorkerPool(void) { kill(); }
+
+			Worker *workers[MAXPROCS];  int nWorkers, maxWorkers;
+			util::CriticalSection mutex;
+			static WorkerPool *instance;
+			static util::CriticalSection instanceMutex;
+	};
+}
+
+
+#define WORKERPOOL  (*(server::WorkerPool::getInstance()))
+
+#endif  // __WORKERPOOL_H__
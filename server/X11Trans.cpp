@@ -29,7 +29,8 @@ using namespace common;
 using namespace server;
 
 
-X11Trans::X11Trans(void) : thread(NULL), deadYet(false)
+X11Trans::X11Trans(void) : thread(NULL), deadYet(false),
+	lastFrameValid(false)
 {
 	if(fconfig.sync) nFrames = 1;
 	else nFrames = 3;
@@ -64,7 +65,7 @@ void X11Trans::run(void)
 			if(!f) THROW("Queue has been shut down");
 			ready.signal();
 			profBlit.startFrame();
-			f->redraw();
+			redraw(f);
 			profBlit.endFrame(f->hdr.width * f->hdr.height, 0, 1);
 
 			profTotal.endFrame(f->hdr.width * f->hdr.height, 0, 1);
@@ -137,6 +138,37 @@ FBXFrame *X11Trans::getFrame(Display *dpy, Window win, int width, int height)
 }
 
 
+// If X11 interframe comparison (VGL_X11INTERFRAME) is enabled, then only the
+// tiles that differ from the last frame drawn are sent to the X server.
+
+void X11Trans::redraw(FBXFrame *f)
+{
+	bool drawAll;
+
+	{
+		CriticalSection::SafeLock l(mutex);
+		drawAll = !lastFrameValid;
+		lastFrameValid = (fconfig.x11interframe != 0);
+	}
+	if(fconfig.x11interframe)
+	{
+		if(drawAll) lastFrame.deInit();
+		f->redraw(lastFrame, fconfig.tilesize);
+	}
+	else f->redraw();
+}
+
+
+// The window contents have been lost (for instance, because part of the window
+// was exposed), so the next frame must be drawn in its entirety.
+
+void X11Trans::invalidate(void)
+{
+	CriticalSection::SafeLock l(mutex);
+	lastFrameValid = false;
+}
+
+
 bool X11Trans::isReady(void)
 {
 	if(thread) thread->checkError();
@@ -162,7 +194,7 @@ void X11Trans::sendFrame(FBXFrame *f, bool sync)
 	if(sync)
 	{
 		profBlit.startFrame();
-		f->redraw();
+		redraw(f);
 		f->signalComplete();
 		profBlit.endFrame(f->hdr.width * f->hdr.height, 0, 1);
 		ready.signal();
@@ -17,7 +17,7 @@
 
 #include "Thread.h"
 #include "Frame.h"
-#include "GenericQ.h"
+#include "RingQ.h"
 #include "Profiler.h"
 
 
@@ -46,17 +46,24 @@ namespace server
 			void run(void);
 			common::FBXFrame *getFrame(Display *dpy, Window win, int width,
 				int height);
+			void invalidate(void);
 
 		private:
 
+			void redraw(common::FBXFrame *f);
+
 			int nFrames;
 			util::CriticalSection mutex;
 			common::FBXFrame *frames[3];
 			util::Event ready;
-			util::GenericQ q;
+			util::RingQ q;
 			util::Thread *thread;
 			bool deadYet;
 			common::Profiler profBlit, profTotal;
+			// Copy of the pixels that are currently displayed in the window, which
+			// is used to draw only the tiles that have changed
+			common::Frame lastFrame;
+			bool lastFrameValid;
 	};
 }
 
@@ -113,6 +113,11 @@ namespace faker
 				return key1 == entry->key1;
 			}
 
+			size_t hashKey(xcb_connection_t *key1, void *key2)
+			{
+				return mix((size_t)key1);
+			}
+
 			void detach(HashEntry *entry)
 			{
 				XCBConnAttribs *attribs = entry ? entry->value : NULL;
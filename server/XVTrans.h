@@ -17,7 +17,7 @@
 
 #include "Thread.h"
 #include "Frame.h"
-#include "GenericQ.h"
+#include "RingQ.h"
 #include "Profiler.h"
 
 
@@ -52,7 +52,7 @@ namespace server
 			util::CriticalSection mutex;
 			common::XVFrame *frames[NFRAMES];
 			util::Event ready;
-			util::GenericQ q;
+			util::RingQ q;
 			util::Thread *thread;
 			bool deadYet;
 			common::Profiler profXV, profTotal;
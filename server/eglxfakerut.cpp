@@ -1320,16 +1320,64 @@ int procAddrTest(void)
 		TEST_PROC_SYM_OPT(eglWaitSyncKHR);
 
 		// OpenGL
+		TEST_PROC_SYM(glAccum)
+		TEST_PROC_SYM(glBegin)
 		TEST_PROC_SYM(glBindFramebuffer)
 		TEST_PROC_SYM(glBindFramebufferEXT)
+		TEST_PROC_SYM(glBitmap)
+		TEST_PROC_SYM(glBlitFramebuffer)
+		TEST_PROC_SYM_OPT(glBlitFramebufferEXT)
+		TEST_PROC_SYM_OPT(glBlitNamedFramebuffer)
+		TEST_PROC_SYM(glCallList)
+		TEST_PROC_SYM(glCallLists)
+		TEST_PROC_SYM(glClear)
+		TEST_PROC_SYM_OPT(glClearBufferfv)
+		TEST_PROC_SYM_OPT(glClearBufferiv)
+		TEST_PROC_SYM_OPT(glClearBufferuiv)
+		TEST_PROC_SYM_OPT(glClearNamedFramebufferfv)
+		TEST_PROC_SYM_OPT(glClearNamedFramebufferiv)
+		TEST_PROC_SYM_OPT(glClearNamedFramebufferuiv)
+		TEST_PROC_SYM(glCopyPixels)
 		TEST_PROC_SYM(glDeleteFramebuffers)
 		TEST_PROC_SYM(glDeleteFramebuffersEXT)
+		TEST_PROC_SYM(glDisable)
+		TEST_PROC_SYM_OPT(glDisablei)
+		TEST_PROC_SYM_OPT(glDrawArraysEXT)
+		TEST_PROC_SYM_OPT(glDrawArraysIndirect)
+		TEST_PROC_SYM_OPT(glDrawArraysInstanced)
+		TEST_PROC_SYM_OPT(glDrawArraysInstancedARB)
+		TEST_PROC_SYM_OPT(glDrawArraysInstancedBaseInstance)
+		TEST_PROC_SYM_OPT(glDrawArraysInstancedEXT)
+		TEST_PROC_SYM_OPT(glDrawElementsBaseVertex)
+		TEST_PROC_SYM_OPT(glDrawElementsIndirect)
+		TEST_PROC_SYM_OPT(glDrawElementsInstanced)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedARB)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedBaseInstance)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedBaseVertex)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedBaseVertexBaseInstance)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedEXT)
+		TEST_PROC_SYM_OPT(glDrawRangeElementsBaseVertex)
+		TEST_PROC_SYM_OPT(glDrawRangeElementsEXT)
+		TEST_PROC_SYM_OPT(glDrawTransformFeedback)
+		TEST_PROC_SYM_OPT(glDrawTransformFeedbackInstanced)
+		TEST_PROC_SYM_OPT(glDrawTransformFeedbackStream)
+		TEST_PROC_SYM_OPT(glDrawTransformFeedbackStreamInstanced)
+		TEST_PROC_SYM(glEnable)
+		TEST_PROC_SYM_OPT(glEnablei)
+		TEST_PROC_SYM(glEndList)
+		TEST_PROC_SYM(glEvalMesh1)
+		TEST_PROC_SYM(glEvalMesh2)
 		TEST_PROC_SYM(glFinish)
 		TEST_PROC_SYM(glFlush)
 		TEST_PROC_SYM(glDrawBuffer)
 		TEST_PROC_SYM(glDrawBuffers)
 		TEST_PROC_SYM(glDrawBuffersARB)
 		TEST_PROC_SYM(glDrawBuffersATI)
+		TEST_PROC_SYM(glDrawArrays)
+		TEST_PROC_SYM(glDrawElements)
+		TEST_PROC_SYM(glDrawPixels)
+		TEST_PROC_SYM(glDrawRangeElements)
+		TEST_PROC_SYM(glEnd)
 		TEST_PROC_SYM_OPT(glFramebufferDrawBufferEXT);
 		TEST_PROC_SYM_OPT(glFramebufferDrawBuffersEXT);
 		TEST_PROC_SYM_OPT(glFramebufferReadBufferEXT);
@@ -1343,12 +1391,35 @@ int procAddrTest(void)
 		TEST_PROC_SYM_OPT(glGetNamedFramebufferParameteriv)
 		TEST_PROC_SYM(glGetString)
 		TEST_PROC_SYM(glGetStringi)
+		TEST_PROC_SYM_OPT(glMultiDrawArrays)
+		TEST_PROC_SYM_OPT(glMultiDrawArraysEXT)
+		TEST_PROC_SYM_OPT(glMultiDrawArraysIndirect)
+		TEST_PROC_SYM_OPT(glMultiDrawArraysIndirectCount)
+		TEST_PROC_SYM_OPT(glMultiDrawArraysIndirectCountARB)
+		TEST_PROC_SYM_OPT(glMultiDrawElements)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsBaseVertex)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsEXT)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsIndirect)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsIndirectCount)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsIndirectCountARB)
 		TEST_PROC_SYM_OPT(glNamedFramebufferDrawBuffer);
 		TEST_PROC_SYM_OPT(glNamedFramebufferDrawBuffers);
 		TEST_PROC_SYM_OPT(glNamedFramebufferReadBuffer);
 		TEST_PROC_SYM(glPopAttrib)
 		TEST_PROC_SYM(glReadBuffer)
 		TEST_PROC_SYM(glReadPixels);
+		TEST_PROC_SYM(glRectd)
+		TEST_PROC_SYM(glRectdv)
+		TEST_PROC_SYM(glRectf)
+		TEST_PROC_SYM(glRectfv)
+		TEST_PROC_SYM(glRecti)
+		TEST_PROC_SYM(glRectiv)
+		TEST_PROC_SYM(glRects)
+		TEST_PROC_SYM(glRectsv)
+		TEST_PROC_SYM(glScissor)
+		TEST_PROC_SYM_OPT(glScissorArrayv)
+		TEST_PROC_SYM_OPT(glScissorIndexed)
+		TEST_PROC_SYM_OPT(glScissorIndexedv)
 		TEST_PROC_SYM(glViewport)
 
 		printf("SUCCESS!\n");
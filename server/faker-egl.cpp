@@ -1050,16 +1050,64 @@ void (*eglGetProcAddress(const char *procName))(void)
 		CHECK_FAKED(eglWaitSyncKHR);
 
 		// OpenGL
+		CHECK_FAKED(glAccum)
+		CHECK_FAKED(glBegin)
 		CHECK_FAKED(glBindFramebuffer)
 		CHECK_FAKED(glBindFramebufferEXT)
+		CHECK_FAKED(glBitmap)
+		CHECK_FAKED(glBlitFramebuffer)
+		CHECK_FAKED(glBlitFramebufferEXT)
+		CHECK_FAKED(glBlitNamedFramebuffer)
+		CHECK_FAKED(glCallList)
+		CHECK_FAKED(glCallLists)
+		CHECK_FAKED(glClear)
+		CHECK_FAKED(glClearBufferfv)
+		CHECK_FAKED(glClearBufferiv)
+		CHECK_FAKED(glClearBufferuiv)
+		CHECK_FAKED(glClearNamedFramebufferfv)
+		CHECK_FAKED(glClearNamedFramebufferiv)
+		CHECK_FAKED(glClearNamedFramebufferuiv)
+		CHECK_FAKED(glCopyPixels)
 		CHECK_FAKED(glDeleteFramebuffers)
 		CHECK_FAKED(glDeleteFramebuffersEXT)
+		CHECK_FAKED(glDisable)
+		CHECK_FAKED(glDisablei)
+		CHECK_FAKED(glDrawArraysEXT)
+		CHECK_FAKED(glDrawArraysIndirect)
+		CHECK_FAKED(glDrawArraysInstanced)
+		CHECK_FAKED(glDrawArraysInstancedARB)
+		CHECK_FAKED(glDrawArraysInstancedBaseInstance)
+		CHECK_FAKED(glDrawArraysInstancedEXT)
+		CHECK_FAKED(glDrawElementsBaseVertex)
+		CHECK_FAKED(glDrawElementsIndirect)
+		CHECK_FAKED(glDrawElementsInstanced)
+		CHECK_FAKED(glDrawElementsInstancedARB)
+		CHECK_FAKED(glDrawElementsInstancedBaseInstance)
+		CHECK_FAKED(glDrawElementsInstancedBaseVertex)
+		CHECK_FAKED(glDrawElementsInstancedBaseVertexBaseInstance)
+		CHECK_FAKED(glDrawElementsInstancedEXT)
+		CHECK_FAKED(glDrawRangeElementsBaseVertex)
+		CHECK_FAKED(glDrawRangeElementsEXT)
+		CHECK_FAKED(glDrawTransformFeedback)
+		CHECK_FAKED(glDrawTransformFeedbackInstanced)
+		CHECK_FAKED(glDrawTransformFeedbackStream)
+		CHECK_FAKED(glDrawTransformFeedbackStreamInstanced)
+		CHECK_FAKED(glEnable)
+		CHECK_FAKED(glEnablei)
+		CHECK_FAKED(glEndList)
+		CHECK_FAKED(glEvalMesh1)
+		CHECK_FAKED(glEvalMesh2)
 		CHECK_FAKED(glFinish)
 		CHECK_FAKED(glFlush)
 		CHECK_FAKED(glDrawBuffer)
 		CHECK_FAKED(glDrawBuffers)
 		CHECK_FAKED(glDrawBuffersARB)
 		CHECK_FAKED(glDrawBuffersATI)
+		CHECK_FAKED(glDrawArrays)
+		CHECK_FAKED(glDrawElements)
+		CHECK_FAKED(glDrawPixels)
+		CHECK_FAKED(glDrawRangeElements)
+		CHECK_FAKED(glEnd)
 		CHECK_FAKED(glFramebufferDrawBufferEXT)
 		CHECK_FAKED(glFramebufferDrawBuffersEXT)
 		CHECK_FAKED(glFramebufferReadBufferEXT)
@@ -1073,12 +1121,35 @@ void (*eglGetProcAddress(const char *procName))(void)
 		CHECK_FAKED(glGetNamedFramebufferParameteriv)
 		CHECK_FAKED(glGetString)
 		CHECK_FAKED(glGetStringi)
+		CHECK_FAKED(glMultiDrawArrays)
+		CHECK_FAKED(glMultiDrawArraysEXT)
+		CHECK_FAKED(glMultiDrawArraysIndirect)
+		CHECK_FAKED(glMultiDrawArraysIndirectCount)
+		CHECK_FAKED(glMultiDrawArraysIndirectCountARB)
+		CHECK_FAKED(glMultiDrawElements)
+		CHECK_FAKED(glMultiDrawElementsBaseVertex)
+		CHECK_FAKED(glMultiDrawElementsEXT)
+		CHECK_FAKED(glMultiDrawElementsIndirect)
+		CHECK_FAKED(glMultiDrawElementsIndirectCount)
+		CHECK_FAKED(glMultiDrawElementsIndirectCountARB)
 		CHECK_FAKED(glNamedFramebufferDrawBuffer)
 		CHECK_FAKED(glNamedFramebufferDrawBuffers)
 		CHECK_FAKED(glNamedFramebufferReadBuffer)
 		CHECK_FAKED(glPopAttrib)
 		CHECK_FAKED(glReadBuffer)
 		CHECK_FAKED(glReadPixels)
+		CHECK_FAKED(glRectd)
+		CHECK_FAKED(glRectdv)
+		CHECK_FAKED(glRectf)
+		CHECK_FAKED(glRectfv)
+		CHECK_FAKED(glRecti)
+		CHECK_FAKED(glRectiv)
+		CHECK_FAKED(glRects)
+		CHECK_FAKED(glRectsv)
+		CHECK_FAKED(glScissor)
+		CHECK_FAKED(glScissorArrayv)
+		CHECK_FAKED(glScissorIndexed)
+		CHECK_FAKED(glScissorIndexedv)
 		CHECK_FAKED(glViewport)
 	}
 	if(!retval)
@@ -1159,6 +1230,9 @@ EGLBoolean eglMakeCurrent(EGLDisplay display, EGLSurface draw, EGLSurface read,
 
 	TRY();
 
+	// Damage tracking is not used with EGL/X11 contexts.
+	faker::setDamageWin(0, NULL);
+
 	if(IS_EXCLUDED_EGLX(display))
 	{
 		faker::setEGLExcludeCurrent(true);
@@ -1514,7 +1588,7 @@ EGLBoolean eglSwapBuffers(EGLDisplay display, EGLSurface surface)
 		// eglSwapBuffers() rather than actually calling it.
 		if(_eglGetCurrentSurface(EGL_DRAW) == actualSurface)
 			_glFinish();
-		eglxvw->readback(GL_BACK, false, fconfig.sync);
+		eglxvw->readback(GL_BACK, false, fconfig.sync, true);
 		int interval = eglxvw->getSwapInterval();
 		if(interval > 0)
 		{
@@ -0,0 +1,86 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+#include <stdlib.h>
+#include <errno.h>
+#include <dlfcn.h>
+#include "fakerconfig.h"
+
+
+// Interposed environment functions
+//
+// These functions notify the configuration module that the environment has
+// changed, so the environment is parsed again the next time that a frame is
+// read back.  They can be called before the faker has been initialized, or
+// even before the C++ static initializers have run, so they must not use any
+// other part of the faker.  Modifying a string after passing it to putenv(),
+// or modifying environ directly, changes the environment without calling any
+// of these functions, so VirtualGL will not notice such changes until one of
+// these functions is called.
+
+
+#define LOADENVSYM(f) \
+	static _##f##Type __##f = NULL; \
+	if(!__##f) \
+	{ \
+		__##f = (_##f##Type)dlsym(RTLD_NEXT, #f); \
+		if(!__##f) { errno = ENOSYS;  return -1; } \
+	}
+
+typedef int (*_setenvType)(const char *, const char *, int);
+typedef int (*_unsetenvType)(const char *);
+typedef int (*_putenvType)(char *);
+typedef int (*_clearenvType)(void);
+
+
+extern "C" {
+
+int setenv(const char *name, const char *value, int overwrite)
+{
+	LOADENVSYM(setenv);
+	int retval = __setenv(name, value, overwrite);
+	fconfig_envchanged();
+	return retval;
+}
+
+
+int unsetenv(const char *name)
+{
+	LOADENVSYM(unsetenv);
+	int retval = __unsetenv(name);
+	fconfig_envchanged();
+	return retval;
+}
+
+
+int putenv(char *string)
+{
+	LOADENVSYM(putenv);
+	int retval = __putenv(string);
+	fconfig_envchanged();
+	return retval;
+}
+
+
+#ifdef __linux__
+
+int clearenv(void)
+{
+	LOADENVSYM(clearenv);
+	int retval = __clearenv();
+	fconfig_envchanged();
+	return retval;
+}
+
+#endif
+
+}  // extern "C"
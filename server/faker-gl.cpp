@@ -45,6 +45,138 @@ static void doGLReadback(bool spoilLast, bool sync)
 }
 
 
+// If damage tracking is enabled, then each of the drawing functions below adds
+// the region of the window that it might render into to the window's damaged
+// region, so that only that region needs to be read back.  The scissor box is
+// the only thing that reliably limits where these functions can render (the
+// viewport does not limit glClear(), and wide points and lines can extend
+// beyond it), so if the scissor test is disabled, then the whole window is
+// considered damaged.
+//
+// The VirtualWin instance for the current drawable is looked up when a context
+// is made current, and the scissor state of the current context is mirrored
+// by the glScissor(), glEnable(), and glDisable() interposers, so the drawing
+// functions need not query either.  A context can be current in only one
+// thread at a time, so this state is thread-local.  The scissor state becomes
+// unknown whenever it might have changed without our knowledge (for instance,
+// within a display list), in which case it is queried the next time it is
+// needed.  Once a context has used per-viewport scissor rectangles, the whole
+// window is always considered damaged.
+
+#define SCISSOR_UNKNOWN  -1
+#define SCISSOR_INDEXED  2
+
+namespace faker
+{
+	struct DamageState
+	{
+		VirtualWin *vw;
+		long windowEpoch;
+		int scissorTest;
+		GLint scissorBox[4];
+	};
+
+
+	// Called whenever a context is made current.  vw is the VirtualWin instance
+	// whose off-screen drawable is now current, or NULL if damage should not be
+	// tracked.
+	void setDamageWin(GLXContext ctx, VirtualWin *vw)
+	{
+		DamageState *ds = getDamageState();
+
+		if(!fconfig.damage || !ctx || !vw)
+		{
+			if(ds) { delete ds;  setDamageState(NULL); }
+			return;
+		}
+		if(!ds) { ds = new DamageState;  setDamageState(ds); }
+		ds->vw = vw;
+		ds->windowEpoch = windowEpoch;
+		ds->scissorTest =
+			CTXHASH.isScissorIndexed(ctx) ? SCISSOR_INDEXED : SCISSOR_UNKNOWN;
+	}
+}
+
+
+static void addDamage(faker::DamageState *ds)
+{
+	// If any VirtualWin instance has been destroyed since we looked up this one,
+	// then look it up again.
+	if(ds->windowEpoch != faker::windowEpoch)
+	{
+		long windowEpoch = faker::windowEpoch;
+		GLXDrawable drawable = backend::getCurrentDrawable();
+		ds->vw = drawable ? WINHASH.find(NULL, drawable) : NULL;
+		ds->windowEpoch = windowEpoch;
+	}
+	if(!ds->vw) return;
+
+	if(ds->scissorTest == SCISSOR_UNKNOWN)
+	{
+		GLint scissorTest = 0;
+		_glGetIntegerv(GL_SCISSOR_TEST, &scissorTest);
+		_glGetIntegerv(GL_SCISSOR_BOX, ds->scissorBox);
+		ds->scissorTest = scissorTest ? 1 : 0;
+	}
+	if(ds->scissorTest == 1)
+		ds->vw->addDamage(ds->scissorBox[0], ds->scissorBox[1],
+			ds->scissorBox[2], ds->scissorBox[3]);
+	else ds->vw->addDamage();
+}
+
+
+static void resetScissor(faker::DamageState *ds)
+{
+	if(ds && ds->scissorTest != SCISSOR_INDEXED)
+		ds->scissorTest = SCISSOR_UNKNOWN;
+}
+
+
+static void setScissorIndexed(faker::DamageState *ds)
+{
+	if(ds) ds->scissorTest = SCISSOR_INDEXED;
+	if(!fconfig.damage || faker::getOGLExcludeCurrent()
+		|| faker::getEGLXContextCurrent())
+		return;
+
+	TRY();
+
+	GLXContext ctx = backend::getCurrentContext();
+	if(ctx) CTXHASH.setScissorIndexed(ctx);
+
+	CATCH();
+}
+
+
+// The drawing and scissor state functions are called far too frequently to
+// afford the usual symbol check and faker level adjustment, and the underlying
+// OpenGL implementation never calls back into the faker from them, so once the
+// real function has been loaded, we call it directly.
+
+#define CALL_REAL(f, args) \
+{ \
+	if(__##f) __##f args; \
+	else _##f args; \
+}
+
+// Call a drawing function, first adding the region into which it might render
+// to the damaged region of the current window if damage is being tracked and
+// the specified condition is true.
+
+#define DRAW(f, args, cond) \
+{ \
+	faker::DamageState *ds = faker::getDamageState(); \
+	if(!ds || !(cond)) CALL_REAL(f, args) \
+	else \
+	{ \
+		TRY(); \
+		addDamage(ds); \
+		_##f args; \
+		CATCH(); \
+	} \
+}
+
+
 extern "C" {
 
 // VirtualGL reads back and transports the contents of the front buffer if
@@ -774,7 +906,7 @@ void glNamedFramebufferReadBuffer(GLuint framebuffer, GLenum mode)
 }
 
 
-// glPopAttrib() can change the draw buffer state as well :|
+// glPopAttrib() can change the draw buffer and scissor state as well :|
 
 void glPopAttrib(void)
 {
@@ -804,6 +936,7 @@ void glPopAttrib(void)
 		if(rbefore && !rafter && vw->isStereo()) vw->rdirty = true;
 	}
 	else _glPopAttrib();
+	resetScissor(faker::getDamageState());
 
 	/////////////////////////////////////////////////////////////////////////////
 	STOPTRACE();
@@ -948,4 +1081,566 @@ void glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 }
 
 
+// Drawing functions (see addDamage() above.)  Querying the scissor state is
+// illegal between glBegin() and glEnd(), so glCallList() and glCallLists()
+// rely on the enclosing glBegin() to add the damage in that case.
+
+void glAccum(GLenum op, GLfloat value)
+{
+	DRAW(glAccum, (op, value), op == GL_RETURN);
+}
+
+
+void glBegin(GLenum mode)
+{
+	faker::DamageState *ds = faker::getDamageState();
+
+	if(!ds)
+	{
+		CALL_REAL(glBegin, (mode));  return;
+	}
+
+	TRY();
+
+	addDamage(ds);
+	_glBegin(mode);
+	faker::setInsideBeginEnd(true);
+
+	CATCH();
+}
+
+
+void glEnd(void)
+{
+	if(!faker::getDamageState())
+	{
+		CALL_REAL(glEnd, ());  return;
+	}
+
+	TRY();
+
+	faker::setInsideBeginEnd(false);
+	_glEnd();
+
+	CATCH();
+}
+
+
+void glBitmap(GLsizei width, GLsizei height, GLfloat xorig, GLfloat yorig,
+	GLfloat xmove, GLfloat ymove, const GLubyte *bitmap)
+{
+	DRAW(glBitmap, (width, height, xorig, yorig, xmove, ymove, bitmap), true);
+}
+
+
+void glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+	GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask,
+	GLenum filter)
+{
+	DRAW(glBlitFramebuffer, (srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1,
+		dstY1, mask, filter), mask & GL_COLOR_BUFFER_BIT);
+}
+
+void glBlitFramebufferEXT(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+	GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask,
+	GLenum filter)
+{
+	glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1,
+		mask, filter);
+}
+
+
+void glBlitNamedFramebuffer(GLuint readFramebuffer, GLuint drawFramebuffer,
+	GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0,
+	GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+	DRAW(glBlitNamedFramebuffer, (readFramebuffer, drawFramebuffer, srcX0,
+		srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter),
+		drawFramebuffer == 0 && (mask & GL_COLOR_BUFFER_BIT));
+}
+
+
+// A display list may change the scissor state.
+
+void glCallList(GLuint list)
+{
+	faker::DamageState *ds = faker::getDamageState();
+
+	if(!ds)
+	{
+		CALL_REAL(glCallList, (list));  return;
+	}
+
+	TRY();
+
+	if(!faker::getInsideBeginEnd()) addDamage(ds);
+	_glCallList(list);
+	resetScissor(ds);
+
+	CATCH();
+}
+
+
+void glCallLists(GLsizei n, GLenum type, const GLvoid *lists)
+{
+	faker::DamageState *ds = faker::getDamageState();
+
+	if(!ds)
+	{
+		CALL_REAL(glCallLists, (n, type, lists));  return;
+	}
+
+	TRY();
+
+	if(!faker::getInsideBeginEnd()) addDamage(ds);
+	_glCallLists(n, type, lists);
+	resetScissor(ds);
+
+	CATCH();
+}
+
+
+void glClear(GLbitfield mask)
+{
+	DRAW(glClear, (mask), mask & GL_COLOR_BUFFER_BIT);
+}
+
+
+void glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat *value)
+{
+	DRAW(glClearBufferfv, (buffer, drawbuffer, value), buffer == GL_COLOR);
+}
+
+
+void glClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint *value)
+{
+	DRAW(glClearBufferiv, (buffer, drawbuffer, value), buffer == GL_COLOR);
+}
+
+
+void glClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint *value)
+{
+	DRAW(glClearBufferuiv, (buffer, drawbuffer, value), buffer == GL_COLOR);
+}
+
+
+void glClearNamedFramebufferfv(GLuint framebuffer, GLenum buffer,
+	GLint drawbuffer, const GLfloat *value)
+{
+	DRAW(glClearNamedFramebufferfv, (framebuffer, buffer, drawbuffer, value),
+		framebuffer == 0 && buffer == GL_COLOR);
+}
+
+
+void glClearNamedFramebufferiv(GLuint framebuffer, GLenum buffer,
+	GLint drawbuffer, const GLint *value)
+{
+	DRAW(glClearNamedFramebufferiv, (framebuffer, buffer, drawbuffer, value),
+		framebuffer == 0 && buffer == GL_COLOR);
+}
+
+
+void glClearNamedFramebufferuiv(GLuint framebuffer, GLenum buffer,
+	GLint drawbuffer, const GLuint *value)
+{
+	DRAW(glClearNamedFramebufferuiv, (framebuffer, buffer, drawbuffer, value),
+		framebuffer == 0 && buffer == GL_COLOR);
+}
+
+
+void glCopyPixels(GLint x, GLint y, GLsizei width, GLsizei height,
+	GLenum type)
+{
+	DRAW(glCopyPixels, (x, y, width, height, type), type == GL_COLOR);
+}
+
+
+void glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	DRAW(glDrawArrays, (mode, first, count), true);
+}
+
+void glDrawArraysEXT(GLenum mode, GLint first, GLsizei count)
+{
+	glDrawArrays(mode, first, count);
+}
+
+
+void glDrawArraysIndirect(GLenum mode, const void *indirect)
+{
+	DRAW(glDrawArraysIndirect, (mode, indirect), true);
+}
+
+
+void glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count,
+	GLsizei instancecount)
+{
+	DRAW(glDrawArraysInstanced, (mode, first, count, instancecount), true);
+}
+
+void glDrawArraysInstancedARB(GLenum mode, GLint first, GLsizei count,
+	GLsizei primcount)
+{
+	glDrawArraysInstanced(mode, first, count, primcount);
+}
+
+void glDrawArraysInstancedEXT(GLenum mode, GLint start, GLsizei count,
+	GLsizei primcount)
+{
+	glDrawArraysInstanced(mode, start, count, primcount);
+}
+
+
+void glDrawArraysInstancedBaseInstance(GLenum mode, GLint first,
+	GLsizei count, GLsizei instancecount, GLuint baseinstance)
+{
+	DRAW(glDrawArraysInstancedBaseInstance, (mode, first, count, instancecount,
+		baseinstance), true);
+}
+
+
+void glDrawElements(GLenum mode, GLsizei count, GLenum type,
+	const GLvoid *indices)
+{
+	DRAW(glDrawElements, (mode, count, type, indices), true);
+}
+
+
+void glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
+	const void *indices, GLint basevertex)
+{
+	DRAW(glDrawElementsBaseVertex, (mode, count, type, indices, basevertex),
+		true);
+}
+
+
+void glDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect)
+{
+	DRAW(glDrawElementsIndirect, (mode, type, indirect), true);
+}
+
+
+void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type,
+	const void *indices, GLsizei instancecount)
+{
+	DRAW(glDrawElementsInstanced, (mode, count, type, indices, instancecount),
+		true);
+}
+
+void glDrawElementsInstancedARB(GLenum mode, GLsizei count, GLenum type,
+	const void *indices, GLsizei primcount)
+{
+	glDrawElementsInstanced(mode, count, type, indices, primcount);
+}
+
+void glDrawElementsInstancedEXT(GLenum mode, GLsizei count, GLenum type,
+	const void *indices, GLsizei primcount)
+{
+	glDrawElementsInstanced(mode, count, type, indices, primcount);
+}
+
+
+void glDrawElementsInstancedBaseInstance(GLenum mode, GLsizei count,
+	GLenum type, const void *indices, GLsizei instancecount,
+	GLuint baseinstance)
+{
+	DRAW(glDrawElementsInstancedBaseInstance, (mode, count, type, indices,
+		instancecount, baseinstance), true);
+}
+
+
+void glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count,
+	GLenum type, const void *indices, GLsizei instancecount, GLint basevertex)
+{
+	DRAW(glDrawElementsInstancedBaseVertex, (mode, count, type, indices,
+		instancecount, basevertex), true);
+}
+
+
+void glDrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count,
+	GLenum type, const void *indices, GLsizei instancecount, GLint basevertex,
+	GLuint baseinstance)
+{
+	DRAW(glDrawElementsInstancedBaseVertexBaseInstance, (mode, count, type,
+		indices, instancecount, basevertex, baseinstance), true);
+}
+
+
+void glDrawPixels(GLsizei width, GLsizei height, GLenum format, GLenum type,
+	const GLvoid *pixels)
+{
+	DRAW(glDrawPixels, (width, height, format, type, pixels), true);
+}
+
+
+void glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count,
+	GLenum type, const GLvoid *indices)
+{
+	DRAW(glDrawRangeElements, (mode, start, end, count, type, indices), true);
+}
+
+void glDrawRangeElementsEXT(GLenum mode, GLuint start, GLuint end,
+	GLsizei count, GLenum type, const void *indices)
+{
+	glDrawRangeElements(mode, start, end, count, type, indices);
+}
+
+
+void glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end,
+	GLsizei count, GLenum type, const void *indices, GLint basevertex)
+{
+	DRAW(glDrawRangeElementsBaseVertex, (mode, start, end, count, type, indices,
+		basevertex), true);
+}
+
+
+void glDrawTransformFeedback(GLenum mode, GLuint id)
+{
+	DRAW(glDrawTransformFeedback, (mode, id), true);
+}
+
+
+void glDrawTransformFeedbackInstanced(GLenum mode, GLuint id,
+	GLsizei instancecount)
+{
+	DRAW(glDrawTransformFeedbackInstanced, (mode, id, instancecount), true);
+}
+
+
+void glDrawTransformFeedbackStream(GLenum mode, GLuint id, GLuint stream)
+{
+	DRAW(glDrawTransformFeedbackStream, (mode, id, stream), true);
+}
+
+
+void glDrawTransformFeedbackStreamInstanced(GLenum mode, GLuint id,
+	GLuint stream, GLsizei instancecount)
+{
+	DRAW(glDrawTransformFeedbackStreamInstanced, (mode, id, stream,
+		instancecount), true);
+}
+
+
+void glEvalMesh1(GLenum mode, GLint i1, GLint i2)
+{
+	DRAW(glEvalMesh1, (mode, i1, i2), true);
+}
+
+
+void glEvalMesh2(GLenum mode, GLint i1, GLint i2, GLint j1, GLint j2)
+{
+	DRAW(glEvalMesh2, (mode, i1, i2, j1, j2), true);
+}
+
+
+void glMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count,
+	GLsizei drawcount)
+{
+	DRAW(glMultiDrawArrays, (mode, first, count, drawcount), true);
+}
+
+void glMultiDrawArraysEXT(GLenum mode, const GLint *first,
+	const GLsizei *count, GLsizei primcount)
+{
+	glMultiDrawArrays(mode, first, count, primcount);
+}
+
+
+void glMultiDrawArraysIndirect(GLenum mode, const void *indirect,
+	GLsizei drawcount, GLsizei stride)
+{
+	DRAW(glMultiDrawArraysIndirect, (mode, indirect, drawcount, stride), true);
+}
+
+
+void glMultiDrawArraysIndirectCount(GLenum mode, const void *indirect,
+	GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+{
+	DRAW(glMultiDrawArraysIndirectCount, (mode, indirect, drawcount,
+		maxdrawcount, stride), true);
+}
+
+void glMultiDrawArraysIndirectCountARB(GLenum mode, const void *indirect,
+	GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+{
+	glMultiDrawArraysIndirectCount(mode, indirect, drawcount, maxdrawcount,
+		stride);
+}
+
+
+void glMultiDrawElements(GLenum mode, const GLsizei *count, GLenum type,
+	const void *const *indices, GLsizei drawcount)
+{
+	DRAW(glMultiDrawElements, (mode, count, type, indices, drawcount), true);
+}
+
+void glMultiDrawElementsEXT(GLenum mode, const GLsizei *count, GLenum type,
+	const void *const *indices, GLsizei primcount)
+{
+	glMultiDrawElements(mode, count, type, indices, primcount);
+}
+
+
+void glMultiDrawElementsBaseVertex(GLenum mode, const GLsizei *count,
+	GLenum type, const void *const *indices, GLsizei drawcount,
+	const GLint *basevertex)
+{
+	DRAW(glMultiDrawElementsBaseVertex, (mode, count, type, indices, drawcount,
+		basevertex), true);
+}
+
+
+void glMultiDrawElementsIndirect(GLenum mode, GLenum type,
+	const void *indirect, GLsizei drawcount, GLsizei stride)
+{
+	DRAW(glMultiDrawElementsIndirect, (mode, type, indirect, drawcount, stride),
+		true);
+}
+
+
+void glMultiDrawElementsIndirectCount(GLenum mode, GLenum type,
+	const void *indirect, GLintptr drawcount, GLsizei maxdrawcount,
+	GLsizei stride)
+{
+	DRAW(glMultiDrawElementsIndirectCount, (mode, type, indirect, drawcount,
+		maxdrawcount, stride), true);
+}
+
+void glMultiDrawElementsIndirectCountARB(GLenum mode, GLenum type,
+	const void *indirect, GLintptr drawcount, GLsizei maxdrawcount,
+	GLsizei stride)
+{
+	glMultiDrawElementsIndirectCount(mode, type, indirect, drawcount,
+		maxdrawcount, stride);
+}
+
+
+void glRectd(GLdouble x1, GLdouble y1, GLdouble x2, GLdouble y2)
+{
+	DRAW(glRectd, (x1, y1, x2, y2), true);
+}
+
+
+void glRectdv(const GLdouble *v1, const GLdouble *v2)
+{
+	DRAW(glRectdv, (v1, v2), true);
+}
+
+
+void glRectf(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2)
+{
+	DRAW(glRectf, (x1, y1, x2, y2), true);
+}
+
+
+void glRectfv(const GLfloat *v1, const GLfloat *v2)
+{
+	DRAW(glRectfv, (v1, v2), true);
+}
+
+
+void glRecti(GLint x1, GLint y1, GLint x2, GLint y2)
+{
+	DRAW(glRecti, (x1, y1, x2, y2), true);
+}
+
+
+void glRectiv(const GLint *v1, const GLint *v2)
+{
+	DRAW(glRectiv, (v1, v2), true);
+}
+
+
+void glRects(GLshort x1, GLshort y1, GLshort x2, GLshort y2)
+{
+	DRAW(glRects, (x1, y1, x2, y2), true);
+}
+
+
+void glRectsv(const GLshort *v1, const GLshort *v2)
+{
+	DRAW(glRectsv, (v1, v2), true);
+}
+
+
+// Scissor state functions (see addDamage() above.)  Any state changes that are
+// compiled into a display list rather than executed are forgotten when the
+// display list is ended.
+
+void glDisable(GLenum cap)
+{
+	faker::DamageState *ds = faker::getDamageState();
+
+	CALL_REAL(glDisable, (cap));
+	if(ds && cap == GL_SCISSOR_TEST && ds->scissorTest != SCISSOR_INDEXED)
+		ds->scissorTest = 0;
+}
+
+
+void glDisablei(GLenum target, GLuint index)
+{
+	CALL_REAL(glDisablei, (target, index));
+	if(target == GL_SCISSOR_TEST) setScissorIndexed(faker::getDamageState());
+}
+
+
+void glEnable(GLenum cap)
+{
+	faker::DamageState *ds = faker::getDamageState();
+
+	CALL_REAL(glEnable, (cap));
+	if(ds && cap == GL_SCISSOR_TEST && ds->scissorTest != SCISSOR_INDEXED)
+		ds->scissorTest = 1;
+}
+
+
+void glEnablei(GLenum target, GLuint index)
+{
+	CALL_REAL(glEnablei, (target, index));
+	if(target == GL_SCISSOR_TEST) setScissorIndexed(faker::getDamageState());
+}
+
+
+void glEndList(void)
+{
+	CALL_REAL(glEndList, ());
+	resetScissor(faker::getDamageState());
+}
+
+
+void glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	faker::DamageState *ds = faker::getDamageState();
+
+	CALL_REAL(glScissor, (x, y, width, height));
+	if(ds && width >= 0 && height >= 0)
+	{
+		ds->scissorBox[0] = x;  ds->scissorBox[1] = y;
+		ds->scissorBox[2] = width;  ds->scissorBox[3] = height;
+	}
+}
+
+
+void glScissorArrayv(GLuint first, GLsizei count, const GLint *v)
+{
+	CALL_REAL(glScissorArrayv, (first, count, v));
+	setScissorIndexed(faker::getDamageState());
+}
+
+
+void glScissorIndexed(GLuint index, GLint left, GLint bottom, GLsizei width,
+	GLsizei height)
+{
+	CALL_REAL(glScissorIndexed, (index, left, bottom, width, height));
+	setScissorIndexed(faker::getDamageState());
+}
+
+
+void glScissorIndexedv(GLuint index, const GLint *v)
+{
+	CALL_REAL(glScissorIndexedv, (index, v));
+	setScissorIndexed(faker::getDamageState());
+}
+
+
 }  // extern "C"
@@ -1,6 +1,6 @@
 // Copyright (C)2004 Landmark Graphics Corporation
 // Copyright (C)2005, 2006 Sun Microsystems, Inc.
-// Copyright (C)2009, 2011-2024 D. R. Commander
+// Copyright (C)2009, 2011-2024, 2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -1454,16 +1454,64 @@ void (*glXGetProcAddressARB(const GLubyte *procName))(void)
 		CHECK_FAKED(glXSelectEventSGIX)
 
 		// OpenGL
+		CHECK_FAKED(glAccum)
+		CHECK_FAKED(glBegin)
 		CHECK_FAKED(glBindFramebuffer)
 		CHECK_FAKED(glBindFramebufferEXT)
+		CHECK_FAKED(glBitmap)
+		CHECK_FAKED(glBlitFramebuffer)
+		CHECK_FAKED(glBlitFramebufferEXT)
+		CHECK_FAKED(glBlitNamedFramebuffer)
+		CHECK_FAKED(glCallList)
+		CHECK_FAKED(glCallLists)
+		CHECK_FAKED(glClear)
+		CHECK_FAKED(glClearBufferfv)
+		CHECK_FAKED(glClearBufferiv)
+		CHECK_FAKED(glClearBufferuiv)
+		CHECK_FAKED(glClearNamedFramebufferfv)
+		CHECK_FAKED(glClearNamedFramebufferiv)
+		CHECK_FAKED(glClearNamedFramebufferuiv)
+		CHECK_FAKED(glCopyPixels)
 		CHECK_FAKED(glDeleteFramebuffers)
 		CHECK_FAKED(glDeleteFramebuffersEXT)
+		CHECK_FAKED(glDisable)
+		CHECK_FAKED(glDisablei)
+		CHECK_FAKED(glDrawArraysEXT)
+		CHECK_FAKED(glDrawArraysIndirect)
+		CHECK_FAKED(glDrawArraysInstanced)
+		CHECK_FAKED(glDrawArraysInstancedARB)
+		CHECK_FAKED(glDrawArraysInstancedBaseInstance)
+		CHECK_FAKED(glDrawArraysInstancedEXT)
+		CHECK_FAKED(glDrawElementsBaseVertex)
+		CHECK_FAKED(glDrawElementsIndirect)
+		CHECK_FAKED(glDrawElementsInstanced)
+		CHECK_FAKED(glDrawElementsInstancedARB)
+		CHECK_FAKED(glDrawElementsInstancedBaseInstance)
+		CHECK_FAKED(glDrawElementsInstancedBaseVertex)
+		CHECK_FAKED(glDrawElementsInstancedBaseVertexBaseInstance)
+		CHECK_FAKED(glDrawElementsInstancedEXT)
+		CHECK_FAKED(glDrawRangeElementsBaseVertex)
+		CHECK_FAKED(glDrawRangeElementsEXT)
+		CHECK_FAKED(glDrawTransformFeedback)
+		CHECK_FAKED(glDrawTransformFeedbackInstanced)
+		CHECK_FAKED(glDrawTransformFeedbackStream)
+		CHECK_FAKED(glDrawTransformFeedbackStreamInstanced)
+		CHECK_FAKED(glEnable)
+		CHECK_FAKED(glEnablei)
+		CHECK_FAKED(glEndList)
+		CHECK_FAKED(glEvalMesh1)
+		CHECK_FAKED(glEvalMesh2)
 		CHECK_FAKED(glFinish)
 		CHECK_FAKED(glFlush)
 		CHECK_FAKED(glDrawBuffer)
 		CHECK_FAKED(glDrawBuffers)
 		CHECK_FAKED(glDrawBuffersARB)
 		CHECK_FAKED(glDrawBuffersATI)
+		CHECK_FAKED(glDrawArrays)
+		CHECK_FAKED(glDrawElements)
+		CHECK_FAKED(glDrawPixels)
+		CHECK_FAKED(glDrawRangeElements)
+		CHECK_FAKED(glEnd)
 		CHECK_FAKED(glFramebufferDrawBufferEXT)
 		CHECK_FAKED(glFramebufferDrawBuffersEXT)
 		CHECK_FAKED(glFramebufferReadBufferEXT)
@@ -1477,12 +1525,35 @@ void (*glXGetProcAddressARB(const GLubyte *procName))(void)
 		CHECK_FAKED(glGetNamedFramebufferParameteriv)
 		CHECK_FAKED(glGetString)
 		CHECK_FAKED(glGetStringi)
+		CHECK_FAKED(glMultiDrawArrays)
+		CHECK_FAKED(glMultiDrawArraysEXT)
+		CHECK_FAKED(glMultiDrawArraysIndirect)
+		CHECK_FAKED(glMultiDrawArraysIndirectCount)
+		CHECK_FAKED(glMultiDrawArraysIndirectCountARB)
+		CHECK_FAKED(glMultiDrawElements)
+		CHECK_FAKED(glMultiDrawElementsBaseVertex)
+		CHECK_FAKED(glMultiDrawElementsEXT)
+		CHECK_FAKED(glMultiDrawElementsIndirect)
+		CHECK_FAKED(glMultiDrawElementsIndirectCount)
+		CHECK_FAKED(glMultiDrawElementsIndirectCountARB)
 		CHECK_FAKED(glNamedFramebufferDrawBuffer)
 		CHECK_FAKED(glNamedFramebufferDrawBuffers)
 		CHECK_FAKED(glNamedFramebufferReadBuffer)
 		CHECK_FAKED(glPopAttrib)
 		CHECK_FAKED(glReadBuffer)
 		CHECK_FAKED(glReadPixels)
+		CHECK_FAKED(glRectd)
+		CHECK_FAKED(glRectdv)
+		CHECK_FAKED(glRectf)
+		CHECK_FAKED(glRectfv)
+		CHECK_FAKED(glRecti)
+		CHECK_FAKED(glRectiv)
+		CHECK_FAKED(glRects)
+		CHECK_FAKED(glRectsv)
+		CHECK_FAKED(glScissor)
+		CHECK_FAKED(glScissorArrayv)
+		CHECK_FAKED(glScissorIndexed)
+		CHECK_FAKED(glScissorIndexedv)
 		CHECK_FAKED(glViewport)
 	}
 	if(!retval)
@@ -1655,6 +1726,7 @@ Bool glXMakeCurrent(Display *dpy, GLXDrawable drawable, GLXContext ctx)
 	{
 		faker::setGLXExcludeCurrent(true);
 		faker::setOGLExcludeCurrent(true);
+		faker::setDamageWin(0, NULL);
 		return _glXMakeCurrent(dpy, drawable, ctx);
 	}
 	faker::setGLXExcludeCurrent(false);
@@ -1743,6 +1815,7 @@ Bool glXMakeCurrent(Display *dpy, GLXDrawable drawable, GLXContext ctx)
 	{
 		vw->clear();  vw->cleanup();
 	}
+	if(retval) faker::setDamageWin(ctx, vw);
 	faker::VirtualPixmap *vpm;
 	if((vpm = PMHASH.find(dpy, drawable)) != NULL)
 	{
@@ -1778,6 +1851,7 @@ Bool glXMakeContextCurrent(Display *dpy, GLXDrawable draw, GLXDrawable read,
 	{
 		faker::setGLXExcludeCurrent(true);
 		faker::setOGLExcludeCurrent(true);
+		faker::setDamageWin(0, NULL);
 		return _glXMakeContextCurrent(dpy, draw, read, ctx);
 	}
 	faker::setGLXExcludeCurrent(false);
@@ -1897,6 +1971,7 @@ Bool glXMakeContextCurrent(Display *dpy, GLXDrawable draw, GLXDrawable read,
 	}
 	if((readVW = WINHASH.find(NULL, read)) != NULL)
 		readVW->cleanup();
+	if(retval) faker::setDamageWin(ctx, drawVW);
 	faker::VirtualPixmap *vpm;
 	if((vpm = PMHASH.find(dpy, draw)) != NULL)
 	{
@@ -2044,7 +2119,19 @@ void glXQueryDrawable(Display *dpy, GLXDrawable draw, int attribute,
 		faker::VirtualWin *vw;  faker::VirtualPixmap *vpm;
 
 		if((vw = WINHASH.find(dpy, draw)) != NULL)
+		{
 			glxDraw = vw->getGLXDrawable();
+			// If VGL_PBPOOL is enabled, then the Pbuffer may be larger than the
+			// window.
+			if(attribute == GLX_WIDTH && vw->getWidth() > 0)
+			{
+				*value = vw->getWidth();  goto done;
+			}
+			if(attribute == GLX_HEIGHT && vw->getHeight() > 0)
+			{
+				*value = vw->getHeight();  goto done;
+			}
+		}
 		else if((vpm = PMHASH.find(dpy, draw)) != NULL)
 			glxDraw = vpm->getGLXDrawable();
 
@@ -2219,7 +2306,7 @@ void glXSwapBuffers(Display *dpy, GLXDrawable drawable)
 	fconfig.flushdelay = 0.;
 	if((vw = WINHASH.find(dpy, drawable)) != NULL)
 	{
-		vw->readback(GL_BACK, false, fconfig.sync);
+		vw->readback(GL_BACK, false, fconfig.sync, true);
 		vw->swapBuffers();
 		int interval = vw->getSwapInterval();
 		if(interval > 0)
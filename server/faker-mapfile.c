@@ -162,16 +162,64 @@
 		eglWaitSyncKHR;
 
 		/* OpenGL */
+		glAccum;
+		glBegin;
 		glBindFramebuffer;
 		glBindFramebufferEXT;
+		glBitmap;
+		glBlitFramebuffer;
+		glBlitFramebufferEXT;
+		glBlitNamedFramebuffer;
+		glCallList;
+		glCallLists;
+		glClear;
+		glClearBufferfv;
+		glClearBufferiv;
+		glClearBufferuiv;
+		glClearNamedFramebufferfv;
+		glClearNamedFramebufferiv;
+		glClearNamedFramebufferuiv;
+		glCopyPixels;
 		glDeleteFramebuffers;
 		glDeleteFramebuffersEXT;
+		glDisable;
+		glDisablei;
+		glDrawArraysEXT;
+		glDrawArraysIndirect;
+		glDrawArraysInstanced;
+		glDrawArraysInstancedARB;
+		glDrawArraysInstancedBaseInstance;
+		glDrawArraysInstancedEXT;
+		glDrawElementsBaseVertex;
+		glDrawElementsIndirect;
+		glDrawElementsInstanced;
+		glDrawElementsInstancedARB;
+		glDrawElementsInstancedBaseInstance;
+		glDrawElementsInstancedBaseVertex;
+		glDrawElementsInstancedBaseVertexBaseInstance;
+		glDrawElementsInstancedEXT;
+		glDrawRangeElementsBaseVertex;
+		glDrawRangeElementsEXT;
+		glDrawTransformFeedback;
+		glDrawTransformFeedbackInstanced;
+		glDrawTransformFeedbackStream;
+		glDrawTransformFeedbackStreamInstanced;
+		glEnable;
+		glEnablei;
+		glEndList;
+		glEvalMesh1;
+		glEvalMesh2;
 		glFinish;
 		glFlush;
 		glDrawBuffer;
 		glDrawBuffers;
 		glDrawBuffersARB;
 		glDrawBuffersATI;
+		glDrawArrays;
+		glDrawElements;
+		glDrawPixels;
+		glDrawRangeElements;
+		glEnd;
 		glFramebufferDrawBufferEXT;
 		glFramebufferDrawBuffersEXT;
 		glFramebufferReadBufferEXT;
@@ -185,12 +233,35 @@
 		glGetNamedFramebufferParameteriv;
 		glGetString;
 		glGetStringi;
+		glMultiDrawArrays;
+		glMultiDrawArraysEXT;
+		glMultiDrawArraysIndirect;
+		glMultiDrawArraysIndirectCount;
+		glMultiDrawArraysIndirectCountARB;
+		glMultiDrawElements;
+		glMultiDrawElementsBaseVertex;
+		glMultiDrawElementsEXT;
+		glMultiDrawElementsIndirect;
+		glMultiDrawElementsIndirectCount;
+		glMultiDrawElementsIndirectCountARB;
 		glNamedFramebufferDrawBuffer;
 		glNamedFramebufferDrawBuffers;
 		glNamedFramebufferReadBuffer;
 		glPopAttrib;
 		glReadBuffer;
 		glReadPixels;
+		glRectd;
+		glRectdv;
+		glRectf;
+		glRectfv;
+		glRecti;
+		glRectiv;
+		glRects;
+		glRectsv;
+		glScissor;
+		glScissorArrayv;
+		glScissorIndexed;
+		glScissorIndexedv;
 		glViewport;
 
 		/* OpenCL */
@@ -219,6 +290,7 @@
 		XNextEvent;
 		XOpenDisplay;
 		XkbOpenDisplay;
+		XPending;
 		XQueryExtension;
 		XResizeWindow;
 		XServerVendor;
@@ -227,6 +299,14 @@
 		#endif
 		XWindowEvent;
 
+		/* Environment */
+		#ifdef __linux__
+		clearenv;
+		#endif
+		putenv;
+		setenv;
+		unsetenv;
+
 		_vgl_dlopen;
 		_vgl_getAutotestColor;
 		_vgl_getAutotestFrame;
@@ -348,6 +348,20 @@ extern "C" {
 		return retval; \
 	}
 
+#define VFUNCDEF12(f, at1, a1, at2, a2, at3, a3, at4, a4, at5, a5, at6, a6, \
+	at7, a7, at8, a8, at9, a9, at10, a10, at11, a11, at12, a12, fake_f) \
+	typedef void (*_##f##Type)(at1, at2, at3, at4, at5, at6, at7, at8, at9, \
+		at10, at11, at12); \
+	SYMDEF(f); \
+	static INLINE void _##f(at1 a1, at2 a2, at3 a3, at4 a4, at5 a5, at6 a6, \
+		at7 a7, at8 a8, at9 a9, at10 a10, at11 a11, at12 a12) \
+	{ \
+		CHECKSYM(f, fake_f); \
+		DISABLE_FAKER(); \
+		__##f(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); \
+		ENABLE_FAKER(); \
+	}
+
 #define FUNCDEF13(RetType, f, at1, a1, at2, a2, at3, a3, at4, a4, at5, a5, \
 	at6, a6, at7, a7, at8, a8, at9, a9, at10, a10, at11, a11, at12, a12, \
 	at13, a13, fake_f) \
@@ -742,15 +756,124 @@ FUNCDEF3(EGLint, eglWaitSyncKHR, EGLDisplay, display, EGLSyncKHR, sync,
 
 // GL functions
 
+VFUNCDEF2(glAccum, GLenum, op, GLfloat, value, glAccum)
+
+VFUNCDEF1(glBegin, GLenum, mode, glBegin)
+
 VFUNCDEF2(glBindFramebuffer, GLenum, target, GLuint, framebuffer,
 	glBindFramebuffer)
 
 VFUNCDEF2(glBindFramebufferEXT, GLenum, target, GLuint, framebuffer,
 	glBindFramebufferEXT)
 
+VFUNCDEF7(glBitmap, GLsizei, width, GLsizei, height, GLfloat, xorig,
+	GLfloat, yorig, GLfloat, xmove, GLfloat, ymove, const GLubyte *, bitmap,
+	glBitmap)
+
+VFUNCDEF10(glBlitFramebuffer, GLint, srcX0, GLint, srcY0, GLint, srcX1,
+	GLint, srcY1, GLint, dstX0, GLint, dstY0, GLint, dstX1, GLint, dstY1,
+	GLbitfield, mask, GLenum, filter, glBlitFramebuffer)
+
+VFUNCDEF12(glBlitNamedFramebuffer, GLuint, readFramebuffer,
+	GLuint, drawFramebuffer, GLint, srcX0, GLint, srcY0, GLint, srcX1,
+	GLint, srcY1, GLint, dstX0, GLint, dstY0, GLint, dstX1, GLint, dstY1,
+	GLbitfield, mask, GLenum, filter, glBlitNamedFramebuffer)
+
+VFUNCDEF1(glCallList, GLuint, list, glCallList)
+
+VFUNCDEF3(glCallLists, GLsizei, n, GLenum, type, const GLvoid *, lists,
+	glCallLists)
+
+VFUNCDEF1(glClear, GLbitfield, mask, glClear)
+
+VFUNCDEF3(glClearBufferfv, GLenum, buffer, GLint, drawbuffer,
+	const GLfloat *, value, glClearBufferfv)
+
+VFUNCDEF3(glClearBufferiv, GLenum, buffer, GLint, drawbuffer,
+	const GLint *, value, glClearBufferiv)
+
+VFUNCDEF3(glClearBufferuiv, GLenum, buffer, GLint, drawbuffer,
+	const GLuint *, value, glClearBufferuiv)
+
+VFUNCDEF4(glClearNamedFramebufferfv, GLuint, framebuffer, GLenum, buffer,
+	GLint, drawbuffer, const GLfloat *, value, glClearNamedFramebufferfv)
+
+VFUNCDEF4(glClearNamedFramebufferiv, GLuint, framebuffer, GLenum, buffer,
+	GLint, drawbuffer, const GLint *, value, glClearNamedFramebufferiv)
+
+VFUNCDEF4(glClearNamedFramebufferuiv, GLuint, framebuffer, GLenum, buffer,
+	GLint, drawbuffer, const GLuint *, value, glClearNamedFramebufferuiv)
+
+VFUNCDEF5(glCopyPixels, GLint, x, GLint, y, GLsizei, width, GLsizei, height,
+	GLenum, type, glCopyPixels)
+
 VFUNCDEF2(glDeleteFramebuffers, GLsizei, n, const GLuint *, framebuffers,
 	glDeleteFramebuffers)
 
+VFUNCDEF1(glDisable, GLenum, cap, glDisable)
+
+VFUNCDEF2(glDisablei, GLenum, target, GLuint, index, glDisablei)
+
+VFUNCDEF2(glDrawArraysIndirect, GLenum, mode, const void *, indirect,
+	glDrawArraysIndirect)
+
+VFUNCDEF4(glDrawArraysInstanced, GLenum, mode, GLint, first, GLsizei, count,
+	GLsizei, instancecount, glDrawArraysInstanced)
+
+VFUNCDEF5(glDrawArraysInstancedBaseInstance, GLenum, mode, GLint, first,
+	GLsizei, count, GLsizei, instancecount, GLuint, baseinstance,
+	glDrawArraysInstancedBaseInstance)
+
+VFUNCDEF5(glDrawElementsBaseVertex, GLenum, mode, GLsizei, count, GLenum, type,
+	const void *, indices, GLint, basevertex, glDrawElementsBaseVertex)
+
+VFUNCDEF3(glDrawElementsIndirect, GLenum, mode, GLenum, type,
+	const void *, indirect, glDrawElementsIndirect)
+
+VFUNCDEF5(glDrawElementsInstanced, GLenum, mode, GLsizei, count, GLenum, type,
+	const void *, indices, GLsizei, instancecount, glDrawElementsInstanced)
+
+VFUNCDEF6(glDrawElementsInstancedBaseInstance, GLenum, mode, GLsizei, count,
+	GLenum, type, const void *, indices, GLsizei, instancecount,
+	GLuint, baseinstance, glDrawElementsInstancedBaseInstance)
+
+VFUNCDEF6(glDrawElementsInstancedBaseVertex, GLenum, mode, GLsizei, count,
+	GLenum, type, const void *, indices, GLsizei, instancecount,
+	GLint, basevertex, glDrawElementsInstancedBaseVertex)
+
+VFUNCDEF7(glDrawElementsInstancedBaseVertexBaseInstance, GLenum, mode,
+	GLsizei, count, GLenum, type, const void *, indices, GLsizei, instancecount,
+	GLint, basevertex, GLuint, baseinstance,
+	glDrawElementsInstancedBaseVertexBaseInstance)
+
+VFUNCDEF7(glDrawRangeElementsBaseVertex, GLenum, mode, GLuint, start,
+	GLuint, end, GLsizei, count, GLenum, type, const void *, indices,
+	GLint, basevertex, glDrawRangeElementsBaseVertex)
+
+VFUNCDEF2(glDrawTransformFeedback, GLenum, mode, GLuint, id,
+	glDrawTransformFeedback)
+
+VFUNCDEF3(glDrawTransformFeedbackInstanced, GLenum, mode, GLuint, id,
+	GLsizei, instancecount, glDrawTransformFeedbackInstanced)
+
+VFUNCDEF3(glDrawTransformFeedbackStream, GLenum, mode, GLuint, id,
+	GLuint, stream, glDrawTransformFeedbackStream)
+
+VFUNCDEF4(glDrawTransformFeedbackStreamInstanced, GLenum, mode, GLuint, id,
+	GLuint, stream, GLsizei, instancecount,
+	glDrawTransformFeedbackStreamInstanced)
+
+VFUNCDEF1(glEnable, GLenum, cap, glEnable)
+
+VFUNCDEF2(glEnablei, GLenum, target, GLuint, index, glEnablei)
+
+VFUNCDEF0(glEndList, glEndList)
+
+VFUNCDEF3(glEvalMesh1, GLenum, mode, GLint, i1, GLint, i2, glEvalMesh1)
+
+VFUNCDEF5(glEvalMesh2, GLenum, mode, GLint, i1, GLint, i2, GLint, j1, GLint, j2,
+	glEvalMesh2)
+
 VFUNCDEF0(glFinish, glFinish)
 
 VFUNCDEF0(glFlush, glFlush)
@@ -759,6 +882,20 @@ VFUNCDEF1(glDrawBuffer, GLenum, drawbuf, glDrawBuffer)
 
 VFUNCDEF2(glDrawBuffers, GLsizei, n, const GLenum *, bufs, glDrawBuffers)
 
+VFUNCDEF3(glDrawArrays, GLenum, mode, GLint, first, GLsizei, count,
+	glDrawArrays)
+
+VFUNCDEF4(glDrawElements, GLenum, mode, GLsizei, count, GLenum, type,
+	const GLvoid *, indices, glDrawElements)
+
+VFUNCDEF5(glDrawPixels, GLsizei, width, GLsizei, height, GLenum, format,
+	GLenum, type, const GLvoid *, pixels, glDrawPixels)
+
+VFUNCDEF6(glDrawRangeElements, GLenum, mode, GLuint, start, GLuint, end,
+	GLsizei, count, GLenum, type, const GLvoid *, indices, glDrawRangeElements)
+
+VFUNCDEF0(glEnd, glEnd)
+
 VFUNCDEF2(glFramebufferDrawBufferEXT, GLuint, framebuffer, GLenum, mode,
 	glFramebufferDrawBufferEXT)
 
@@ -793,6 +930,32 @@ FUNCDEF1(const GLubyte *, glGetString, GLenum, name, glGetString)
 FUNCDEF2(const GLubyte *, glGetStringi, GLenum, name, GLuint, index,
 	glGetStringi)
 
+VFUNCDEF4(glMultiDrawArrays, GLenum, mode, const GLint *, first,
+	const GLsizei *, count, GLsizei, drawcount, glMultiDrawArrays)
+
+VFUNCDEF4(glMultiDrawArraysIndirect, GLenum, mode, const void *, indirect,
+	GLsizei, drawcount, GLsizei, stride, glMultiDrawArraysIndirect)
+
+VFUNCDEF5(glMultiDrawArraysIndirectCount, GLenum, mode, const void *, indirect,
+	GLintptr, drawcount, GLsizei, maxdrawcount, GLsizei, stride,
+	glMultiDrawArraysIndirectCount)
+
+VFUNCDEF5(glMultiDrawElements, GLenum, mode, const GLsizei *, count,
+	GLenum, type, const void *const *, indices, GLsizei, drawcount,
+	glMultiDrawElements)
+
+VFUNCDEF6(glMultiDrawElementsBaseVertex, GLenum, mode, const GLsizei *, count,
+	GLenum, type, const void *const *, indices, GLsizei, drawcount,
+	const GLint *, basevertex, glMultiDrawElementsBaseVertex)
+
+VFUNCDEF5(glMultiDrawElementsIndirect, GLenum, mode, GLenum, type,
+	const void *, indirect, GLsizei, drawcount, GLsizei, stride,
+	glMultiDrawElementsIndirect)
+
+VFUNCDEF6(glMultiDrawElementsIndirectCount, GLenum, mode, GLenum, type,
+	const void *, indirect, GLintptr, drawcount, GLsizei, maxdrawcount,
+	GLsizei, stride, glMultiDrawElementsIndirectCount)
+
 VFUNCDEF2(glNamedFramebufferDrawBuffer, GLuint, framebuffer, GLenum, buf,
 	glNamedFramebufferDrawBuffer)
 
@@ -809,6 +972,34 @@ VFUNCDEF1(glReadBuffer, GLenum, mode, glReadBuffer)
 VFUNCDEF7(glReadPixels, GLint, x, GLint, y, GLsizei, width, GLsizei, height,
 	GLenum, format, GLenum, type, GLvoid *, pixels, glReadPixels)
 
+VFUNCDEF4(glRectd, GLdouble, x1, GLdouble, y1, GLdouble, x2, GLdouble, y2,
+	glRectd)
+
+VFUNCDEF2(glRectdv, const GLdouble *, v1, const GLdouble *, v2, glRectdv)
+
+VFUNCDEF4(glRectf, GLfloat, x1, GLfloat, y1, GLfloat, x2, GLfloat, y2, glRectf)
+
+VFUNCDEF2(glRectfv, const GLfloat *, v1, const GLfloat *, v2, glRectfv)
+
+VFUNCDEF4(glRecti, GLint, x1, GLint, y1, GLint, x2, GLint, y2, glRecti)
+
+VFUNCDEF2(glRectiv, const GLint *, v1, const GLint *, v2, glRectiv)
+
+VFUNCDEF4(glRects, GLshort, x1, GLshort, y1, GLshort, x2, GLshort, y2, glRects)
+
+VFUNCDEF2(glRectsv, const GLshort *, v1, const GLshort *, v2, glRectsv)
+
+VFUNCDEF4(glScissor, GLint, x, GLint, y, GLsizei, width, GLsizei, height,
+	glScissor)
+
+VFUNCDEF3(glScissorArrayv, GLuint, first, GLsizei, count, const GLint *, v,
+	glScissorArrayv)
+
+VFUNCDEF5(glScissorIndexed, GLuint, index, GLint, left, GLint, bottom,
+	GLsizei, width, GLsizei, height, glScissorIndexed)
+
+VFUNCDEF2(glScissorIndexedv, GLuint, index, const GLint *, v, glScissorIndexedv)
+
 VFUNCDEF4(glViewport, GLint, x, GLint, y, GLsizei, width, GLsizei, height,
 	glViewport)
 
@@ -888,6 +1079,8 @@ FUNCDEF2(int, XNextEvent, Display *, dpy, XEvent *, xe, XNextEvent)
 
 FUNCDEF1(Display *, XOpenDisplay, _Xconst char *, name, XOpenDisplay)
 
+FUNCDEF1(int, XPending, Display *, dpy, XPending)
+
 #ifdef LIBX11_18
 FUNCDEF6(Display *, XkbOpenDisplay, _Xconst char *, display_name,
 	int *, event_rtrn, int *, error_rtrn, int *, major_in_out,
@@ -994,31 +1187,28 @@ VFUNCDEF2(glBindBuffer, GLenum, target, GLuint, buffer, NULL)
 
 VFUNCDEF2(glBindRenderbuffer, GLenum, target, GLuint, renderbuffer, NULL)
 
-VFUNCDEF7(glBitmap, GLsizei, width, GLsizei, height, GLfloat, xorig,
-	GLfloat, yorig, GLfloat, xmove, GLfloat, ymove, const GLubyte *, bitmap,
-	NULL)
-
-VFUNCDEF10(glBlitFramebuffer, GLint, srcX0, GLint, srcY0, GLint, srcX1,
-	GLint, srcY1, GLint, dstX0, GLint, dstY0, GLint, dstX1, GLint, dstY1,
-	GLbitfield, mask, GLenum, filter, NULL)
-
 VFUNCDEF4(glBufferData, GLenum, target, GLsizeiptr, size, const GLvoid *, data,
 	GLenum, usage, NULL)
 
+VFUNCDEF4(glBufferStorage, GLenum, target, GLsizeiptr, size,
+	const GLvoid *, data, GLbitfield, flags, NULL)
+
 FUNCDEF1(GLenum, glCheckFramebufferStatus, GLenum, target, NULL)
 
-VFUNCDEF1(glClear, GLbitfield, mask, NULL)
+FUNCDEF3(GLenum, glClientWaitSync, GLsync, sync, GLbitfield, flags, GLuint64,
+	timeout, NULL)
 
 VFUNCDEF4(glClearColor, GLclampf, red, GLclampf, green, GLclampf, blue,
 	GLclampf, alpha, NULL)
 
-VFUNCDEF5(glCopyPixels, GLint, x, GLint, y, GLsizei, width, GLsizei, height,
-	GLenum, type, NULL)
+VFUNCDEF2(glDeleteBuffers, GLsizei, n, const GLuint *, buffers, NULL)
 
 VFUNCDEF2(glDeleteRenderbuffers, GLsizei, n, const GLuint *, renderbuffers,
 	NULL)
 
-VFUNCDEF0(glEndList, NULL)
+VFUNCDEF1(glDeleteSync, GLsync, sync, NULL)
+
+FUNCDEF2(GLsync, glFenceSync, GLenum, condition, GLbitfield, flags, NULL)
 
 VFUNCDEF4(glFramebufferRenderbuffer, GLenum, target, GLenum, attachment,
 	GLenum, renderbuffertarget, GLuint, renderbuffer, NULL)
@@ -1038,6 +1228,9 @@ VFUNCDEF0(glLoadIdentity, NULL)
 
 FUNCDEF2(void *, glMapBuffer, GLenum, target, GLenum, access, NULL)
 
+FUNCDEF4(void *, glMapBufferRange, GLenum, target, GLintptr, offset,
+	GLsizeiptr, length, GLbitfield, access, NULL)
+
 VFUNCDEF1(glMatrixMode, GLenum, mode, NULL)
 
 VFUNCDEF2(glNewList, GLuint, list, GLenum, mode, NULL)
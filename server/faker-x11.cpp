@@ -1,6 +1,6 @@
 // Copyright (C)2004 Landmark Graphics Corporation
 // Copyright (C)2005, 2006 Sun Microsystems, Inc.
-// Copyright (C)2009, 2011-2016, 2018-2025 D. R. Commander
+// Copyright (C)2009, 2011-2016, 2018-2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -535,6 +535,10 @@ static void setupXDisplay(Display *dpy)
 	if(!(codes = XAddExtension(dpy)))
 		THROW("Memory allocation error");
 
+	// Extension code 5 stores the chooseFBConfig() cache for a Screen.
+	if(!(codes = XAddExtension(dpy)))
+		THROW("Memory allocation error");
+
 	if(!excludeDisplay && strlen(fconfig.vendor) > 0)
 	{
 		// Danger, Will Robinson!  We do this to prevent a small memory leak, but
@@ -691,8 +695,8 @@ char *XServerVendor(Display *dpy)
 
 
 // The following functions are interposed so that VirtualGL can detect window
-// resizes, key presses (to pop up the VGL configuration dialog), and window
-// delete events from the window manager.
+// resizes, window exposures, key presses (to pop up the VGL configuration
+// dialog), and window delete events from the window manager.
 
 static void handleEvent(Display *dpy, XEvent *xe)
 {
@@ -702,6 +706,12 @@ static void handleEvent(Display *dpy, XEvent *xe)
 	if(IS_EXCLUDED(dpy))
 		return;
 
+	// The window that most recently received input gets priority when
+	// compressing frames for the VGL Transport.
+	if(xe && (xe->type == FocusIn || xe->type == KeyPress
+		|| xe->type == ButtonPress) && WINHASH.find(dpy, xe->xany.window))
+		server::TileScheduler::setFocus(xe->xany.window);
+
 	if(xe && xe->type == ConfigureNotify)
 	{
 		if((vw = WINHASH.find(dpy, xe->xconfigure.window)) != NULL)
@@ -733,6 +743,13 @@ static void handleEvent(Display *dpy, XEvent *xe)
 			/////////////////////////////////////////////////////////////////////////
 		}
 	}
+	else if(xe && xe->type == Expose)
+	{
+		if((vw = WINHASH.find(dpy, xe->xexpose.window)) != NULL)
+			vw->expose();
+		if((eglxvw = EGLXWINHASH.find(dpy, xe->xexpose.window)) != NULL)
+			eglxvw->expose();
+	}
 	else if(xe && xe->type == KeyPress)
 	{
 		unsigned int state =
@@ -759,6 +776,28 @@ static void handleEvent(Display *dpy, XEvent *xe)
 }
 
 
+// If the application is about to wait for an event, then it has probably
+// stopped rendering, so deliver any frames that pipelined readback (see
+// VGL_PBOBUFS) has not yet delivered.  If the application is only polling for
+// events (ifIdle = true), then it may still be rendering, so the frames are
+// delivered only if it has not swapped buffers for a while.
+
+static void drainReadback(Display *dpy, bool ifIdle = false)
+{
+	if(fconfig.pbobufs < 2 || IS_EXCLUDED(dpy)
+		|| XEventsQueued(dpy, QueuedAlready) > 0)
+		return;
+
+	DISABLE_FAKER();
+
+	if(faker::WindowHash::isAlloc()) WINHASH.drainReadback(dpy, ifIdle);
+	if(faker::EGLXWindowHash::isAlloc())
+		EGLXWINHASH.drainReadback(dpy, ifIdle);
+
+	ENABLE_FAKER();
+}
+
+
 Bool XCheckMaskEvent(Display *dpy, long event_mask, XEvent *xe)
 {
 	Bool retval = 0;
@@ -852,6 +891,7 @@ int XMaskEvent(Display *dpy, long event_mask, XEvent *xe)
 	int retval = 0;
 	TRY();
 
+	drainReadback(dpy);
 	retval = _XMaskEvent(dpy, event_mask, xe);
 	handleEvent(dpy, xe);
 
@@ -896,6 +936,7 @@ int XNextEvent(Display *dpy, XEvent *xe)
 	int retval = 0;
 	TRY();
 
+	drainReadback(dpy);
 	retval = _XNextEvent(dpy, xe);
 	handleEvent(dpy, xe);
 
@@ -904,6 +945,21 @@ int XNextEvent(Display *dpy, XEvent *xe)
 }
 
 
+// Many toolkits call XPending() and then wait for the X connection to become
+// readable, rather than calling XNextEvent().
+
+int XPending(Display *dpy)
+{
+	int retval = 0;
+	TRY();
+
+	if((retval = _XPending(dpy)) < 1) drainReadback(dpy, true);
+
+	CATCH();
+	return retval;
+}
+
+
 int XResizeWindow(Display *dpy, Window win, unsigned int width,
 	unsigned int height)
 {
@@ -940,6 +996,7 @@ int XWindowEvent(Display *dpy, Window win, long event_mask, XEvent *xe)
 	int retval = 0;
 	TRY();
 
+	drainReadback(dpy);
 	retval = _XWindowEvent(dpy, win, event_mask, xe);
 	handleEvent(dpy, xe);
 
@@ -420,8 +420,8 @@ xcb_glx_query_version_reply_t *
 
 
 // The following functions are interposed so that VirtualGL can detect window
-// resizes, key presses (to pop up the VGL configuration dialog), and window
-// delete events from the window manager.
+// resizes, window exposures, key presses (to pop up the VGL configuration
+// dialog), and window delete events from the window manager.
 
 static void handleXCBEvent(xcb_connection_t *conn, xcb_generic_event_t *ev)
 {
@@ -468,6 +468,20 @@ static void handleXCBEvent(xcb_connection_t *conn, xcb_generic_event_t *ev)
 			}
 			break;
 		}
+		case XCB_EXPOSE:
+		{
+			xcb_expose_event_t *ee = (xcb_expose_event_t *)ev;
+			Display *dpy = XCBCONNHASH.getX11Display(conn);
+
+			if(!dpy || faker::isDisplayExcluded(dpy)) break;
+
+			if((vw = WINHASH.find(dpy, ee->window)) != NULL)
+				vw->expose();
+			if((eglxvw = EGLXWINHASH.find(dpy, ee->window)) != NULL)
+				eglxvw->expose();
+
+			break;
+		}
 		case XCB_KEY_PRESS:
 		{
 			xcb_key_press_event_t *kpe = (xcb_key_press_event_t *)ev;
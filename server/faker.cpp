@@ -19,12 +19,14 @@
 #include "EGLXDisplayHash.h"
 #include "EGLXWindowHash.h"
 #include "ContextHashEGL.h"
+#include "FrameCapture.h"
 #include "PbufferHashEGL.h"
 #include "GLXDrawableHash.h"
 #include "GlobalCriticalSection.h"
 #include "PixmapHash.h"
 #include "VisualHash.h"
 #include "WindowHash.h"
+#include "WorkerPool.h"
 #include "fakerconfig.h"
 #include "threadlocal.h"
 #include <dlfcn.h>
@@ -37,6 +39,8 @@ Display *dpy3D = NULL;
 bool deadYet = false;
 char *glExtensions = NULL;
 EGLint eglMajor = 0, eglMinor = 0;
+// Incremented whenever a VirtualWin instance is destroyed
+long windowEpoch = 0;
 VGL_THREAD_LOCAL(TraceLevel, long, 0)
 VGL_THREAD_LOCAL(FakerLevel, long, 0)
 VGL_THREAD_LOCAL(GLXExcludeCurrent, bool, false)
@@ -50,6 +54,8 @@ VGL_THREAD_LOCAL(AutotestDrawable, long, 0)
 VGL_THREAD_LOCAL(EGLXContextCurrent, bool, false)
 VGL_THREAD_LOCAL(EGLError, long, EGL_SUCCESS)
 VGL_THREAD_LOCAL(CurrentEGLXDisplay, EGLXDisplay *, NULL)
+VGL_THREAD_LOCAL(InsideBeginEnd, bool, false)
+VGL_THREAD_LOCAL(DamageState, DamageState *, NULL)
 
 
 static void cleanup(void)
@@ -64,6 +70,9 @@ static void cleanup(void)
 	if(backend::ContextHashEGL::isAlloc()) CTXHASHEGL.kill();
 	if(backend::PbufferHashEGL::isAlloc()) PBHASHEGL.kill();
 	if(backend::RBOContext::isAlloc()) RBOCONTEXT.kill();
+	if(server::WorkerPool::isAlloc()) WORKERPOOL.kill();
+	if(server::TileScheduler::isAlloc()) TILESCHED.kill();
+	if(server::FrameCapture::isAlloc()) FRAMECAPTURE.kill();
 	free(glExtensions);
 	unloadSymbols();
 }
@@ -27,6 +27,9 @@
 
 namespace faker
 {
+	class VirtualWin;
+	struct DamageState;
+
 	// Unfortunately, we have to create our own EGLDisplay structure because
 	// there is no way to get multiple unique EGLDisplay handles for the same DRI
 	// device.  VirtualGL assumes that EGLDisplay handles returned by the
@@ -46,6 +49,7 @@ namespace faker
 	extern bool deadYet;
 	extern char *glExtensions;
 	extern EGLint eglMajor, eglMinor;
+	extern long windowEpoch;
 
 	extern void init(void);
 	extern Display *init3D(void);
@@ -77,6 +81,11 @@ namespace faker
 	extern void setEGLError(long error);
 	extern EGLXDisplay *getCurrentEGLXDisplay(void);
 	extern void setCurrentEGLXDisplay(EGLXDisplay *display);
+	extern bool getInsideBeginEnd(void);
+	extern void setInsideBeginEnd(bool insideBeginEnd);
+	extern DamageState *getDamageState(void);
+	extern void setDamageState(DamageState *damageState);
+	extern void setDamageWin(GLXContext ctx, VirtualWin *vw);
 
 	void *loadSymbol(const char *name, bool optional = false);
 	void unloadSymbols(void);
@@ -1,4 +1,4 @@
-// Copyright (C)2009-2025 D. R. Commander
+// Copyright (C)2009-2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -49,6 +49,12 @@ using namespace util;
 
 static FakerConfig fconfig_env;
 static bool fconfig_envset = false;
+// fconfig_envgeneration is incremented whenever the environment changes, and
+// fconfig_envparsed is the value it had when the environment was last parsed.
+static volatile unsigned int fconfig_envgeneration = 1;
+#ifdef INFAKER
+static unsigned int fconfig_envparsed = 0;
+#endif
 
 #if FCONFIG_USESHM == 1
 static int fconfig_shmid = -1;
@@ -168,7 +174,9 @@ static void fconfig_init(void)
 	CriticalSection::SafeLock l(fcmutex);
 	memset(&fconfig, 0, sizeof(FakerConfig));
 	memset(&fconfig_env, 0, sizeof(FakerConfig));
+	fconfig.adaptive = 0;
 	fconfig.compress = -1;
+	fconfig.damage = 0;
 	strncpy(fconfig.config, VGLCONFIG_PATH, MAXSTR);
 	#ifdef sun
 	fconfig.dlsymloader = true;
@@ -185,6 +193,8 @@ static void fconfig_init(void)
 	fconfig.interframe = 1;
 	strncpy(fconfig.localdpystring, ":0", MAXSTR);
 	fconfig.np = 1;
+	fconfig.pbobufs = 1;
+	fconfig.pbpool = 0;
 	fconfig.port = -1;
 	fconfig.probeglx = -1;
 	fconfig.qual = DEFQUAL;
@@ -195,12 +205,20 @@ static void fconfig_init(void)
 	fconfig.spoillast = 1;
 	fconfig.stereo = RRSTEREO_QUADBUF;
 	fconfig.subsamp = -1;
+	fconfig.targetfps = 30.0;
+	fconfig.tilehash = 0;
 	fconfig.tilesize = RR_DEFAULTTILESIZE;
 	fconfig.transpixel = -1;
+	fconfig.x11interframe = 0;
+	fconfig.zerocopy = 0;
 	fconfig_reloadenv();
 	#ifdef USEHELGRIND
 	ANNOTATE_BENIGN_RACE_SIZED(&fconfig.egl, sizeof(bool), );
 	ANNOTATE_BENIGN_RACE_SIZED(&fconfig.flushdelay, sizeof(double), );
+	#ifdef INFAKER
+	ANNOTATE_BENIGN_RACE_SIZED(&fconfig_envparsed, sizeof(unsigned int), );
+	#endif
+	ANNOTATE_BENIGN_RACE_SIZED(&fconfig_envset, sizeof(bool), );
 	#endif
 }
 
@@ -278,15 +296,45 @@ void fconfig_setgamma(FakerConfig &fc, double gamma)
 }
 
 
+// Called by the interposed versions of setenv(), putenv(), unsetenv(), and
+// clearenv()
+
+void fconfig_envchanged(void)
+{
+	__sync_fetch_and_add(&fconfig_envgeneration, 1);
+}
+
+
+// Applications can change the configuration at run time by modifying the
+// environment, so this function is called every time a frame is read back.
+// Parsing the environment is expensive, though, so within the faker, it is
+// skipped unless the environment has changed since it was last parsed.
+// Outside of the faker, nothing tracks changes to the environment, so the
+// environment is always parsed.
+
 void fconfig_reloadenv(void)
 {
 	char *env;
 
+	#ifdef INFAKER
+	unsigned int generation = fconfig_envgeneration;
+	if(fconfig_envset && generation == fconfig_envparsed) return;
+	#endif
+
 	CriticalSection::SafeLock l(fcmutex);
 
+	#ifdef INFAKER
+	generation = fconfig_envgeneration;
+	if(fconfig_envset && generation == fconfig_envparsed) return;
+	fconfig_envparsed = generation;
+	#endif
+
+	FETCHENV_BOOL("VGL_ADAPTIVE", adaptive);
 	FETCHENV_BOOL("VGL_ALLOWINDIRECT", allowindirect);
 	FETCHENV_BOOL("VGL_AMDGPUHACK", amdgpuHack);
+	FETCHENV_STR("VGL_ATTRIBCACHE", attribcache);
 	FETCHENV_BOOL("VGL_AUTOTEST", autotest);
+	FETCHENV_STR("VGL_CAPTURE", capture);
 	FETCHENV_BOOL("VGL_CHROMEHACK", chromeHack);
 	FETCHENV_STR("VGL_CLIENT", client);
 	if((env = getenv("VGL_SUBSAMP")) != NULL && strlen(env) > 0)
@@ -322,6 +370,7 @@ void fconfig_reloadenv(void)
 			compress = itemp;
 		else if(!strnicmp(env, "p", 1)) compress = RRCOMP_PROXY;
 		else if(!strnicmp(env, "j", 1)) compress = RRCOMP_JPEG;
+		else if(!strnicmp(env, "l", 1)) compress = RRCOMP_LOSSLESS;
 		else if(!strnicmp(env, "r", 1)) compress = RRCOMP_RGB;
 		else if(!strnicmp(env, "x", 1)) compress = RRCOMP_XV;
 		else if(!strnicmp(env, "y", 1)) compress = RRCOMP_YUV;
@@ -332,6 +381,7 @@ void fconfig_reloadenv(void)
 		}
 	}
 	FETCHENV_STR("VGL_CONFIG", config);
+	FETCHENV_BOOL("VGL_DAMAGE", damage);
 	FETCHENV_STR("VGL_DEFAULTFBCONFIG", defaultfbconfig);
 	if((env = getenv("VGL_DISPLAY")) != NULL && strlen(env) > 0)
 	{
@@ -419,10 +469,14 @@ void fconfig_reloadenv(void)
 	FETCHENV_BOOL("VGL_INTERFRAME", interframe);
 	FETCHENV_STR("VGL_LOG", log);
 	FETCHENV_BOOL("VGL_LOGO", logo);
+	FETCHENV_DBL("VGL_MAXBW", maxbw, 0.0, 1000000.0);
+	FETCHENV_INT("VGL_MAXINFLIGHT", maxinflight, 0, 64);
 	FETCHENV_INT("VGL_NPROCS", np, 1, min(NumProcs(), MAXPROCS));
 	#ifdef FAKEOPENCL
 	FETCHENV_STR("VGL_OCLLIB", ocllib);
 	#endif
+	FETCHENV_INT("VGL_PBOBUFS", pbobufs, 1, MAXPBOS);
+	FETCHENV_BOOL("VGL_PBPOOL", pbpool);
 	FETCHENV_INT("VGL_PORT", port, 0, 65535);
 	FETCHENV_BOOL("VGL_PROBEGLX", probeglx);
 	FETCHENV_INT("VGL_QUAL", qual, 1, 100);
@@ -468,6 +522,8 @@ void fconfig_reloadenv(void)
 		}
 	}
 	FETCHENV_BOOL("VGL_SYNC", sync);
+	FETCHENV_DBL("VGL_TARGETFPS", targetfps, 0.1, 1000000.0);
+	FETCHENV_BOOL("VGL_TILEHASH", tilehash);
 	FETCHENV_INT("VGL_TILESIZE", tilesize, 8, 1024);
 	FETCHENV_BOOL("VGL_TRACE", trace);
 	FETCHENV_INT("VGL_TRANSPIXEL", transpixel, 0, 255);
@@ -475,6 +531,7 @@ void fconfig_reloadenv(void)
 	FETCHENV_STR("VGL_XVENDOR", vendor);
 	FETCHENV_BOOL("VGL_VERBOSE", verbose);
 	FETCHENV_BOOL("VGL_WM", wm);
+	FETCHENV_BOOL("VGL_X11INTERFRAME", x11interframe);
 	FETCHENV_STR("VGL_X11LIB", x11lib);
 	#ifdef FAKEXCB
 	FETCHENV_STR("VGL_XCBLIB", xcblib);
@@ -482,6 +539,7 @@ void fconfig_reloadenv(void)
 	FETCHENV_STR("VGL_XCBKEYSYMSLIB", xcbkeysymslib);
 	FETCHENV_STR("VGL_XCBX11LIB", xcbkeysymslib);
 	#endif
+	FETCHENV_BOOL("VGL_ZEROCOPY", zerocopy);
 
 	if(strlen(fconfig.transport) > 0)
 	{
@@ -641,12 +699,16 @@ void fconfig_setprobeglxfromdpy(Display *dpy)
 
 void fconfig_print(FakerConfig &fc)
 {
+	PRCONF_INT(adaptive);
 	PRCONF_INT(allowindirect);
 	PRCONF_INT(amdgpuHack);
+	PRCONF_STR(capture);
+	PRCONF_STR(attribcache);
 	PRCONF_INT(chromeHack);
 	PRCONF_STR(client);
 	PRCONF_INT(compress);
 	PRCONF_STR(config);
+	PRCONF_INT(damage);
 	PRCONF_STR(defaultfbconfig);
 	PRCONF_INT(dlsymloader);
 	PRCONF_INT(egl);
@@ -667,10 +729,14 @@ void fconfig_print(FakerConfig &fc)
 	PRCONF_STR(localdpystring);
 	PRCONF_STR(log);
 	PRCONF_INT(logo);
+	PRCONF_DBL(maxbw);
+	PRCONF_INT(maxinflight);
 	PRCONF_INT(np);
 	#ifdef FAKEOPENCL
 	PRCONF_STR(ocllib);
 	#endif
+	PRCONF_INT(pbobufs);
+	PRCONF_INT(pbpool);
 	PRCONF_INT(port);
 	PRCONF_INT(qual);
 	PRCONF_INT(readback);
@@ -680,6 +746,8 @@ void fconfig_print(FakerConfig &fc)
 	PRCONF_INT(stereo);
 	PRCONF_INT(subsamp);
 	PRCONF_INT(sync);
+	PRCONF_DBL(targetfps);
+	PRCONF_INT(tilehash);
 	PRCONF_INT(tilesize);
 	PRCONF_INT(trace);
 	PRCONF_INT(transpixel);
@@ -690,6 +758,7 @@ void fconfig_print(FakerConfig &fc)
 	PRCONF_STR(vendor);
 	PRCONF_INT(verbose);
 	PRCONF_INT(wm);
+	PRCONF_INT(x11interframe);
 	PRCONF_STR(x11lib);
 	#ifdef FAKEXCB
 	PRCONF_STR(xcblib);
@@ -697,4 +766,5 @@ void fconfig_print(FakerConfig &fc)
 	PRCONF_STR(xcbkeysymslib);
 	PRCONF_STR(xcbx11lib);
 	#endif
+	PRCONF_INT(zerocopy);
 }
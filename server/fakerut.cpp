@@ -1,6 +1,6 @@
 // Copyright (C)2004 Landmark Graphics Corporation
 // Copyright (C)2005, 2006 Sun Microsystems, Inc.
-// Copyright (C)2010-2015, 2017-2025 D. R. Commander
+// Copyright (C)2010-2015, 2017-2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -31,6 +31,7 @@
 #include "Error.h"
 #include "Mutex.h"
 #include "Thread.h"
+#include "Timer.h"
 #include <X11/Xmd.h>
 #include <GL/glxproto.h>
 #ifdef USEHELGRIND
@@ -1642,6 +1643,104 @@ int visTest(void)
 }
 
 
+// Some toolkits call glXChooseFBConfig() and glXChooseVisual() many times
+// with the same attributes during startup and whenever they create a widget.
+// This test verifies that the FB config selection is stable across repeated
+// calls and across permutations of the attribute list, and it measures how
+// long the first selection on a new display connection takes (which includes
+// building the visual and FB config tables) as well as the time required by
+// the sequence of GLX calls that a typical toolkit makes for each new widget.
+
+#define CONFIG_BENCH_ITER  1000
+
+static bool sameConfigs(Display *dpy, GLXFBConfig *c1, int n1, GLXFBConfig *c2,
+	int n2)
+{
+	if(n1 != n2 || !c1 != !c2) return false;
+	for(int i = 0; i < n1; i++)
+		if(cfgid(dpy, c1[i]) != cfgid(dpy, c2[i])) return false;
+	return true;
+}
+
+int configCacheTest(void)
+{
+	Display *dpy = NULL;
+	XVisualInfo *vis = NULL;
+	GLXFBConfig *configs = NULL, *configs2 = NULL;
+	int n = 0, n2 = 0, retval = 1;
+	int cattribs[] = { GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT, GLX_RENDER_TYPE,
+		GLX_RGBA_BIT, GLX_DOUBLEBUFFER, 1, GLX_RED_SIZE, 8, GLX_GREEN_SIZE, 8,
+		GLX_BLUE_SIZE, 8, GLX_DEPTH_SIZE, 1, None };
+	int cattribsPerm[] = { GLX_DEPTH_SIZE, 1, GLX_BLUE_SIZE, 8,
+		GLX_DOUBLEBUFFER, 1, GLX_GREEN_SIZE, 8, GLX_RENDER_TYPE, GLX_RGBA_BIT,
+		GLX_RED_SIZE, 8, GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT, None };
+	int vattribs[] = { GLX_RGBA, GLX_DOUBLEBUFFER, GLX_RED_SIZE, 8,
+		GLX_GREEN_SIZE, 8, GLX_BLUE_SIZE, 8, GLX_DEPTH_SIZE, 1, None };
+	Timer timer;
+
+	printf("FB config selection test\n\n");
+
+	try
+	{
+		if(!(dpy = XOpenDisplay(0))) THROW("Could not open display");
+		if(DefaultDepth(dpy, DefaultScreen(dpy)) == 30)
+		{
+			cattribs[7] = cattribs[9] = cattribs[11] = 10;
+			cattribsPerm[3] = cattribsPerm[7] = cattribsPerm[11] = 10;
+			vattribs[3] = vattribs[5] = vattribs[7] = 10;
+		}
+
+		timer.start();
+		if(!(configs = glXChooseFBConfig(dpy, DefaultScreen(dpy), cattribs, &n))
+			|| n < 1)
+			THROW("No matching FB configs");
+		double startupTime = timer.elapsed();
+
+		for(int i = 0; i < 2; i++)
+		{
+			if(!(configs2 = glXChooseFBConfig(dpy, DefaultScreen(dpy),
+				i ? cattribsPerm : cattribs, &n2)))
+				THROW("No matching FB configs");
+			if(!sameConfigs(dpy, configs, n, configs2, n2))
+				THROW(i ? "Permuted attribute list returned different FB configs" :
+					"Repeated call returned different FB configs");
+			XFree(configs2);  configs2 = NULL;
+		}
+
+		timer.start();
+		for(int i = 0; i < CONFIG_BENCH_ITER; i++)
+		{
+			if(!(vis = glXChooseVisual(dpy, DefaultScreen(dpy), vattribs)))
+				THROW("Could not find a suitable visual");
+			XFree(vis);  vis = NULL;
+			if(!(configs2 = glXChooseFBConfig(dpy, DefaultScreen(dpy), cattribs,
+				&n2)))
+				THROW("No matching FB configs");
+			if(!(vis = glXGetVisualFromFBConfig(dpy, configs2[0])))
+				THROW("glXGetVisualFromFBConfig()");
+			XFree(vis);  vis = NULL;
+			XFree(configs2);  configs2 = NULL;
+		}
+		double widgetTime = timer.elapsed() / (double)CONFIG_BENCH_ITER;
+
+		printf("First FB config selection: %.3f ms\n", startupTime * 1000.);
+		printf("Per-widget visual/FB config selection: %.3f us\n",
+			widgetTime * 1000000.);
+		printf("SUCCESS!\n");
+	}
+	catch(std::exception &e)
+	{
+		printf("Failed! (%s)\n", e.what());  retval = 0;
+	}
+	fflush(stdout);
+	if(vis) XFree(vis);
+	if(configs2) XFree(configs2);
+	if(configs) XFree(configs);
+	if(dpy) XCloseDisplay(dpy);
+	return retval;
+}
+
+
 #define DEFTHREADS  30
 #define MAXTHREADS  100
 bool deadYet = false;
@@ -3651,16 +3750,64 @@ int procAddrTest(void)
 		TEST_PROC_SYM_OPT(glXSelectEventSGIX)
 
 		// OpenGL
+		TEST_PROC_SYM(glAccum)
+		TEST_PROC_SYM(glBegin)
 		TEST_PROC_SYM(glBindFramebuffer)
 		TEST_PROC_SYM(glBindFramebufferEXT)
+		TEST_PROC_SYM(glBitmap)
+		TEST_PROC_SYM(glBlitFramebuffer)
+		TEST_PROC_SYM_OPT(glBlitFramebufferEXT)
+		TEST_PROC_SYM_OPT(glBlitNamedFramebuffer)
+		TEST_PROC_SYM(glCallList)
+		TEST_PROC_SYM(glCallLists)
+		TEST_PROC_SYM(glClear)
+		TEST_PROC_SYM_OPT(glClearBufferfv)
+		TEST_PROC_SYM_OPT(glClearBufferiv)
+		TEST_PROC_SYM_OPT(glClearBufferuiv)
+		TEST_PROC_SYM_OPT(glClearNamedFramebufferfv)
+		TEST_PROC_SYM_OPT(glClearNamedFramebufferiv)
+		TEST_PROC_SYM_OPT(glClearNamedFramebufferuiv)
+		TEST_PROC_SYM(glCopyPixels)
 		TEST_PROC_SYM(glDeleteFramebuffers)
 		TEST_PROC_SYM(glDeleteFramebuffersEXT)
+		TEST_PROC_SYM(glDisable)
+		TEST_PROC_SYM_OPT(glDisablei)
+		TEST_PROC_SYM_OPT(glDrawArraysEXT)
+		TEST_PROC_SYM_OPT(glDrawArraysIndirect)
+		TEST_PROC_SYM_OPT(glDrawArraysInstanced)
+		TEST_PROC_SYM_OPT(glDrawArraysInstancedARB)
+		TEST_PROC_SYM_OPT(glDrawArraysInstancedBaseInstance)
+		TEST_PROC_SYM_OPT(glDrawArraysInstancedEXT)
+		TEST_PROC_SYM_OPT(glDrawElementsBaseVertex)
+		TEST_PROC_SYM_OPT(glDrawElementsIndirect)
+		TEST_PROC_SYM_OPT(glDrawElementsInstanced)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedARB)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedBaseInstance)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedBaseVertex)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedBaseVertexBaseInstance)
+		TEST_PROC_SYM_OPT(glDrawElementsInstancedEXT)
+		TEST_PROC_SYM_OPT(glDrawRangeElementsBaseVertex)
+		TEST_PROC_SYM_OPT(glDrawRangeElementsEXT)
+		TEST_PROC_SYM_OPT(glDrawTransformFeedback)
+		TEST_PROC_SYM_OPT(glDrawTransformFeedbackInstanced)
+		TEST_PROC_SYM_OPT(glDrawTransformFeedbackStream)
+		TEST_PROC_SYM_OPT(glDrawTransformFeedbackStreamInstanced)
+		TEST_PROC_SYM(glEnable)
+		TEST_PROC_SYM_OPT(glEnablei)
+		TEST_PROC_SYM(glEndList)
+		TEST_PROC_SYM(glEvalMesh1)
+		TEST_PROC_SYM(glEvalMesh2)
 		TEST_PROC_SYM(glFinish)
 		TEST_PROC_SYM(glFlush)
 		TEST_PROC_SYM(glDrawBuffer)
 		TEST_PROC_SYM(glDrawBuffers)
 		TEST_PROC_SYM(glDrawBuffersARB)
 		TEST_PROC_SYM(glDrawBuffersATI)
+		TEST_PROC_SYM(glDrawArrays)
+		TEST_PROC_SYM(glDrawElements)
+		TEST_PROC_SYM(glDrawPixels)
+		TEST_PROC_SYM(glDrawRangeElements)
+		TEST_PROC_SYM(glEnd)
 		TEST_PROC_SYM_OPT(glFramebufferDrawBufferEXT);
 		TEST_PROC_SYM_OPT(glFramebufferDrawBuffersEXT);
 		TEST_PROC_SYM_OPT(glFramebufferReadBufferEXT);
@@ -3674,12 +3821,35 @@ int procAddrTest(void)
 		TEST_PROC_SYM_OPT(glGetNamedFramebufferParameteriv)
 		TEST_PROC_SYM(glGetString)
 		TEST_PROC_SYM(glGetStringi)
+		TEST_PROC_SYM_OPT(glMultiDrawArrays)
+		TEST_PROC_SYM_OPT(glMultiDrawArraysEXT)
+		TEST_PROC_SYM_OPT(glMultiDrawArraysIndirect)
+		TEST_PROC_SYM_OPT(glMultiDrawArraysIndirectCount)
+		TEST_PROC_SYM_OPT(glMultiDrawArraysIndirectCountARB)
+		TEST_PROC_SYM_OPT(glMultiDrawElements)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsBaseVertex)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsEXT)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsIndirect)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsIndirectCount)
+		TEST_PROC_SYM_OPT(glMultiDrawElementsIndirectCountARB)
 		TEST_PROC_SYM_OPT(glNamedFramebufferDrawBuffer);
 		TEST_PROC_SYM_OPT(glNamedFramebufferDrawBuffers);
 		TEST_PROC_SYM_OPT(glNamedFramebufferReadBuffer);
 		TEST_PROC_SYM(glPopAttrib)
 		TEST_PROC_SYM(glReadBuffer)
 		TEST_PROC_SYM(glReadPixels);
+		TEST_PROC_SYM(glRectd)
+		TEST_PROC_SYM(glRectdv)
+		TEST_PROC_SYM(glRectf)
+		TEST_PROC_SYM(glRectfv)
+		TEST_PROC_SYM(glRecti)
+		TEST_PROC_SYM(glRectiv)
+		TEST_PROC_SYM(glRects)
+		TEST_PROC_SYM(glRectsv)
+		TEST_PROC_SYM(glScissor)
+		TEST_PROC_SYM_OPT(glScissorArrayv)
+		TEST_PROC_SYM_OPT(glScissorIndexed)
+		TEST_PROC_SYM_OPT(glScissorIndexedv)
 		TEST_PROC_SYM(glViewport)
 
 		printf("SUCCESS!\n");
@@ -3781,6 +3951,8 @@ int main(int argc, char **argv)
 	printf("\n");
 	if(!visTest()) ret = -1;
 	printf("\n");
+	if(!configCacheTest()) ret = -1;
+	printf("\n");
 	if(!multiThreadTest(nThreads)) ret = -1;
 	printf("\n");
 	if(!offScreenTest(doDBPixmap, doUseXFont, doSelectEvent)) ret = -1;
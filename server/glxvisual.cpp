@@ -1,6 +1,6 @@
 // Copyright (C)2004 Landmark Graphics Corporation
 // Copyright (C)2005 Sun Microsystems, Inc.
-// Copyright (C)2009-2016, 2019-2025 D. R. Commander
+// Copyright (C)2009-2016, 2019-2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -15,12 +15,14 @@
 #include "glxvisual.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 #include "Error.h"
 #include "Mutex.h"
 #include "faker.h"
 #include "vglutil.h"
 #include "TempContextEGL.h"
+#include "AttribCache.h"
 
 using namespace util;
 
@@ -54,8 +56,8 @@ typedef struct
 	vaEntries = va[0].nVisuals;
 
 
-#define GET_CA_TABLE() \
-	struct _VGLFBConfig *ca;  int caEntries; \
+#define GET_CA() \
+	struct _VGLFBConfig *ca; \
 	XEDataObject obj; \
 	XExtData *extData; \
 	\
@@ -66,8 +68,11 @@ typedef struct
 		minExtensionNumber + 3); \
 	if(!extData) \
 		THROW("Could not retrieve FB config attribute table for screen"); \
-	ca = (struct _VGLFBConfig *)extData->private_data; \
-	caEntries = ca[0].nConfigs;
+	ca = (struct _VGLFBConfig *)extData->private_data;
+
+#define GET_CA_TABLE() \
+	GET_CA() \
+	int caEntries = ca[0].nConfigs;
 
 
 // This function assigns, as much as possible, various permutations of common
@@ -202,12 +207,20 @@ static void assignDefaultFBConfigAttribs(Display *dpy, int screen,
 }
 
 
+// Attributes of a 2D X server visual that are obtained by probing the 2D X
+// server
+typedef struct
+{
+	int isDB, isGL, isStereo, score;
+} VisProbe;
+
 static bool buildVisAttribTable(Display *dpy, int screen)
 {
 	int clientGLX = 0, majorOpcode = -1, firstEvent = -1, firstError = -1,
 		nVisuals = 0;
 	XVisualInfo *visuals = NULL, vtemp;
 	VisAttrib *va = NULL;
+	VisProbe *probes = NULL;  bool probesCached = false;
 	XEDataObject obj;
 	XExtData *extData;
 	obj.screen = XScreenOfDisplay(dpy, screen);
@@ -226,14 +239,6 @@ static bool buildVisAttribTable(Display *dpy, int screen)
 		if(extData && extData->private_data) return true;
 
 		fconfig_setprobeglxfromdpy(dpy);
-		if(fconfig.probeglx
-			&& _XQueryExtension(dpy, "GLX", &majorOpcode, &firstEvent, &firstError)
-			&& majorOpcode >= 0 && firstEvent >= 0 && firstError >= 0)
-		{
-			if(fconfig.verbose)
-				vglout.println("[VGL] NOTICE: Probing 2D X server for stereo visuals");
-			clientGLX = 1;
-		}
 		vtemp.screen = screen;
 		if(!(visuals = XGetVisualInfo(dpy, VisualScreenMask, &vtemp, &nVisuals))
 			|| nVisuals == 0)
@@ -242,6 +247,44 @@ static bool buildVisAttribTable(Display *dpy, int screen)
 		if(!(va = (VisAttrib *)calloc(nVisuals, sizeof(VisAttrib))))
 			THROW("Memory allocation error");
 
+		bool hasGLX = fconfig.probeglx
+			&& _XQueryExtension(dpy, "GLX", &majorOpcode, &firstEvent, &firstError)
+			&& majorOpcode >= 0 && firstEvent >= 0 && firstError >= 0;
+
+		// Probing the 2D X server's visuals requires a burst of round trips, so
+		// the results can be cached on disk.  Many distinct 2D X servers have the
+		// same vendor, release, and visual list, so the key also includes the
+		// display string and the 2D X server's GLX vendor and version.  The key
+		// includes the visual list, so the cache entry is ignored if the 2D X
+		// server's visuals change.
+		server::AttribCache cache("2D X server visual probe");
+		if(fconfig.probeglx && cache.isEnabled())
+		{
+			const char *glxVendor = NULL, *glxVersion = NULL;
+			if(hasGLX)
+			{
+				glxVendor = _glXQueryServerString(dpy, screen, GLX_VENDOR);
+				glxVersion = _glXQueryServerString(dpy, screen, GLX_VERSION);
+			}
+			cache.addKey("%s\n%s\n%d\n%d\n%d\n%s\n%s\n", DisplayString(dpy),
+				ServerVendor(dpy), VendorRelease(dpy), screen, fconfig.chromeHack,
+				glxVendor ? glxVendor : "", glxVersion ? glxVersion : "");
+			for(int i = 0; i < nVisuals; i++)
+				cache.addKey("%lx %d %d %d\n", visuals[i].visualid, visuals[i].depth,
+					visuals[i].c_class, visuals[i].bits_per_rgb);
+			if(!(probes = (VisProbe *)calloc(nVisuals, sizeof(VisProbe))))
+				THROW("Memory allocation error");
+			if(cache.load(probes, nVisuals * sizeof(VisProbe)))
+				probesCached = true;
+		}
+
+		if(hasGLX && !probesCached)
+		{
+			if(fconfig.verbose)
+				vglout.println("[VGL] NOTICE: Probing 2D X server for stereo visuals");
+			clientGLX = 1;
+		}
+
 		for(int i = 0; i < nVisuals; i++)
 		{
 			va[i].visualID = visuals[i].visualid;
@@ -279,6 +322,29 @@ static bool buildVisAttribTable(Display *dpy, int screen)
 				va[i].glx.samples = -1;
 		}
 
+		if(probesCached)
+		{
+			for(int i = 0; i < nVisuals; i++)
+			{
+				va[i].isDB = probes[i].isDB;
+				va[i].isGL = probes[i].isGL;
+				va[i].isStereo = probes[i].isStereo;
+				va[i].score = probes[i].score;
+			}
+		}
+		else if(probes)
+		{
+			for(int i = 0; i < nVisuals; i++)
+			{
+				probes[i].isDB = va[i].isDB;
+				probes[i].isGL = va[i].isGL;
+				probes[i].isStereo = va[i].isStereo;
+				probes[i].score = va[i].score;
+			}
+			cache.store(probes, nVisuals * sizeof(VisProbe));
+		}
+		free(probes);  probes = NULL;
+
 		int nDepths, *depths = XListDepths(dpy, screen, &nDepths);
 		if(!depths) THROW("Memory allocation error");
 		for(int i = 0; i < nDepths; i++)
@@ -314,6 +380,7 @@ static bool buildVisAttribTable(Display *dpy, int screen)
 	catch(...)
 	{
 		if(visuals) _XFree(visuals);
+		free(probes);
 		free(va);
 		return false;
 	}
@@ -475,27 +542,52 @@ static void buildCfgAttribTable(Display *dpy, int screen)
 			int bpcs[] = { defaultDepth == 30 ? 10 : 8, defaultDepth == 30 ? 8 : 0 };
 			int maxSamples = 0, maxPBWidth = 32768, maxPBHeight = 32768, nsamps = 1;
 
-			if(!_eglBindAPI(EGL_OPENGL_API))
-				THROW("Could not enable OpenGL API");
-			if(!(ctx = _eglCreateContext(EDPY, (EGLConfig)0, NULL, NULL)))
-				THROW("Could not create temporary EGL context");
+			// Creating a temporary context is expensive, so the limits can be
+			// cached on disk.  The key identifies the EGL device and driver.
+			server::AttribCache cache("EGL device limits");
+			if(cache.isEnabled())
 			{
-				backend::TempContextEGL tc(ctx);
-
-				_glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
-				if(maxSamples > 0)
+				const char *vendor = _eglQueryString(EDPY, EGL_VENDOR),
+					*version = _eglQueryString(EDPY, EGL_VERSION),
+					*extensions = _eglQueryString(EDPY, EGL_EXTENSIONS);
+				cache.addKey("%s\n%s\n%s\n%s\n", fconfig.localdpystring,
+					vendor ? vendor : "", version ? version : "",
+					extensions ? extensions : "");
+			}
+			int limits[3];
+			if(cache.load(limits, sizeof(limits)))
+			{
+				maxSamples = limits[0];  maxPBWidth = limits[1];
+				maxPBHeight = limits[2];
+			}
+			else
+			{
+				if(!_eglBindAPI(EGL_OPENGL_API))
+					THROW("Could not enable OpenGL API");
+				if(!(ctx = _eglCreateContext(EDPY, (EGLConfig)0, NULL, NULL)))
+					THROW("Could not create temporary EGL context");
 				{
-					int temp = maxSamples;
-					while(temp >>= 1) nsamps++;
+					backend::TempContextEGL tc(ctx);
+
+					_glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+
+					GLint dims[2] = { -1, -1 };
+					_glGetIntegerv(GL_MAX_VIEWPORT_DIMS, dims);
+					if(dims[0] > 0) maxPBWidth = max(dims[0], maxPBWidth);
+					if(dims[1] > 0) maxPBHeight = max(dims[1], maxPBHeight);
 				}
-				else maxSamples = 0;
+				_eglDestroyContext(EDPY, ctx);  ctx = 0;
 
-				GLint dims[2] = { -1, -1 };
-				_glGetIntegerv(GL_MAX_VIEWPORT_DIMS, dims);
-				if(dims[0] > 0) maxPBWidth = max(dims[0], maxPBWidth);
-				if(dims[1] > 0) maxPBHeight = max(dims[1], maxPBHeight);
+				limits[0] = maxSamples;  limits[1] = maxPBWidth;
+				limits[2] = maxPBHeight;
+				cache.store(limits, sizeof(limits));
+			}
+			if(maxSamples > 0)
+			{
+				int temp = maxSamples;
+				while(temp >>= 1) nsamps++;
 			}
-			_eglDestroyContext(EDPY, ctx);  ctx = 0;
+			else maxSamples = 0;
 
 			nConfigs =
 				2 *       // visual classes
@@ -861,8 +953,8 @@ static int compareFBConfigNoDepth(const void *arg1, const void *arg2)
 		if(var != (int)GLX_DONT_CARE && (var < min || var > max)) goto bailout; \
 		break;
 
-VGLFBConfig *chooseFBConfig(Display *dpy, int screen, const int attribs[],
-	int &nElements)
+static VGLFBConfig *chooseFBConfigUncached(Display *dpy, int screen,
+	const int attribs[], int &nElements)
 {
 	GLXFBConfig *glxConfigs = NULL;
 	VGLFBConfig *configs = NULL;
@@ -1025,6 +1117,212 @@ VGLFBConfig *chooseFBConfig(Display *dpy, int screen, const int attribs[],
 }
 
 
+
+// Some toolkits call glXChooseFBConfig() or glXChooseVisual() hundreds of
+// times with the same attribute list during startup and whenever a new widget
+// is created.  The result of chooseFBConfig() depends only on the attribute
+// list and the FB config attribute table for the screen, so we cache the
+// results for each screen, keyed by the attribute list with its attribute/value
+// pairs sorted by attribute name.  (The sort is stable, so if an attribute is
+// specified more than once, the last value still wins.)  The configs in a
+// cached result point into the FB config attribute table, so the cache is
+// flushed if the table changes.
+
+#define FBCCACHE_BUCKETS  64
+#define FBCCACHE_MAX_ENTRIES  1024
+
+typedef struct _FBCCacheEntry
+{
+	unsigned int hash;
+	int nAttribs, *attribs;
+	int nConfigs;
+	VGLFBConfig *configs;  // NULL if chooseFBConfig() returned NULL
+	struct _FBCCacheEntry *next;
+} FBCCacheEntry;
+
+typedef struct
+{
+	struct _VGLFBConfig *ca;
+	int nEntries;
+	FBCCacheEntry *buckets[FBCCACHE_BUCKETS];
+} FBCCache;
+
+
+static void flushFBCCache(FBCCache *cache)
+{
+	for(int i = 0; i < FBCCACHE_BUCKETS; i++)
+	{
+		FBCCacheEntry *entry = cache->buckets[i];
+		while(entry)
+		{
+			FBCCacheEntry *next = entry->next;
+			free(entry->attribs);
+			free(entry->configs);
+			free(entry);
+			entry = next;
+		}
+		cache->buckets[i] = NULL;
+	}
+	cache->nEntries = 0;
+}
+
+
+static int deleteFBCCache(XExtData *extData)
+{
+	if(extData && extData->private_data)
+	{
+		flushFBCCache((FBCCache *)extData->private_data);
+		free(extData->private_data);
+		extData->private_data = NULL;
+	}
+	return 0;
+}
+
+
+// The caller must hold the display mutex.
+static FBCCache *getFBCCache(Display *dpy, int screen)
+{
+	XEDataObject obj;
+	XExtData *extData;
+	FBCCache *cache;
+
+	obj.screen = XScreenOfDisplay(dpy, screen);
+	int minExtensionNumber =
+		XFindOnExtensionList(XEHeadOfExtensionList(obj), 0) ? 0 : 1;
+	extData = XFindOnExtensionList(XEHeadOfExtensionList(obj),
+		minExtensionNumber + 4);
+	if(extData) return (FBCCache *)extData->private_data;
+
+	if(!(cache = (FBCCache *)calloc(1, sizeof(FBCCache))))
+		return NULL;
+	if(!(extData = (XExtData *)calloc(1, sizeof(XExtData))))
+	{
+		free(cache);  return NULL;
+	}
+	extData->private_data = (XPointer)cache;
+	extData->number = 5;
+	extData->free_private = deleteFBCCache;
+	XAddToExtensionList(XEHeadOfExtensionList(obj), extData);
+	return cache;
+}
+
+
+// Copy the attribute/value pairs into key, sort them by attribute name, and
+// return the number of integers in the key
+static int normalizeAttribs(const int attribs[], int key[MAX_ATTRIBS])
+{
+	int nAttribs = 0;
+
+	for(int i = 0; attribs[i] != None && i < MAX_ATTRIBS; i += 2)
+	{
+		int attrib = attribs[i], value = attribs[i + 1], j = nAttribs;
+		while(j > 0 && key[j - 2] > attrib)
+		{
+			key[j] = key[j - 2];  key[j + 1] = key[j - 1];
+			j -= 2;
+		}
+		key[j] = attrib;  key[j + 1] = value;
+		nAttribs += 2;
+	}
+	return nAttribs;
+}
+
+
+static unsigned int hashAttribs(const int key[], int nAttribs)
+{
+	unsigned int hash = 2166136261U;  // FNV-1a
+
+	for(int i = 0; i < nAttribs; i++)
+	{
+		hash ^= (unsigned int)key[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+
+static VGLFBConfig *copyConfigs(const VGLFBConfig *configs, int nConfigs)
+{
+	VGLFBConfig *copy =
+		(VGLFBConfig *)malloc(max(nConfigs, 1) * sizeof(VGLFBConfig));
+	if(copy && nConfigs > 0)
+		memcpy(copy, configs, nConfigs * sizeof(VGLFBConfig));
+	return copy;
+}
+
+
+VGLFBConfig *chooseFBConfig(Display *dpy, int screen, const int attribs[],
+	int &nElements)
+{
+	int key[MAX_ATTRIBS];
+	VGLFBConfig *configs = NULL;
+
+	if(!dpy || screen < 0) return NULL;
+	if(!attribs) return chooseFBConfigUncached(dpy, screen, attribs, nElements);
+
+	buildCfgAttribTable(dpy, screen);
+	GET_CA()
+
+	int nAttribs = normalizeAttribs(attribs, key);
+	unsigned int hash = hashAttribs(key, nAttribs);
+	FBCCacheEntry **bucket;
+	FBCCache *cache;
+
+	{
+		CriticalSection::SafeLock l(faker::getDisplayCS(dpy));
+
+		if(!(cache = getFBCCache(dpy, screen)))
+			return chooseFBConfigUncached(dpy, screen, attribs, nElements);
+		if(cache->ca != ca)
+		{
+			flushFBCCache(cache);
+			cache->ca = ca;
+		}
+		bucket = &cache->buckets[hash % FBCCACHE_BUCKETS];
+		for(FBCCacheEntry *entry = *bucket; entry; entry = entry->next)
+		{
+			if(entry->hash != hash || entry->nAttribs != nAttribs
+				|| memcmp(entry->attribs, key, nAttribs * sizeof(int)))
+				continue;
+			if(!entry->configs)
+			{
+				nElements = 0;  return NULL;
+			}
+			if(!(configs = copyConfigs(entry->configs, entry->nConfigs)))
+				break;
+			nElements = entry->nConfigs;
+			return configs;
+		}
+	}
+
+	// The uncached function may make a round trip to the 3D X server, so the
+	// display mutex is not held while it is running.  If two threads miss at
+	// the same time, then both will insert the same result, which is harmless.
+	configs = chooseFBConfigUncached(dpy, screen, attribs, nElements);
+
+	CriticalSection::SafeLock l(faker::getDisplayCS(dpy));
+
+	if(cache->ca != ca || cache->nEntries >= FBCCACHE_MAX_ENTRIES)
+		return configs;
+	FBCCacheEntry *entry = (FBCCacheEntry *)calloc(1, sizeof(FBCCacheEntry));
+	if(!entry) return configs;
+	if(!(entry->attribs = (int *)malloc(max(nAttribs, 1) * sizeof(int)))
+		|| (configs && !(entry->configs = copyConfigs(configs, nElements))))
+	{
+		free(entry->attribs);  free(entry);
+		return configs;
+	}
+	memcpy(entry->attribs, key, nAttribs * sizeof(int));
+	entry->hash = hash;
+	entry->nAttribs = nAttribs;
+	if(configs) entry->nConfigs = nElements;
+	entry->next = *bucket;
+	*bucket = entry;
+	cache->nEntries++;
+	return configs;
+}
+
+
 VGLFBConfig getDefaultFBConfig(Display *dpy, int screen, VisualID vid)
 {
 	if(!buildVisAttribTable(dpy, screen)) return NULL;
@@ -0,0 +1,272 @@
+// Copyright (C)2023 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+// This program tests the generic hash table template and measures lookup
+// performance as the number of entries grows.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Hash.h"
+#include "Timer.h"
+#include "vglutil.h"
+
+using namespace util;
+
+
+#define BENCHTIME  0.25
+
+#define TRY(f) \
+{ \
+	try \
+	{ \
+		f; \
+	} \
+	catch(std::exception &e) \
+	{ \
+		fprintf(stderr, "%s\n", e.what());  retval = -1; \
+	} \
+}
+
+#define CHECK(expr) \
+{ \
+	if(!(expr)) THROW("Check failed: " #expr); \
+}
+
+
+// Test value that carries a secondary ID, similar to how VirtualPixmap
+// carries a 3D pixmap ID
+typedef struct
+{
+	unsigned long alias;
+} TestValue;
+
+
+#define HASH  faker::Hash<char *, unsigned long, TestValue *>
+
+// Mirrors the matching semantics of PixmapHash:  entries can be found by
+// (display string, ID), by (display string, alias), or by (NULL, alias).
+
+class TestHash : public HASH
+{
+	public:
+
+		TestHash(bool linear_) : linear(linear_) {}
+
+		~TestHash(void) { HASH::kill(); }
+
+		int add(const char *dpystring, unsigned long id, TestValue *value,
+			bool useRef = false)
+		{
+			char *key1 = strdup(dpystring);
+			int retval = HASH::add(key1, id, value, useRef);
+			if(!retval) free(key1);
+			return retval;
+		}
+
+		TestValue *find(const char *dpystring, unsigned long id)
+		{
+			return HASH::find((char *)dpystring, id);
+		}
+
+		void remove(const char *dpystring, unsigned long id, bool useRef = false)
+		{
+			HASH::remove((char *)dpystring, id, useRef);
+		}
+
+		int getCount(void) { return HASH::getCount(); }
+
+	private:
+
+		void detach(HashEntry *entry)
+		{
+			if(entry)
+			{
+				free(entry->key1);
+				delete entry->value;
+			}
+		}
+
+		bool compare(char *key1, unsigned long key2, HashEntry *entry)
+		{
+			TestValue *value = entry->value;
+			return (
+				(key1 && !strcasecmp(key1, entry->key1)
+					&& (key2 == entry->key2 || (value && key2 == value->alias)))
+				|| (key1 == NULL && value && key2 == value->alias)
+			);
+		}
+
+		size_t hashKey(char *key1, unsigned long key2)
+		{
+			return mix((size_t)key2);
+		}
+
+		bool getAlias(HashEntry *entry, unsigned long &alias)
+		{
+			if(!entry->value) return false;
+			alias = entry->value->alias;
+			return true;
+		}
+
+		// Emulate the old linked-list implementation, for comparison purposes
+		bool needScan(char *key1, unsigned long key2) { return linear; }
+
+		bool linear;
+};
+
+#undef HASH
+
+
+static TestValue *newValue(unsigned long alias)
+{
+	TestValue *value = new TestValue;
+	value->alias = alias;
+	return value;
+}
+
+
+void semanticsTest(void)
+{
+	TestHash hash(false);
+	TestValue *value1 = newValue(0x1001), *value2 = newValue(0x2001);
+
+	printf("Semantics test: ");
+
+	CHECK(hash.add(":0", 0x100, value1) == 1);
+	CHECK(hash.add(":0", 0x200, value2) == 1);
+	CHECK(hash.add(":0", 0x100, NULL) == 0);
+	CHECK(hash.getCount() == 2);
+
+	// Direct, case-insensitive, alias, and reverse lookups
+	CHECK(hash.find(":0", 0x100) == value1);
+	CHECK(hash.find(":0", 0x200) == value2);
+	CHECK(hash.find(":0", 0x1001) == value1);
+	CHECK(hash.find(NULL, 0x2001) == value2);
+	CHECK(hash.find(":1", 0x100) == NULL);
+	CHECK(hash.find(":0", 0x300) == NULL);
+	CHECK(hash.find(NULL, 0x100) == NULL);
+
+	// Replacing the value must re-index the alias
+	TestValue *value3 = newValue(0x3001);
+	CHECK(hash.add(":0", 0x100, value3) == 0);
+	CHECK(hash.find(NULL, 0x3001) == value3);
+	CHECK(hash.find(NULL, 0x1001) == NULL);
+	delete value1;
+
+	// Removal by alias
+	hash.remove(":0", 0x2001);
+	CHECK(hash.getCount() == 1);
+	CHECK(hash.find(":0", 0x200) == NULL);
+	CHECK(hash.find(NULL, 0x2001) == NULL);
+
+	// Reference counting
+	CHECK(hash.add(":0", 0x400, newValue(0x4001), true) == 1);
+	CHECK(hash.add(":0", 0x400, NULL, true) == 0);
+	hash.remove(":0", 0x400, true);
+	CHECK(hash.find(":0", 0x400) != NULL);
+	hash.remove(":0", 0x400, true);
+	CHECK(hash.find(":0", 0x400) == NULL);
+
+	// Growth and shrinkage across several rehashes
+	for(unsigned long i = 1; i <= 10000; i++)
+		hash.add(":0", i << 16, newValue((i << 16) | 1));
+	CHECK(hash.getCount() == 10001);
+	for(unsigned long i = 1; i <= 10000; i++)
+	{
+		CHECK(hash.find(":0", i << 16) != NULL);
+		CHECK(hash.find(NULL, (i << 16) | 1) != NULL);
+	}
+	for(unsigned long i = 1; i <= 10000; i += 2)
+		hash.remove(NULL, (i << 16) | 1);
+	CHECK(hash.getCount() == 5001);
+	for(unsigned long i = 1; i <= 10000; i++)
+		CHECK((hash.find(":0", i << 16) != NULL) == !(i & 1));
+	CHECK(hash.find(":0", 0x100) == value3);
+
+	hash.kill();
+	CHECK(hash.getCount() == 0);
+	CHECK(hash.find(":0", 0x100) == NULL);
+
+	printf("SUCCESS\n");
+}
+
+
+double benchLookup(TestHash &hash, int entries, bool hit)
+{
+	Timer timer;
+	double elapsed;
+	unsigned long iter = 0, n = 0;
+
+	timer.start();
+	do
+	{
+		for(int i = 0; i < 1000; i++, n++)
+		{
+			unsigned long id = ((unsigned long)(n % entries) + 1) << 16;
+			if(!hit) id |= 0x8000;
+			if((hash.find(":0", id) != NULL) != hit) THROW("Lookup failed");
+		}
+		iter += 1000;
+	} while((elapsed = timer.elapsed()) < BENCHTIME);
+
+	return elapsed / (double)iter * 1000000000.;
+}
+
+
+void benchmark(bool linear)
+{
+	int sizes[] = { 10, 100, 1000, 10000, 100000 };
+
+	printf("\n%s lookup performance (ns/lookup):\n",
+		linear ? "Linear scan" : "Hashed");
+	printf("Entries       Hit      Miss\n");
+	for(int s = 0; s < 5; s++)
+	{
+		// The linear scan is O(n), so don't wait forever for it.
+		if(linear && sizes[s] > 10000) break;
+
+		TestHash hash(linear);
+		for(int i = 1; i <= sizes[s]; i++)
+			hash.add(":0", (unsigned long)i << 16,
+				newValue(((unsigned long)i << 16) | 1));
+		double hitTime = benchLookup(hash, sizes[s], true);
+		double missTime = benchLookup(hash, sizes[s], false);
+		printf("%-7d %9.1f %9.1f\n", sizes[s], hitTime, missTime);
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	int retval = 0;
+	bool bench = true;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(!stricmp(argv[i], "-nobench")) bench = false;
+		else
+		{
+			fprintf(stderr, "\nUSAGE: %s [-nobench]\n\n", argv[0]);
+			fprintf(stderr, "-nobench = Test hash table semantics only\n\n");
+			exit(1);
+		}
+	}
+
+	TRY(semanticsTest());
+	if(bench && retval == 0)
+	{
+		TRY(benchmark(false));
+		TRY(benchmark(true));
+	}
+
+	return retval;
+}
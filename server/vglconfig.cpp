@@ -1,5 +1,5 @@
 // Copyright (C)2007 Sun Microsystems, Inc.
-// Copyright (C)2009, 2012, 2014, 2017-2019, 2021 D. R. Commander
+// Copyright (C)2009, 2012, 2014, 2017-2019, 2021, 2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -147,7 +147,8 @@ void setIF(void)
 	if(!ifButton) return;
 	ifButton->value(fconfig.interframe);
 	if(strlen(fconfig.transport) > 0 || fconfig.compress == RRCOMP_JPEG
-		|| fconfig.compress == RRCOMP_RGB)
+		|| fconfig.compress == RRCOMP_RGB
+		|| fconfig.compress == RRCOMP_LOSSLESS)
 		ifButton->activate();
 	else ifButton->deactivate();
 }
@@ -272,6 +273,7 @@ Fl_Menu_Item compMenu[] =
 	{ "RGB (VGL Transport)", 0, compCB, (void *)RRCOMP_RGB },
 	{ "YUV (XV Transport)", 0, compCB, (void *)RRCOMP_XV },
 	{ "YUV (VGL Transport)", 0, compCB, (void *)RRCOMP_YUV },
+	{ "Lossless (VGL Transport)", 0, compCB, (void *)RRCOMP_LOSSLESS },
 	{ 0, 0, 0, 0 }
 };
 
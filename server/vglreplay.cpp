@@ -0,0 +1,632 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+// This program replays frames that were captured using VGL_CAPTURE through
+// the VGL Transport or the X11 Transport and reports the throughput and
+// latency.  By default, the frames are sent to a built-in headless VirtualGL
+// Client over the loopback interface, so no X display is required, and each
+// frame is sent only once the previous frame has been processed, so the
+// results are reproducible.
+
+#include "VGLTrans.h"
+#include "X11Trans.h"
+#include "FrameCapture.h"
+#include "Socket.h"
+#include "vglutil.h"
+#include "Timer.h"
+#include "fakerconfig.h"
+
+using namespace util;
+using namespace common;
+using namespace server;
+
+
+extern "C" void _vgl_disableFaker(void) {}
+extern "C" void _vgl_enableFaker(void) {}
+
+
+#define ENDIANIZE(h) \
+{ \
+	if(!LittleEndian()) \
+	{ \
+		h.size = BYTESWAP(h.size); \
+		h.winid = BYTESWAP(h.winid); \
+		h.framew = BYTESWAP16(h.framew); \
+		h.frameh = BYTESWAP16(h.frameh); \
+		h.width = BYTESWAP16(h.width); \
+		h.height = BYTESWAP16(h.height); \
+		h.x = BYTESWAP16(h.x); \
+		h.y = BYTESWAP16(h.y); \
+		h.dpynum = BYTESWAP16(h.dpynum); \
+		h.frameid = BYTESWAP(h.frameid); \
+	} \
+}
+
+
+// Time at which each frame was sent, indexed by frame ID
+double *sendTimes = NULL;
+CriticalSection sendMutex;
+
+
+// A headless implementation of the receiving end of the VGL Transport.  Each
+// connection is serviced by its own thread, which decompresses the tiles into
+// memory rather than drawing them and records the time at which each frame
+// was completely received.
+
+class LoopbackClient : public Runnable
+{
+	public:
+
+		LoopbackClient(int maxFrames) : listenSocket(NULL), thread(NULL),
+			deadYet(false), nConn(0), frames(0), bytes(0), decompTime(0.),
+			decompPixels(0.), latencies(NULL)
+		{
+			latencies = new double[maxFrames + 1];
+			memset(latencies, 0, sizeof(double) * (maxFrames + 1));
+			memset(conns, 0, sizeof(Connection *) * MAXCONN);
+		}
+
+		~LoopbackClient(void)
+		{
+			deadYet = true;
+			if(listenSocket) listenSocket->close();
+			if(thread) { thread->stop();  delete thread;  thread = NULL; }
+			for(int i = 0; i < nConn; i++) delete conns[i];
+			delete listenSocket;  listenSocket = NULL;
+			delete [] latencies;
+		}
+
+		unsigned short listen(void)
+		{
+			listenSocket = new Socket(false);
+			unsigned short port = listenSocket->listen(0);
+			thread = new Thread(this);
+			thread->start();
+			return port;
+		}
+
+		// Returns true if the frame with the specified ID has been received
+		bool isReceived(unsigned int frameID)
+		{
+			CriticalSection::SafeLock l(mutex);
+			return latencies[frameID] > 0.;
+		}
+
+		void run(void)
+		{
+			while(!deadYet)
+			{
+				Socket *socket = NULL;
+				try
+				{
+					socket = listenSocket->accept();
+				}
+				catch(...)
+				{
+					if(deadYet) break;
+					throw;
+				}
+				if(deadYet || nConn >= MAXCONN) { delete socket;  break; }
+				conns[nConn++] = new Connection(socket, this);
+			}
+		}
+
+		static const int MAXCONN = 64;
+		Socket *listenSocket;
+		Thread *thread;
+		bool deadYet;
+
+		class Connection : public Runnable
+		{
+			public:
+
+				Connection(Socket *socket_, LoopbackClient *parent_) :
+					socket(socket_), parent(parent_), thread(NULL), tjhnd(NULL)
+				{
+					thread = new Thread(this);
+					thread->start();
+				}
+
+				~Connection(void)
+				{
+					if(socket) socket->close();
+					if(thread) { thread->stop();  delete thread;  thread = NULL; }
+					delete socket;  socket = NULL;
+					if(tjhnd) tjDestroy(tjhnd);
+				}
+
+				void run(void);
+
+			private:
+
+				Socket *socket;
+				LoopbackClient *parent;
+				Thread *thread;
+				tjhandle tjhnd;
+		};
+
+		Connection *conns[MAXCONN];  int nConn;
+		CriticalSection mutex;
+		long frames, bytes;
+		double decompTime, decompPixels;
+		double *latencies;
+};
+
+
+void LoopbackClient::Connection::run(void)
+{
+	rrframeheader h;  rrframeheader_v1 h1;  rrversion v;
+	CompressedFrame cf;  Frame fb;
+	Timer timer;
+
+	try
+	{
+		// Respond to the server's version probe
+		socket->recv((char *)&h1, sizeof_rrframeheader_v1);
+		memcpy(v.id, "VGL", 3);
+		v.major = RR_MAJOR_VERSION;  v.minor = RR_MINOR_VERSION;
+		socket->send((char *)&v, sizeof_rrversion);
+		socket->recv((char *)&v, sizeof_rrversion);
+		if(strncmp(v.id, "VGL", 3) || v.major != RR_MAJOR_VERSION
+			|| v.minor != RR_MINOR_VERSION)
+			THROW("Error reading server version");
+
+		while(true)
+		{
+			socket->recv((char *)&h, sizeof_rrframeheader);
+			ENDIANIZE(h);
+			if(h.flags == RR_EOF || h.flags == RR_EOF_ACK)
+			{
+				double now = timer.time(), sendTime;
+				{
+					CriticalSection::SafeLock l(sendMutex);
+					sendTime = sendTimes[h.frameid];
+				}
+				{
+					CriticalSection::SafeLock l(parent->mutex);
+					parent->latencies[h.frameid] = max(now - sendTime, 1e-9);
+					parent->frames++;
+				}
+				if(h.flags == RR_EOF_ACK)
+				{
+					char ack = 1;
+					socket->send(&ack, 1);
+				}
+				continue;
+			}
+
+			cf.init(h, h.flags);
+			socket->recv((char *)(h.flags == RR_RIGHT ? cf.rbits : cf.bits),
+				h.size);
+			if(h.flags == RR_RIGHT) continue;
+
+			if(fb.hdr.framew != h.framew || fb.hdr.frameh != h.frameh)
+			{
+				rrframeheader fh = h;
+				fh.x = fh.y = 0;  fh.width = fh.framew;  fh.height = fh.frameh;
+				fh.size = fh.framew * fh.frameh * 3;  fh.flags = 0;
+				fb.init(fh, PF_RGB, 0);
+			}
+			double start = timer.time();
+			if(h.compress == RRCOMP_RGB)
+				fb.decompressRGB(cf, h.width, h.height, false);
+			else if(h.compress == RRCOMP_LOSSLESS)
+				fb.decompressLossless(cf, h.width, h.height, false);
+			else if(h.compress == RRCOMP_JPEG)
+			{
+				if(!tjhnd && (tjhnd = tjInitDecompress()) == NULL)
+					THROW(tjGetErrorStr());
+				fb.decompressJPEG(cf, tjhnd, h.width, h.height, false);
+			}
+			else THROW("Unsupported compression type");
+			double elapsed = timer.time() - start;
+
+			CriticalSection::SafeLock l(parent->mutex);
+			parent->bytes += h.size;
+			parent->decompTime += elapsed;
+			parent->decompPixels += (double)h.width * (double)h.height;
+		}
+	}
+	catch(std::exception &e)
+	{
+		// The server closes the connection once all frames have been sent.
+		if(!parent->deadYet && !strstr(e.what(), "Incomplete receive"))
+			fprintf(stderr, "Loopback client: %s\n", e.what());
+	}
+}
+
+
+// A window from the capture file, along with the transport that is used to
+// replay its frames
+
+typedef struct
+{
+	unsigned int winid;
+	Window win;
+	VGLTrans *vglconn;
+	X11Trans *x11trans;
+	unsigned int lastFrameID;
+} Target;
+
+
+void usage(char **argv)
+{
+	fprintf(stderr, "\nUSAGE: %s <capture file> [options]\n\n", argv[0]);
+	fprintf(stderr, "Options:\n");
+	fprintf(stderr, "-client <hostname or IP> = Send the frames to the VirtualGL Client running on\n");
+	fprintf(stderr, "                           the specified machine (requires an X display), or 0\n");
+	fprintf(stderr, "                           to compress the frames without sending them\n");
+	fprintf(stderr, "                           (default: send the frames to a built-in headless\n");
+	fprintf(stderr, "                           client over the loopback interface)\n");
+	fprintf(stderr, "-port <p> = TCP port on which the VirtualGL Client is listening\n");
+	fprintf(stderr, "            (default: %d)\n",
+		fconfig.port < 0 ? RR_DEFAULTPORT : fconfig.port);
+	fprintf(stderr, "-x11 = Replay the frames through the X11 Transport (requires an X display)\n");
+	fprintf(stderr, "-samp <s> = JPEG chrominance subsampling factor: 0 (gray), 1, 2, or 4\n");
+	fprintf(stderr, "            (default: %d)\n", fconfig.subsamp);
+	fprintf(stderr, "-qual <q> = JPEG quality, 1 <= <q> <= 100 (default: %d)\n",
+		fconfig.qual);
+	fprintf(stderr, "-tilesize <n> = Width/height of each multithreaded compression/interframe\n");
+	fprintf(stderr, "                comparison tile (default: %d x %d pixels)\n",
+		fconfig.tilesize, fconfig.tilesize);
+	fprintf(stderr, "-rgb = Use RGB (uncompressed) encoding (default is JPEG)\n");
+	fprintf(stderr, "-lossless = Use lossless compression (default is JPEG)\n");
+	fprintf(stderr, "-np <n> = Number of threads to use for compression (default: %d)\n",
+		fconfig.np);
+	fprintf(stderr, "-realtime = Replay the frames at the rate at which they were rendered, and\n");
+	fprintf(stderr, "            spoil frames if the transport cannot keep up (default: replay\n");
+	fprintf(stderr, "            the frames as fast as possible without spoiling them)\n");
+	fprintf(stderr, "-loop <n> = Replay the capture <n> times (default: 1)\n\n");
+	exit(1);
+}
+
+
+// Read the next frame record from the capture file.  Returns false at the end
+// of the file.
+
+bool readRecord(FILE *file, rrcaptureheader &h, CompressedFrame *cf)
+{
+	size_t n = fread(&h, 1, sizeof_rrcaptureheader, file);
+	if(n == 0) return false;
+	if(n != sizeof_rrcaptureheader) THROW("Capture file is truncated");
+	if(!LittleEndian())
+	{
+		h.sec = BYTESWAP(h.sec);  h.usec = BYTESWAP(h.usec);
+		h.winid = BYTESWAP(h.winid);
+		h.width = BYTESWAP16(h.width);  h.height = BYTESWAP16(h.height);
+		h.size = BYTESWAP(h.size);
+	}
+	if(h.width < 1 || h.height < 1 || h.size < 1
+		|| h.pixelFormat >= PIXELFORMATS)
+		THROW("Capture file is corrupt");
+
+	if(!cf)
+	{
+		if(fseek(file, h.size, SEEK_CUR) != 0) THROW("Capture file is truncated");
+		return true;
+	}
+	rrframeheader fh;
+	memset(&fh, 0, sizeof(rrframeheader));
+	fh.framew = fh.width = h.width;  fh.frameh = fh.height = h.height;
+	fh.compress = RRCOMP_LOSSLESS;  fh.qual = 100;  fh.subsamp = 1;
+	cf->init(fh, 0);
+	if(fread(cf->bits, h.size, 1, file) != 1)
+		THROW("Capture file is truncated");
+	cf->hdr.size = h.size;
+	return true;
+}
+
+
+// Copy the overlapping region of two top-down frames
+void copyFrame(Frame &src, Frame *dst)
+{
+	int width = min(src.hdr.width, dst->hdr.width);
+	int height = min(src.hdr.height, dst->hdr.height);
+
+	src.pf->convert(src.bits, width, src.pitch, height, dst->bits, dst->pitch,
+		dst->pf);
+}
+
+
+int compareLatency(const void *arg1, const void *arg2)
+{
+	double l1 = *(double *)arg1, l2 = *(double *)arg2;
+	return l1 < l2 ? -1 : (l1 > l2 ? 1 : 0);
+}
+
+
+int main(int argc, char **argv)
+{
+	Timer timer;
+	FILE *file = NULL;  Display *dpy = NULL;
+	LoopbackClient *client = NULL;
+	Target *targets = NULL;  int nTargets = 0;
+	int i, retval = 0, loops = 1;
+	bool localtest = false, loopback = true, x11 = false, realtime = false;
+
+	try
+	{
+		fconfig_setcompress(fconfig, RRCOMP_JPEG);
+
+		if(argc < 2) usage(argv);
+		if(!stricmp(argv[1], "-h") || !strcmp(argv[1], "-?")) usage(argv);
+
+		for(i = 2; i < argc; i++)
+		{
+			if(!stricmp(argv[i], "-h") || !strcmp(argv[i], "-?")) usage(argv);
+			else if(!stricmp(argv[i], "-client") && i < argc - 1)
+			{
+				strncpy(fconfig.client, argv[++i], MAXSTR - 1);
+				loopback = false;
+				if(!stricmp(fconfig.client, "0"))
+				{
+					localtest = true;  fconfig.client[0] = 0;
+				}
+			}
+			else if(!stricmp(argv[i], "-port") && i < argc - 1)
+				fconfig.port = atoi(argv[++i]);
+			else if(!stricmp(argv[i], "-x11")) x11 = true;
+			else if(!stricmp(argv[i], "-samp") && i < argc - 1)
+				fconfig.subsamp = atoi(argv[++i]);
+			else if(!stricmp(argv[i], "-qual") && i < argc - 1)
+				fconfig.qual = atoi(argv[++i]);
+			else if(!stricmp(argv[i], "-tilesize") && i < argc - 1)
+				fconfig.tilesize = atoi(argv[++i]);
+			else if(!stricmp(argv[i], "-np") && i < argc - 1)
+				fconfig.np = atoi(argv[++i]);
+			else if(!stricmp(argv[i], "-rgb"))
+				fconfig_setcompress(fconfig, RRCOMP_RGB);
+			else if(!stricmp(argv[i], "-lossless"))
+				fconfig_setcompress(fconfig, RRCOMP_LOSSLESS);
+			else if(!stricmp(argv[i], "-realtime")) realtime = true;
+			else if(!stricmp(argv[i], "-loop") && i < argc - 1)
+			{
+				loops = atoi(argv[++i]);
+				if(loops < 1) usage(argv);
+			}
+			else usage(argv);
+		}
+		if(x11) loopback = localtest = false;
+
+		// Scan the capture file
+		char signature[sizeof_VGLCAP_SIGNATURE];
+		if((file = fopen(argv[1], "rb")) == NULL)
+			THROW("Could not open capture file");
+		if(fread(signature, sizeof_VGLCAP_SIGNATURE, 1, file) != 1
+			|| strncmp(signature, VGLCAP_SIGNATURE, sizeof_VGLCAP_SIGNATURE))
+			THROW("Not a VirtualGL capture file");
+		if(fseek(file, 0, SEEK_END) != 0) THROW("Could not seek capture file");
+		long fileSize = ftell(file);
+		if(fseek(file, sizeof_VGLCAP_SIGNATURE, SEEK_SET) != 0)
+			THROW("Could not seek capture file");
+		rrcaptureheader ch;  int records = 0;
+		double duration = 0., pixels = 0., encodedBytes = 0.;
+		while(readRecord(file, ch, NULL))
+		{
+			if(ftell(file) > fileSize) THROW("Capture file is truncated");
+			records++;
+			duration = (double)ch.sec + (double)ch.usec / 1000000.;
+			pixels += (double)ch.width * (double)ch.height;
+			encodedBytes += (double)ch.size;
+		}
+		if(records < 1) THROW("Capture file contains no frames");
+		printf("Capture: %d frames, %f seconds, %f Megapixels/frame, %.1f:1 lossless compression\n",
+			records, duration, pixels / 1000000. / (double)records,
+			pixels * 3. / encodedBytes);
+
+		int maxFrames = records * loops;
+		sendTimes = new double[maxFrames + 1];
+		memset(sendTimes, 0, sizeof(double) * (maxFrames + 1));
+
+		if(x11 || (!loopback && !localtest))
+		{
+			if(!XInitThreads()) THROW("Could not initialize X threads");
+			if((dpy = XOpenDisplay(0)) == NULL) THROW("Could not open display");
+			if(!x11)
+			{
+				if(strlen(fconfig.client) == 0)
+					strncpy(fconfig.client, DisplayString(dpy), MAXSTR - 1);
+				fconfig_setdefaultsfromdpy(dpy);
+			}
+		}
+		unsigned short port = fconfig.port < 0 ? RR_DEFAULTPORT : fconfig.port;
+		if(loopback)
+		{
+			client = new LoopbackClient(maxFrames);
+			port = client->listen();
+			strncpy(fconfig.client, "127.0.0.1", MAXSTR - 1);
+		}
+
+		printf("Replaying through %s ",
+			x11 ? "X11 Transport" : "VGL Transport");
+		if(x11) printf("\n");
+		else if(loopback) printf("(loopback client)\n");
+		else if(localtest) printf("(compression only)\n");
+		else printf("(client %s)\n", fconfig.client);
+
+		CompressedFrame cf;  Frame src;
+		unsigned int frameID = 0;
+		int sent = 0, spoiled = 0;
+		double sentPixels = 0.;
+		timer.start();
+
+		for(int loop = 0; loop < loops; loop++)
+		{
+			if(fseek(file, sizeof_VGLCAP_SIGNATURE, SEEK_SET) != 0)
+				THROW("Could not rewind capture file");
+			double loopStart = timer.time();
+
+			while(readRecord(file, ch, &cf))
+			{
+				Target *t = NULL;
+				for(i = 0; i < nTargets; i++)
+					if(targets[i].winid == ch.winid) t = &targets[i];
+				if(!t)
+				{
+					Target *newTargets =
+						(Target *)realloc(targets, sizeof(Target) * (nTargets + 1));
+					if(!newTargets) THROW("Memory allocation error");
+					targets = newTargets;  t = &targets[nTargets++];
+					memset(t, 0, sizeof(Target));
+					t->winid = ch.winid;
+					if(dpy)
+					{
+						if((t->win = XCreateSimpleWindow(dpy, DefaultRootWindow(dpy), 0,
+							0, ch.width, ch.height, 0, WhitePixel(dpy, DefaultScreen(dpy)),
+							BlackPixel(dpy, DefaultScreen(dpy)))) == 0)
+							THROW("Could not create window");
+						ERRIFNOT(XMapRaised(dpy, t->win));
+						XSync(dpy, False);
+					}
+					if(x11) t->x11trans = new X11Trans();
+					else
+					{
+						t->vglconn = new VGLTrans();
+						if(localtest) t->vglconn->connect(NULL, 0);
+						else t->vglconn->connect(fconfig.client, port);
+					}
+				}
+
+				if(realtime)
+				{
+					double when = loopStart + (double)ch.sec +
+						(double)ch.usec / 1000000.;
+					long usec = (long)((when - timer.time()) * 1000000.);
+					if(usec > 0) usleep(usec);
+					if(t->x11trans ? !t->x11trans->isReady() :
+						!t->vglconn->isReady())
+					{
+						spoiled++;  continue;
+					}
+				}
+				else
+				{
+					if(t->x11trans) t->x11trans->synchronize();
+					else t->vglconn->synchronize();
+				}
+
+				// Decode the frame into a scratch buffer with the pixel format that
+				// the application used, then copy it into the transport's frame.
+				int pixelFormat = ch.pixelFormat;
+				if(pf_get(pixelFormat)->bpc != 8
+					|| fconfig.compress == RRCOMP_RGB)
+					pixelFormat = PF_RGB;
+				if(src.hdr.framew != ch.width || src.hdr.frameh != ch.height
+					|| src.pf->id != pixelFormat)
+				{
+					rrframeheader fh = cf.hdr;
+					fh.size = ch.width * ch.height * pf_get(pixelFormat)->size;
+					src.init(fh, pixelFormat, 0);
+				}
+				src.decompressLossless(cf, ch.width, ch.height, false);
+
+				unsigned int winid = dpy ? t->win : t->winid;
+				if(t->x11trans)
+				{
+					FBXFrame *f;
+					ERRIFNOT(f = t->x11trans->getFrame(dpy, t->win, ch.width,
+						ch.height));
+					copyFrame(src, f);
+					t->x11trans->sendFrame(f);
+				}
+				else
+				{
+					Frame *f;
+					ERRIFNOT(f = t->vglconn->getFrame(ch.width, ch.height,
+						pixelFormat, 0, false));
+					copyFrame(src, f);
+					f->hdr.qual = fconfig.qual;  f->hdr.subsamp = fconfig.subsamp;
+					f->hdr.winid = winid;  f->hdr.compress = fconfig.compress;
+					f->hdr.frameid = ++frameID;
+					{
+						CriticalSection::SafeLock l(sendMutex);
+						sendTimes[frameID] = timer.time();
+					}
+					t->lastFrameID = frameID;
+					t->vglconn->sendFrame(f);
+				}
+				sent++;
+				sentPixels += (double)ch.width * (double)ch.height;
+			}
+		}
+
+		// Wait for the transports to finish processing the last frame
+		for(i = 0; i < nTargets; i++)
+		{
+			if(targets[i].x11trans) targets[i].x11trans->synchronize();
+			else targets[i].vglconn->synchronize();
+		}
+		if(client)
+		{
+			for(i = 0; i < nTargets; i++)
+			{
+				Timer waitTimer;
+				waitTimer.start();
+				while(targets[i].lastFrameID > 0
+					&& !client->isReceived(targets[i].lastFrameID)
+					&& waitTimer.elapsed() < 5.)
+					usleep(1000);
+			}
+		}
+		if(dpy) XSync(dpy, False);
+		double elapsed = timer.elapsed();
+
+		printf("Frames sent:  %d", sent);
+		if(realtime) printf(" (%d spoiled)", spoiled);
+		printf("\nThroughput:   %f Megapixels/sec, %f frames/sec\n",
+			sentPixels / 1000000. / elapsed, (double)sent / elapsed);
+
+		if(client)
+		{
+			CriticalSection::SafeLock l(client->mutex);
+			int nLatencies = 0;
+			double *latencies = client->latencies;
+			for(i = 1; i <= maxFrames; i++)
+				if(latencies[i] > 0.) latencies[nLatencies++] = latencies[i];
+			printf("Received:     %ld frames, %f Mbits/sec", client->frames,
+				(double)client->bytes * 8. / 1000000. / elapsed);
+			if(client->bytes > 0)
+				printf(" (%.1f:1)", sentPixels * 3. / (double)client->bytes);
+			printf("\n");
+			if(client->decompTime > 0.)
+				printf("Decompress:   %f Megapixels/sec\n",
+					client->decompPixels / 1000000. / client->decompTime);
+			if(nLatencies > 0)
+			{
+				qsort(latencies, nLatencies, sizeof(double), compareLatency);
+				printf("Latency (ms): p50 = %.3f, p95 = %.3f, p99 = %.3f, max = %.3f\n",
+					latencies[(nLatencies - 1) * 50 / 100] * 1000.,
+					latencies[(nLatencies - 1) * 95 / 100] * 1000.,
+					latencies[(nLatencies - 1) * 99 / 100] * 1000.,
+					latencies[nLatencies - 1] * 1000.);
+			}
+		}
+	}
+	catch(std::exception &e)
+	{
+		printf("%s--\n%s\n", GET_METHOD(e), e.what());
+		retval = -1;
+	}
+
+	for(i = 0; i < nTargets; i++)
+	{
+		delete targets[i].vglconn;
+		delete targets[i].x11trans;
+		if(targets[i].win) XDestroyWindow(dpy, targets[i].win);
+	}
+	free(targets);
+	delete client;
+	if(dpy) XCloseDisplay(dpy);
+	if(file) fclose(file);
+	delete [] sendTimes;
+	return retval;
+}
@@ -44,18 +44,108 @@ void usage(char **argv)
 	fprintf(stderr, "                comparison tile (default: %d x %d pixels)\n",
 		fconfig.tilesize, fconfig.tilesize);
 	fprintf(stderr, "-rgb = Use RGB (uncompressed) encoding (default is JPEG)\n");
-	fprintf(stderr, "-np <n> = Number of threads to use for compression (default: %d)\n\n",
+	fprintf(stderr, "-lossless = Use lossless compression (default is JPEG).  This also verifies\n");
+	fprintf(stderr, "            and benchmarks the lossless codec on its own.\n");
+	fprintf(stderr, "-np <n> = Number of threads to use for compression (default: %d)\n",
 		fconfig.np);
+	fprintf(stderr, "-scaling = Also measure full-frame throughput with 1, 2, 4, ... compression\n");
+	fprintf(stderr, "           threads, up to the number of CPU cores\n\n");
 	exit(1);
 }
 
 
+// Verify that the lossless codec reproduces the source image exactly, and
+// measure its compression ratio and single-threaded encoding/decoding
+// throughput
+void losslessTest(unsigned char *buf, int w, int h, int bgr)
+{
+	Frame src(false), dst;
+	CompressedFrame cf;
+	Timer timer;  double elapsed;
+	int iter = 0, pixelFormat = bgr ? PF_BGR : PF_RGB;
+
+	printf("\nTesting lossless codec (full frame) ...\n");
+
+	src.init(buf, w, w * 3, h, pixelFormat, 0);
+	src.hdr.compress = RRCOMP_LOSSLESS;
+	src.hdr.qual = fconfig.qual;  src.hdr.subsamp = fconfig.subsamp;
+	timer.start();
+	do
+	{
+		cf = src;  iter++;
+	} while((elapsed = timer.elapsed()) < 1.);
+	printf("Compression ratio: %f:1\n",
+		(double)w * (double)h * 3. / (double)cf.hdr.size);
+	printf("Encode: %f Megapixels/sec\n",
+		(double)w * (double)h * (double)iter / 1000000. / elapsed);
+
+	rrframeheader hdr = cf.hdr;
+	hdr.size = 0;
+	dst.init(hdr, pixelFormat, 0);
+	iter = 0;  timer.start();
+	do
+	{
+		dst.decompressLossless(cf, w, h, false);  iter++;
+	} while((elapsed = timer.elapsed()) < 1.);
+	printf("Decode: %f Megapixels/sec\n",
+		(double)w * (double)h * (double)iter / 1000000. / elapsed);
+
+	if(memcmp(dst.bits, buf, w * h * 3))
+		THROW("Decoded image does not match source image");
+}
+
+
+// Measure full-frame throughput with increasing numbers of compression threads
+void scalingTest(unsigned char *buf, unsigned char *buf2, int w, int h, int d,
+	int bgr, Window win, bool localtest)
+{
+	Timer timer;  double elapsed, baseline = 0.;
+	int maxnp = min(NumProcs(), MAXPROCS), npSave = fconfig.np;
+
+	printf("\nTesting full-frame send with 1-%d compression threads ...\n",
+		maxnp);
+	printf("Threads  Megapixels/sec  Speedup\n");
+	for(int np = 1; ; np *= 2)
+	{
+		if(np > maxnp) np = maxnp;
+		fconfig.np = np;
+
+		VGLTrans vglconn;
+		if(localtest) vglconn.connect(NULL, 0);
+		else vglconn.connect(fconfig.client, fconfig.port);
+
+		Frame *f;
+		int frames = 0, fill = 0;  timer.start();
+		do
+		{
+			vglconn.synchronize();
+			ERRIFNOT(f = vglconn.getFrame(w, h, bgr ? PF_BGR : PF_RGB, 0, false));
+			if(fill) memcpy(f->bits, buf, w * h * d);
+			else memcpy(f->bits, buf2, w * h * d);
+			f->hdr.qual = fconfig.qual;  f->hdr.subsamp = fconfig.subsamp;
+			f->hdr.winid = win;  f->hdr.compress = fconfig.compress;
+			fill = 1 - fill;
+			vglconn.sendFrame(f);
+			frames++;
+		} while((elapsed = timer.elapsed()) < 2.);
+		vglconn.synchronize();
+
+		double mpixels = (double)w * (double)h * (double)frames / 1000000. /
+			elapsed;
+		if(np == 1) baseline = mpixels;
+		printf("%-7d  %14f  %7.2f\n", np, mpixels, mpixels / baseline);
+		if(np == maxnp) break;
+	}
+	fconfig.np = npSave;
+}
+
+
 int main(int argc, char **argv)
 {
 	Timer timer;  double elapsed;
 	unsigned char *buf = NULL, *buf2 = NULL, *buf3 = NULL;
 	Display *dpy = NULL;  Window win = 0;
-	int i, retval = 0;  int bgr = LittleEndian();
+	int i, retval = 0;  int bgr = LittleEndian();  bool scaling = false;
 
 	try
 	{
@@ -98,6 +188,9 @@ int main(int argc, char **argv)
 			}
 			else if(!stricmp(argv[i], "-rgb"))
 				fconfig_setcompress(fconfig, RRCOMP_RGB);
+			else if(!stricmp(argv[i], "-lossless"))
+				fconfig_setcompress(fconfig, RRCOMP_LOSSLESS);
+			else if(!stricmp(argv[i], "-scaling")) scaling = true;
 			else usage(argv);
 		}
 		if(fconfig.compress == RRCOMP_RGB) bgr = 0;
@@ -115,6 +208,8 @@ int main(int argc, char **argv)
 			THROW(bmp_geterr());
 		printf("Source image: %d x %d x %d-bit\n", w, h, d * 8);
 
+		if(fconfig.compress == RRCOMP_LOSSLESS) losslessTest(buf, w, h, bgr);
+
 		if(!localtest)
 		{
 			if(!XInitThreads()) THROW("Could not initialize X threads");
@@ -134,7 +229,8 @@ int main(int argc, char **argv)
 		printf("Tile size = %d x %d pixels\n", fconfig.tilesize, fconfig.tilesize);
 
 		VGLTrans vglconn;
-		if(!localtest) vglconn.connect(fconfig.client, fconfig.port);
+		if(localtest) vglconn.connect(NULL, 0);
+		else vglconn.connect(fconfig.client, fconfig.port);
 
 		for(i = 0; i < w * h * d; i++) buf2[i] = 255 - buf2[i];
 		for(i = 0; i < w * h * d / 2; i++) buf3[i] = 255 - buf3[i];
@@ -215,6 +311,8 @@ int main(int argc, char **argv)
 
 		printf("%f Megapixels/sec\n",
 			(double)w * (double)h * (double)frames / 1000000. / elapsed);
+
+		if(scaling) scalingTest(buf, buf2, w, h, d, bgr, win, localtest);
 	}
 	catch(std::exception &e)
 	{
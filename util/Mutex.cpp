@@ -15,6 +15,10 @@
 #include "Mutex.h"
 #ifndef _WIN32
 #include <string.h>
+#include <time.h>
+#endif
+#ifdef __APPLE__
+#include <unistd.h>
 #endif
 #include "Error.h"
 
@@ -323,6 +327,56 @@ bool Semaphore::tryWait()
 }
 
 
+bool Semaphore::timedWait(double timeout)
+{
+	if(timeout < 0.) timeout = 0.;
+
+	#ifdef _WIN32
+
+	DWORD err = WaitForSingleObject(sem, (DWORD)(timeout * 1000.));
+	if(err == WAIT_FAILED) throw(W32Error("Semaphore::timedWait()"));
+	else if(err == WAIT_TIMEOUT) return false;
+
+	#elif defined(__APPLE__)
+
+	// macOS does not implement sem_timedwait(), so poll the semaphore with a
+	// granularity of 1 ms.
+	long usec = (long)(timeout * 1000000.);
+	while(!tryWait())
+	{
+		if(usec <= 0) return false;
+		usleep(usec < 1000 ? usec : 1000);
+		usec -= 1000;
+	}
+
+	#else
+
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	long sec = (long)timeout;
+	ts.tv_sec += sec;
+	ts.tv_nsec += (long)((timeout - (double)sec) * 1000000000.);
+	if(ts.tv_nsec >= 1000000000L)
+	{
+		ts.tv_sec++;  ts.tv_nsec -= 1000000000L;
+	}
+	int err = 0;
+	do
+	{
+		err = sem_timedwait(&sem, &ts);
+	} while(err < 0 && errno == EINTR);
+	if(err < 0)
+	{
+		if(errno == ETIMEDOUT) return false;
+		else throw(UnixError("Semaphore::timedWait()"));
+	}
+
+	#endif
+
+	return true;
+}
+
+
 void Semaphore::post(void)
 {
 	#ifdef _WIN32
@@ -0,0 +1,226 @@
+// Copyright (C)2026 D. R. Commander
+//
+// This library is free software and may be redistributed and/or modified under
+// the terms of the wxWindows Library License, Version 3.1 or (at your option)
+// any later version.  The full license is in the LICENSE.txt file included
+// with this distribution.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// wxWindows Library License for more details.
+
+// Lock-free bounded queue implementation using a preallocated ring buffer
+//
+// This is the bounded multi-producer/multi-consumer queue described by Dmitry
+// Vyukov.  Slot i initially has sequence number i.  A producer that wants to
+// fill the slot at position pos waits until the slot's sequence number is pos,
+// claims the position by advancing addPos, stores the item, and then sets the
+// sequence number to pos + 1.  A consumer that wants to empty the slot at
+// position pos waits until the slot's sequence number is pos + 1, claims the
+// position by advancing getPos, loads the item, and then sets the sequence
+// number to pos + capacity, which makes the slot available to the producer
+// that will fill it on the next trip around the ring.
+
+#include <string.h>
+#include "RingQ.h"
+#include "Error.h"
+#include "Timer.h"
+#ifdef USEHELGRIND
+	#include <valgrind/helgrind.h>
+#endif
+
+using namespace util;
+
+
+#ifdef _WIN32
+
+#define LOAD_ACQUIRE(p)  (*(p))
+#define STORE_RELEASE(p, v)  { MemoryBarrier();  *(p) = (v); }
+#define CAS(p, oldv, newv) \
+	(InterlockedCompareExchange((volatile LONG *)(p), (LONG)(newv), \
+		(LONG)(oldv)) == (LONG)(oldv))
+#define ATOMIC_ADD(p, v)  InterlockedExchangeAdd((volatile LONG *)(p), (LONG)(v))
+#define FENCE()  MemoryBarrier()
+
+#else
+
+#define LOAD_ACQUIRE(p)  __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v)  __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define CAS(p, oldv, newv)  __sync_bool_compare_and_swap(p, oldv, newv)
+#define ATOMIC_ADD(p, v)  __sync_fetch_and_add(p, v)
+#define FENCE()  __sync_synchronize()
+
+#endif
+
+
+RingQ::RingQ(int capacity) : slots(NULL), mask(0), addPos(0), getPos(0),
+	getWaiters(0), addWaiters(0), deadYet(0)
+{
+	unsigned int size = 2;
+	while(size < (unsigned int)capacity && size < 0x40000000) size <<= 1;
+	slots = new Slot[size];
+	for(unsigned int i = 0; i < size; i++)
+	{
+		slots[i].seq = i;  slots[i].item = NULL;
+	}
+	mask = size - 1;
+	#ifdef USEHELGRIND
+	ANNOTATE_BENIGN_RACE_SIZED(&deadYet, sizeof(int), );
+	#endif
+}
+
+
+RingQ::~RingQ(void)
+{
+	deadYet = 1;
+	release();
+	delete [] slots;  slots = NULL;
+}
+
+
+void RingQ::release(void)
+{
+	deadYet = 1;
+	hasItem.post();
+	hasSpace.post();
+}
+
+
+bool RingQ::tryAdd(void *item)
+{
+	unsigned int pos = LOAD_ACQUIRE(&addPos);
+	Slot *slot;
+
+	while(1)
+	{
+		slot = &slots[pos & mask];
+		int diff = (int)(LOAD_ACQUIRE(&slot->seq) - pos);
+		if(diff == 0)
+		{
+			if(CAS(&addPos, pos, pos + 1)) break;
+		}
+		else if(diff < 0) return false;  // The queue is full.
+		pos = LOAD_ACQUIRE(&addPos);
+	}
+	slot->item = item;
+	STORE_RELEASE(&slot->seq, pos + 1);
+	return true;
+}
+
+
+bool RingQ::tryGet(void **item)
+{
+	unsigned int pos = LOAD_ACQUIRE(&getPos);
+	Slot *slot;
+
+	while(1)
+	{
+		slot = &slots[pos & mask];
+		int diff = (int)(LOAD_ACQUIRE(&slot->seq) - (pos + 1));
+		if(diff == 0)
+		{
+			if(CAS(&getPos, pos, pos + 1)) break;
+		}
+		else if(diff < 0) return false;  // The queue is empty.
+		pos = LOAD_ACQUIRE(&getPos);
+	}
+	*item = slot->item;
+	STORE_RELEASE(&slot->seq, pos + mask + 1);
+	return true;
+}
+
+
+// Each waiter announces itself before checking the queue one last time and
+// going to sleep, and each producer or consumer checks for waiters after
+// updating the queue.  The full memory barriers on both sides guarantee that
+// either the waiter sees the update or the updater sees the waiter, so a
+// wakeup is never lost.
+
+void RingQ::spoil(void *item, SpoilCallback spoilCallback)
+{
+	if(deadYet) return;
+	if(item == NULL) THROW("NULL argument in RingQ::spoil()");
+	void *dummy = NULL;
+	while(tryGet(&dummy)) spoilCallback(dummy);
+	add(item);
+}
+
+
+void RingQ::add(void *item)
+{
+	if(deadYet) return;
+	if(item == NULL) THROW("NULL argument in RingQ::add()");
+	while(!tryAdd(item))
+	{
+		ATOMIC_ADD(&addWaiters, 1);
+		if(tryAdd(item))
+		{
+			ATOMIC_ADD(&addWaiters, -1);  break;
+		}
+		hasSpace.wait();
+		ATOMIC_ADD(&addWaiters, -1);
+		if(deadYet) return;
+	}
+	FENCE();
+	if(getWaiters > 0) hasItem.post();
+}
+
+
+// This will block until there is something in the queue
+void RingQ::get(void **item, bool nonBlocking)
+{
+	if(deadYet) return;
+	if(item == NULL) THROW("NULL argument in RingQ::get()");
+	while(!tryGet(item))
+	{
+		if(nonBlocking)
+		{
+			*item = NULL;  return;
+		}
+		ATOMIC_ADD(&getWaiters, 1);
+		if(tryGet(item))
+		{
+			ATOMIC_ADD(&getWaiters, -1);  break;
+		}
+		hasItem.wait();
+		ATOMIC_ADD(&getWaiters, -1);
+		if(deadYet) return;
+	}
+	FENCE();
+	if(addWaiters > 0) hasSpace.post();
+}
+
+
+void RingQ::get(void **item, double timeout)
+{
+	if(deadYet) return;
+	if(item == NULL) THROW("NULL argument in RingQ::get()");
+	Timer timer;
+	timer.start();
+	while(!tryGet(item))
+	{
+		double remaining = timeout - timer.elapsed();
+		if(remaining <= 0.)
+		{
+			*item = NULL;  return;
+		}
+		ATOMIC_ADD(&getWaiters, 1);
+		if(tryGet(item))
+		{
+			ATOMIC_ADD(&getWaiters, -1);  break;
+		}
+		hasItem.timedWait(remaining);
+		ATOMIC_ADD(&getWaiters, -1);
+		if(deadYet) return;
+	}
+	FENCE();
+	if(addWaiters > 0) hasSpace.post();
+}
+
+
+int RingQ::items(void)
+{
+	int retval = (int)(LOAD_ACQUIRE(&addPos) - LOAD_ACQUIRE(&getPos));
+	return retval < 0 ? 0 : retval;
+}
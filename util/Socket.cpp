@@ -23,6 +23,7 @@
 	#include <unistd.h>
 	#include <sys/types.h>
 	#include <sys/socket.h>
+	#include <sys/uio.h>
 	#include <arpa/inet.h>
 	#include <netdb.h>
 	#include <netinet/tcp.h>
@@ -281,3 +282,113 @@ void Socket::recv(char *buf, int len)
 	}
 	if(bytesRead != len) THROW("Incomplete receive");
 }
+
+
+// Scatter-gather I/O:  Each call to send() or recv() transfers up to MAXIOV
+// buffers with a single system call.
+
+#ifdef _WIN32
+typedef WSABUF IOVEC;
+#define IOV_BASE  buf
+#define IOV_LEN  len
+#else
+typedef struct iovec IOVEC;
+#define IOV_BASE  iov_base
+#define IOV_LEN  iov_len
+#endif
+
+
+// Fill in iov with the unsent/unreceived portions of bufs[index...count - 1],
+// starting at offset in bufs[index]
+static int fillIOV(IOVEC *iov, int maxIOV, SockBuf *bufs, int count,
+	int index, int offset)
+{
+	int n = 0;
+
+	for(int i = index; i < count && n < maxIOV; i++)
+	{
+		int skip = (i == index ? offset : 0);
+		if(bufs[i].len - skip <= 0) continue;
+		iov[n].IOV_BASE = &bufs[i].buf[skip];
+		iov[n].IOV_LEN = bufs[i].len - skip;
+		n++;
+	}
+	return n;
+}
+
+
+// Advance (index, offset) past len bytes of bufs
+static void advanceIOV(SockBuf *bufs, int count, int &index, int &offset,
+	long len)
+{
+	while(index < count)
+	{
+		long remaining = bufs[index].len - offset;
+		if(len < remaining) { offset += (int)len;  return; }
+		len -= remaining;  index++;  offset = 0;
+	}
+}
+
+
+void Socket::send(SockBuf *bufs, int count)
+{
+	if(sd == INVALID_SOCKET) THROW("Not connected");
+	IOVEC iov[MAXIOV];
+	int index = 0, offset = 0;
+
+	while(true)
+	{
+		int n = fillIOV(iov, MAXIOV, bufs, count, index, offset);
+		if(n == 0) break;
+		#ifdef _WIN32
+		DWORD bytesSent = 0;
+		if(WSASend(sd, iov, n, &bytesSent, 0, NULL, NULL) == SOCKET_ERROR)
+			THROW_SOCK();
+		long retval = bytesSent;
+		#else
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;  msg.msg_iovlen = n;
+		long retval = sendmsg(sd, &msg, 0);
+		if(retval == SOCKET_ERROR) THROW_SOCK();
+		#endif
+		if(retval == 0) THROW("Incomplete send");
+		advanceIOV(bufs, count, index, offset, retval);
+	}
+}
+
+
+// Receive at least minLen bytes into bufs, along with as much of the
+// remainder of bufs as is already available, and return the total number of
+// bytes received.  This allows the caller to receive a payload and to
+// opportunistically receive the header that follows it without blocking.
+
+int Socket::recv(SockBuf *bufs, int count, int minLen)
+{
+	if(sd == INVALID_SOCKET) THROW("Not connected");
+	IOVEC iov[MAXIOV];
+	int index = 0, offset = 0, bytesRead = 0;
+
+	while(bytesRead < minLen)
+	{
+		int n = fillIOV(iov, MAXIOV, bufs, count, index, offset);
+		if(n == 0) break;
+		#ifdef _WIN32
+		DWORD bytesRecvd = 0, flags = 0;
+		if(WSARecv(sd, iov, n, &bytesRecvd, &flags, NULL, NULL) == SOCKET_ERROR)
+			THROW_SOCK();
+		long retval = bytesRecvd;
+		#else
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;  msg.msg_iovlen = n;
+		long retval = recvmsg(sd, &msg, 0);
+		if(retval == SOCKET_ERROR) THROW_SOCK();
+		#endif
+		if(retval == 0) break;
+		advanceIOV(bufs, count, index, offset, retval);
+		bytesRead += (int)retval;
+	}
+	if(bytesRead < minLen) THROW("Incomplete receive");
+	return bytesRead;
+}
@@ -590,7 +590,9 @@ int fbx_awrite(fbx_struct *fb, int srcX_, int srcY_, int dstX_, int dstY_,
 	#endif
 	{
 		Drawable draw = fb->pixmap ? fb->wh.d : fb->pm;
-		if(draw == fb->pm) dstX = dstY = 0;
+		// The pixmap mirrors the image, so fbx_write() and fbx_sync() can copy
+		// the same region from it.
+		if(draw == fb->pm) { dstX = srcX;  dstY = srcY; }
 		XPutImage(fb->wh.dpy, draw, fb->xgc, fb->xi, srcX, srcY, dstX, dstY, width,
 			height);
 	}
@@ -151,6 +151,240 @@
 #define PF_X2_RGB10_BINDEX   PF_X2_BGR10_RINDEX
 
 
+/* SIMD conversion routines
+
+   Conversions from a 32-bit pixel format to a pixel format with 8-bit
+   components can all be expressed as a byte shuffle, optionally preceded by
+   extracting the upper 8 bits of each 10-bit source component.  The shuffle
+   mask is generated from the source component shifts and the destination
+   component indices, so the same routines handle every such pair of pixel
+   formats.  An AVX2 or SSSE3 routine is selected at run time on x86 CPUs, and
+   a Neon routine is used on 64-bit Arm CPUs. */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+	!defined(VGL_BIG_ENDIAN)
+#include <immintrin.h>
+#define PF_SIMD_X86
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && \
+	defined(__aarch64__) && !defined(VGL_BIG_ENDIAN)
+#include <arm_neon.h>
+#define PF_SIMD_NEON
+#endif
+
+#if defined(PF_SIMD_X86) || defined(PF_SIMD_NEON)
+
+#define PF_SIMD
+
+static int simdEnabled = 1;
+
+typedef struct
+{
+	int tenBit, rshift, gshift, bshift;
+	int dstSize, rindex, gindex, bindex;
+	unsigned char mask[16];
+} SIMDConv;
+
+
+static void convertRowC(const SIMDConv *sc, unsigned char *srcPixel,
+	unsigned char *dstPixel, int w)
+{
+	while(w--)
+	{
+		unsigned int p = *(unsigned int *)srcPixel;
+		dstPixel[sc->rindex] = (unsigned char)(p >> sc->rshift);
+		dstPixel[sc->gindex] = (unsigned char)(p >> sc->gshift);
+		dstPixel[sc->bindex] = (unsigned char)(p >> sc->bshift);
+		srcPixel += 4;  dstPixel += sc->dstSize;
+	}
+}
+
+
+#ifdef PF_SIMD_X86
+
+__attribute__((target("avx2")))
+static void convertAVX2(const SIMDConv *sc, unsigned char *srcBuf, int width,
+	int srcStride, int height, unsigned char *dstBuf, int dstStride)
+{
+	__m256i mask = _mm256_broadcastsi128_si256(
+		_mm_loadu_si128((__m128i *)sc->mask));
+	__m256i lsb = _mm256_set1_epi32(0xFF);
+	__m256i pack = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+	__m128i rshift = _mm_cvtsi32_si128(sc->rshift),
+		gshift = _mm_cvtsi32_si128(sc->gshift),
+		bshift = _mm_cvtsi32_si128(sc->bshift);
+	/* The 3-byte stores write 8 bytes past the end of the converted pixels, and
+	   those bytes must be overwritten by a subsequent store within the same
+	   row. */
+	int simdWidth = sc->dstSize == 3 ? width - 10 : width - 7;
+
+	while(height--)
+	{
+		int i = 0;
+		unsigned char *srcPixel = srcBuf, *dstPixel = dstBuf;
+
+		for(; i < simdWidth; i += 8)
+		{
+			__m256i v = _mm256_loadu_si256((__m256i *)srcPixel);
+			if(sc->tenBit)
+				v = _mm256_or_si256(
+					_mm256_and_si256(_mm256_srl_epi32(v, rshift), lsb),
+					_mm256_or_si256(
+						_mm256_slli_epi32(
+							_mm256_and_si256(_mm256_srl_epi32(v, gshift), lsb), 8),
+						_mm256_slli_epi32(
+							_mm256_and_si256(_mm256_srl_epi32(v, bshift), lsb), 16)));
+			v = _mm256_shuffle_epi8(v, mask);
+			if(sc->dstSize == 3)
+				v = _mm256_permutevar8x32_epi32(v, pack);
+			_mm256_storeu_si256((__m256i *)dstPixel, v);
+			srcPixel += 32;  dstPixel += sc->dstSize * 8;
+		}
+		convertRowC(sc, srcPixel, dstPixel, width - i);
+		srcBuf += srcStride;  dstBuf += dstStride;
+	}
+}
+
+
+__attribute__((target("ssse3")))
+static void convertSSSE3(const SIMDConv *sc, unsigned char *srcBuf,
+	int width, int srcStride, int height, unsigned char *dstBuf, int dstStride)
+{
+	__m128i mask = _mm_loadu_si128((__m128i *)sc->mask);
+	__m128i lsb = _mm_set1_epi32(0xFF);
+	__m128i rshift = _mm_cvtsi32_si128(sc->rshift),
+		gshift = _mm_cvtsi32_si128(sc->gshift),
+		bshift = _mm_cvtsi32_si128(sc->bshift);
+	int simdWidth = sc->dstSize == 3 ? width - 5 : width - 3;
+
+	while(height--)
+	{
+		int i = 0;
+		unsigned char *srcPixel = srcBuf, *dstPixel = dstBuf;
+
+		for(; i < simdWidth; i += 4)
+		{
+			__m128i v = _mm_loadu_si128((__m128i *)srcPixel);
+			if(sc->tenBit)
+				v = _mm_or_si128(_mm_and_si128(_mm_srl_epi32(v, rshift), lsb),
+					_mm_or_si128(
+						_mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(v, gshift), lsb), 8),
+						_mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(v, bshift), lsb),
+							16)));
+			_mm_storeu_si128((__m128i *)dstPixel, _mm_shuffle_epi8(v, mask));
+			srcPixel += 16;  dstPixel += sc->dstSize * 4;
+		}
+		convertRowC(sc, srcPixel, dstPixel, width - i);
+		srcBuf += srcStride;  dstBuf += dstStride;
+	}
+}
+
+#else  /* PF_SIMD_NEON */
+
+static void convertNeon(const SIMDConv *sc, unsigned char *srcBuf, int width,
+	int srcStride, int height, unsigned char *dstBuf, int dstStride)
+{
+	uint8x16_t mask = vld1q_u8(sc->mask);
+	uint32x4_t lsb = vdupq_n_u32(0xFF);
+	int32x4_t rshift = vdupq_n_s32(-sc->rshift),
+		gshift = vdupq_n_s32(-sc->gshift), bshift = vdupq_n_s32(-sc->bshift);
+	int simdWidth = sc->dstSize == 3 ? width - 5 : width - 3;
+
+	while(height--)
+	{
+		int i = 0;
+		unsigned char *srcPixel = srcBuf, *dstPixel = dstBuf;
+
+		for(; i < simdWidth; i += 4)
+		{
+			uint32x4_t v = vld1q_u32((uint32_t *)srcPixel);
+			if(sc->tenBit)
+				v = vorrq_u32(vandq_u32(vshlq_u32(v, rshift), lsb),
+					vorrq_u32(vshlq_n_u32(vandq_u32(vshlq_u32(v, gshift), lsb), 8),
+						vshlq_n_u32(vandq_u32(vshlq_u32(v, bshift), lsb), 16)));
+			vst1q_u8(dstPixel, vqtbl1q_u8(vreinterpretq_u8_u32(v), mask));
+			srcPixel += 16;  dstPixel += sc->dstSize * 4;
+		}
+		convertRowC(sc, srcPixel, dstPixel, width - i);
+		srcBuf += srcStride;  dstBuf += dstStride;
+	}
+}
+
+#endif
+
+
+/* Convert from a 32-bit pixel format to a 3- or 4-byte pixel format with 8-bit
+   components.  The shifts are the source component shifts plus the number of
+   low-order bits to discard from each component.  Returns 1 if the conversion
+   was performed or 0 if the caller should fall back to the scalar code. */
+
+static int convert_SIMD(unsigned char *srcBuf, int width, int srcStride,
+	int height, unsigned char *dstBuf, int dstStride, int rshift, int gshift,
+	int bshift, int dstSize, int rindex, int gindex, int bindex)
+{
+	SIMDConv sc;
+	int i;
+	#ifdef PF_SIMD_X86
+	static int simdLevel = -1;
+
+	if(simdLevel < 0)
+		simdLevel = __builtin_cpu_supports("avx2") ? 2 :
+			(__builtin_cpu_supports("ssse3") ? 1 : 0);
+	if(!simdLevel) return 0;
+	#endif
+	if(!simdEnabled) return 0;
+
+	sc.tenBit = (rshift % 8) || (gshift % 8) || (bshift % 8);
+	sc.rshift = rshift;  sc.gshift = gshift;  sc.bshift = bshift;
+	sc.dstSize = dstSize;
+	sc.rindex = rindex;  sc.gindex = gindex;  sc.bindex = bindex;
+	/* Bytes of the shuffle mask with the high bit set are zeroed.  After
+	   extracting 10-bit components, R, G, and B occupy bytes 0-2 of each
+	   32-bit word. */
+	memset(sc.mask, 0x80, 16);
+	for(i = 0; i < 4; i++)
+	{
+		sc.mask[i * dstSize + rindex] = i * 4 + (sc.tenBit ? 0 : rshift / 8);
+		sc.mask[i * dstSize + gindex] = i * 4 + (sc.tenBit ? 1 : gshift / 8);
+		sc.mask[i * dstSize + bindex] = i * 4 + (sc.tenBit ? 2 : bshift / 8);
+	}
+
+	#ifdef PF_SIMD_X86
+	if(simdLevel == 2)
+		convertAVX2(&sc, srcBuf, width, srcStride, height, dstBuf, dstStride);
+	else
+		convertSSSE3(&sc, srcBuf, width, srcStride, height, dstBuf, dstStride);
+	#else
+	convertNeon(&sc, srcBuf, width, srcStride, height, dstBuf, dstStride);
+	#endif
+	return 1;
+}
+
+#define CONVERT_SIMD(srcid, dstid, sshift) \
+	if(convert_SIMD(srcBuf, width, srcStride, height, dstBuf, dstStride, \
+		PF_##srcid##_RSHIFT + sshift, PF_##srcid##_GSHIFT + sshift, \
+		PF_##srcid##_BSHIFT + sshift, PF_##dstid##_SIZE, PF_##dstid##_RINDEX, \
+		PF_##dstid##_GINDEX, PF_##dstid##_BINDEX)) \
+		return;
+
+#else
+
+#define CONVERT_SIMD(srcid, dstid, sshift)
+
+#endif  /* defined(PF_SIMD_X86) || defined(PF_SIMD_NEON) */
+
+
+void pf_setsimd(int enable)
+{
+	#ifdef PF_SIMD
+	simdEnabled = enable;
+	#endif
+}
+
+/* 32-bit destination pixel formats with 8-bit components can use the SIMD
+   routines. */
+#define PF_8BIT(id)  ((PF_##id##_RMASK >> PF_##id##_RSHIFT) == 0xFF)
+
+
 #define CONVERT_FAST(id) \
 { \
 	int wps = width * PF_##id##_SIZE; \
@@ -164,6 +398,7 @@
 
 #define CONVERT_PF4I(srcid, dstid, sshift, dshift) \
 { \
+	if(PF_8BIT(dstid)) CONVERT_SIMD(srcid, dstid, sshift) \
 	while(height--) \
 	{ \
 		int w = width; \
@@ -190,6 +425,7 @@
 
 #define CONVERT_PF4I2C(srcid, dstid) \
 { \
+	CONVERT_SIMD(srcid, dstid, 2) \
 	while(height--) \
 	{ \
 		int w = width; \
@@ -277,6 +513,18 @@
 	return; \
 }
 
+#define CONVERT_PF4C2RGB(srcid, dstid) \
+{ \
+	CONVERT_SIMD(srcid, dstid, 0) \
+	CONVERT_RGB(srcid, dstid) \
+}
+
+#define CONVERT_PF4C2BGR(srcid, dstid) \
+{ \
+	CONVERT_SIMD(srcid, dstid, 0) \
+	CONVERT_BGR(srcid, dstid) \
+}
+
 #if __BITS == 64
 #define CONVERT_PF4CRGB(srcid, dstid)  CONVERT_PF4I(srcid, dstid, 0, 0)
 #define CONVERT_PF4CBGR(srcid, dstid)  CONVERT_PF4I(srcid, dstid, 0, 0)
@@ -308,10 +556,10 @@ static INLINE void convert_RGBX(unsigned char *srcBuf, int width,
 {
 	if(dstpf) switch(dstpf->id)
 	{
-		case PF_RGB:       CONVERT_RGB(RGBX, RGB)
+		case PF_RGB:       CONVERT_PF4C2RGB(RGBX, RGB)
 		case PF_RGBX:      CONVERT_FAST(RGBX)
 		case PF_RGB10_X2:  CONVERT_PF4I(RGBX, RGB10_X2, 0, 2)
-		case PF_BGR:       CONVERT_BGR(RGBX, BGR)
+		case PF_BGR:       CONVERT_PF4C2BGR(RGBX, BGR)
 		case PF_BGRX:      CONVERT_PF4CBGR(RGBX, BGRX)
 		case PF_BGR10_X2:  CONVERT_PF4I(RGBX, BGR10_X2, 0, 2)
 		case PF_XBGR:      CONVERT_PF4CBGR(RGBX, XBGR)
@@ -362,10 +610,10 @@ static INLINE void convert_BGRX(unsigned char *srcBuf, int width,
 {
 	if(dstpf) switch(dstpf->id)
 	{
-		case PF_RGB:       CONVERT_BGR(BGRX, RGB)
+		case PF_RGB:       CONVERT_PF4C2BGR(BGRX, RGB)
 		case PF_RGBX:      CONVERT_PF4CBGR(BGRX, RGBX)
 		case PF_RGB10_X2:  CONVERT_PF4I(BGRX, RGB10_X2, 0, 2)
-		case PF_BGR:       CONVERT_RGB(BGRX, BGR)
+		case PF_BGR:       CONVERT_PF4C2RGB(BGRX, BGR)
 		case PF_BGRX:      CONVERT_FAST(BGRX)
 		case PF_BGR10_X2:  CONVERT_PF4I(BGRX, BGR10_X2, 0, 2)
 		case PF_XBGR:      CONVERT_PF4CRGB(BGRX, XBGR)
@@ -398,10 +646,10 @@ static INLINE void convert_XBGR(unsigned char *srcBuf, int width,
 {
 	if(dstpf) switch(dstpf->id)
 	{
-		case PF_RGB:       CONVERT_BGR(XBGR, RGB)
+		case PF_RGB:       CONVERT_PF4C2BGR(XBGR, RGB)
 		case PF_RGBX:      CONVERT_PF4CBGR(XBGR, RGBX)
 		case PF_RGB10_X2:  CONVERT_PF4I(XBGR, RGB10_X2, 0, 2)
-		case PF_BGR:       CONVERT_RGB(XBGR, BGR)
+		case PF_BGR:       CONVERT_PF4C2RGB(XBGR, BGR)
 		case PF_BGRX:      CONVERT_PF4CRGB(XBGR, BGRX)
 		case PF_BGR10_X2:  CONVERT_PF4I(XBGR, BGR10_X2, 0, 2)
 		case PF_XBGR:      CONVERT_FAST(XBGR)
@@ -434,10 +682,10 @@ static INLINE void convert_XRGB(unsigned char *srcBuf, int width,
 {
 	if(dstpf) switch(dstpf->id)
 	{
-		case PF_RGB:       CONVERT_RGB(XRGB, RGB)
+		case PF_RGB:       CONVERT_PF4C2RGB(XRGB, RGB)
 		case PF_RGBX:      CONVERT_PF4CRGB(XRGB, RGBX)
 		case PF_RGB10_X2:  CONVERT_PF4I(XRGB, RGB10_X2, 0, 2)
-		case PF_BGR:       CONVERT_BGR(XRGB, BGR)
+		case PF_BGR:       CONVERT_PF4C2BGR(XRGB, BGR)
 		case PF_BGRX:      CONVERT_PF4CBGR(XRGB, BGRX)
 		case PF_BGR10_X2:  CONVERT_PF4I(XRGB, BGR10_X2, 0, 2)
 		case PF_XBGR:      CONVERT_PF4CBGR(XRGB, XBGR)
@@ -30,7 +30,7 @@
 
 
 double testTime = BENCHTIME;
-int getSetRGB = 0;
+int getSetRGB = 0, noSIMD = 0;
 
 
 static void initBuf(unsigned char *buf, int width, int pitch, int height,
@@ -168,14 +168,53 @@ static int doTest(int width, int height, PF *srcpf, PF *dstpf)
 		} while((elapsed = GetTime() - tStart) < testTime);
 	}
 
-	if(!cmpBuf(dstBuf, width, width * dstpf->size, height, srcpf, dstpf))
+	if(!cmpBuf(dstBuf, width, dstPitch, height, srcpf, dstpf))
 	{
 		printf("Pixel data is bogus\n");
 		retval = -1;  goto bailout;
 	}
 
-	printf("%f Mpixels/sec\n",
-		(double)(width * height) / 1000000. * (double)iter / elapsed);
+	/* GB/s includes both the source and destination pixel data. */
+	printf("%10.2f Mpixels/sec  %6.2f GB/s\n",
+		(double)(width * height) / 1000000. * (double)iter / elapsed,
+		(double)(width * height * (srcpf->size + dstpf->size)) / 1000000000. *
+			(double)iter / elapsed);
+
+	bailout:
+	free(srcBuf);
+	free(dstBuf);
+	return retval;
+}
+
+
+/* Verify that the optimized conversion routines handle all row widths
+   correctly, including widths that are not a multiple of the SIMD vector
+   size. */
+static int doEdgeTest(PF *srcpf, PF *dstpf)
+{
+	int retval = 0, width, height = 3;
+	unsigned char *srcBuf = NULL, *dstBuf = NULL;
+
+	if((srcBuf = (unsigned char *)malloc(BMPPAD(64 * srcpf->size) * height))
+		== NULL || (dstBuf = (unsigned char *)malloc(BMPPAD(64 * dstpf->size) *
+			height)) == NULL)
+		THROW("Could not allocate memory");
+
+	for(width = 1; width <= 64; width++)
+	{
+		int srcPitch = BMPPAD(width * srcpf->size),
+			dstPitch = BMPPAD(width * dstpf->size);
+
+		initBuf(srcBuf, width, srcPitch, height, srcpf, dstpf);
+		memset(dstBuf, 0, dstPitch * height);
+		srcpf->convert(srcBuf, width, srcPitch, height, dstBuf, dstPitch, dstpf);
+		if(!cmpBuf(dstBuf, width, dstPitch, height, srcpf, dstpf))
+		{
+			printf("%-8s --> %-8s: Pixel data is bogus (width = %d)\n",
+				srcpf->name, dstpf->name, width);
+			retval = -1;  goto bailout;
+		}
+	}
 
 	bailout:
 	free(srcBuf);
@@ -190,7 +229,8 @@ static void usage(char **argv)
 	fprintf(stderr, "Options:\n");
 	fprintf(stderr, "-time <t> = Set benchmark time to <t> seconds (default: %.1f)\n",
 		BENCHTIME);
-	fprintf(stderr, "-getsetrgb = Use pixel format getRGB/setRGB methods for conversion\n\n");
+	fprintf(stderr, "-getsetrgb = Use pixel format getRGB/setRGB methods for conversion\n");
+	fprintf(stderr, "-nosimd = Disable SIMD conversion routines\n\n");
 	exit(1);
 }
 
@@ -208,15 +248,20 @@ int main(int argc, char **argv)
 			if(testTime <= 0.0) usage(argv);
 		}
 		else if(!stricmp(argv[i], "-getsetrgb")) getSetRGB = 1;
+		else if(!stricmp(argv[i], "-nosimd")) noSIMD = 1;
 		else usage(argv);
 	}
 
+	if(noSIMD) pf_setsimd(0);
+
 	for(srcFormat = 0; srcFormat < PIXELFORMATS - 1; srcFormat++)
 	{
 		PF *srcpf = pf_get(srcFormat);
 		for(dstFormat = 0; dstFormat < PIXELFORMATS - 1; dstFormat++)
 		{
 			PF *dstpf = pf_get(dstFormat);
+			if(!getSetRGB && doEdgeTest(srcpf, dstpf) == -1)
+				goto bailout;
 			if(doTest(width, height, srcpf, dstpf) == -1)
 				goto bailout;
 		}
@@ -1,6 +1,6 @@
 // Copyright (C)2004 Landmark Graphics Corporation
 // Copyright (C)2005, 2006 Sun Microsystems, Inc.
-// Copyright (C)2014, 2017-2019, 2021 D. R. Commander
+// Copyright (C)2014, 2017-2019, 2021, 2026 D. R. Commander
 //
 // This library is free software and may be redistributed and/or modified under
 // the terms of the wxWindows Library License, Version 3.1 or (at your option)
@@ -14,13 +14,23 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "vglutil.h"
 #include "Thread.h"
 #include "Mutex.h"
+#include "GenericQ.h"
+#include "RingQ.h"
+#include "Timer.h"
 
 using namespace util;
 
 
+#define CHECK(cond) \
+{ \
+	if(!(cond)) THROW("Test failed: " #cond); \
+}
+
+
 Event event;
 Semaphore sem;
 
@@ -80,13 +90,228 @@ class TestThread : public Runnable
 };
 
 
-int main(void)
+// RingQ semantics test
+
+void spoilCallback(void *item)
+{
+	(*(int *)item)++;
+}
+
+
+class QueueFiller : public Runnable
+{
+	public:
+
+		QueueFiller(RingQ &q_, int *items_, int count_) : q(q_), items(items_),
+			count(count_) {}
+
+		void run(void)
+		{
+			for(int i = 0; i < count; i++) q.add(&items[i]);
+		}
+
+	private:
+
+		RingQ &q;  int *items, count;
+};
+
+
+void queueTest(void)
+{
+	int items[1000], i;
+	void *item = NULL;
+
+	printf("\nRingQ semantics test: ");
+
+	// FIFO order, wrapping around the ring several times
+	RingQ q(4);
+	CHECK(q.items() == 0);
+	q.get(&item, true);
+	CHECK(item == NULL);
+	item = &items[0];
+	q.get(&item, 0.01);
+	CHECK(item == NULL);
+	q.add(&items[0]);
+	q.get(&item, 0.01);
+	CHECK(item == &items[0]);
+	for(i = 0; i < 1000; i++)
+	{
+		q.add(&items[i]);
+		if(i % 3 == 2)
+		{
+			for(int j = i - 2; j <= i; j++)
+			{
+				q.get(&item);  CHECK(item == &items[j]);
+			}
+		}
+	}
+	q.get(&item);  CHECK(item == &items[999]);
+	CHECK(q.items() == 0);
+
+	// Spoiling
+	memset(items, 0, sizeof(int) * 3);
+	q.add(&items[0]);  q.add(&items[1]);
+	q.spoil(&items[2], spoilCallback);
+	CHECK(q.items() == 1);
+	CHECK(items[0] == 1 && items[1] == 1 && items[2] == 0);
+	q.get(&item);  CHECK(item == &items[2]);
+
+	// A producer that overruns the queue must block until there is space.
+	QueueFiller filler(q, items, 1000);
+	Thread thread(&filler);
+	thread.start();
+	for(i = 0; i < 1000; i++)
+	{
+		CHECK(q.items() <= 4);
+		q.get(&item);  CHECK(item == &items[i]);
+	}
+	thread.stop();
+	thread.checkError();
+
+	// Releasing the queue must wake up a blocked consumer.
+	class Releaser : public Runnable
+	{
+		public:
+			Releaser(RingQ &q_) : q(q_) {}
+			void run(void) { usleep(100000);  q.release(); }
+			RingQ &q;
+	} releaser(q);
+	Thread thread2(&releaser);
+	thread2.start();
+	item = NULL;
+	q.get(&item);
+	CHECK(item == NULL);
+	thread2.stop();
+
+	printf("SUCCESS\n");
+}
+
+
+// Queue hand-off benchmark
+//
+// Several producer threads add timestamped messages to a queue as fast as they
+// can, and the main thread removes them and records how long each message
+// waited in the queue.  This simulates the hand-off of frames from rendering
+// threads to image transport threads, under heavier contention than a real
+// application would generate.
+
+#define MESSAGES  20000
+
+typedef struct
+{
+	double sendTime;
+} Message;
+
+
+template<class Q> class Producer : public Runnable
+{
+	public:
+
+		Producer(Q &q_, Message *messages_) : q(q_), messages(messages_) {}
+
+		void run(void)
+		{
+			Timer timer;
+			for(int i = 0; i < MESSAGES; i++)
+			{
+				messages[i].sendTime = timer.time();
+				q.add(&messages[i]);
+			}
+		}
+
+	private:
+
+		Q &q;
+		Message *messages;
+};
+
+
+int compareDouble(const void *arg1, const void *arg2)
+{
+	double d1 = *(double *)arg1, d2 = *(double *)arg2;
+	return d1 < d2 ? -1 : (d1 > d2 ? 1 : 0);
+}
+
+
+template<class Q> void benchmark(const char *name, int nProducers)
+{
+	Q q;
+	Timer timer;
+	int total = MESSAGES * nProducers, i;
+	Message *messages = new Message[total];
+	double *latencies = new double[total];
+	Producer<Q> *producers[4];  Thread *threads[4];
+
+	timer.start();
+	for(i = 0; i < nProducers; i++)
+	{
+		producers[i] = new Producer<Q>(q, &messages[MESSAGES * i]);
+		threads[i] = new Thread(producers[i]);
+		threads[i]->start();
+	}
+	for(i = 0; i < total; i++)
+	{
+		void *item = NULL;
+		q.get(&item);
+		if(!item) THROW("Queue returned NULL");
+		latencies[i] = timer.time() - ((Message *)item)->sendTime;
+	}
+	double elapsed = timer.elapsed();
+	for(i = 0; i < nProducers; i++)
+	{
+		threads[i]->stop();  threads[i]->checkError();
+		delete threads[i];  delete producers[i];
+	}
+
+	qsort(latencies, total, sizeof(double), compareDouble);
+	printf("%-8s %d    %12.0f %9.2f %9.2f %9.2f\n", name, nProducers,
+		(double)total / elapsed, latencies[total / 2] * 1000000.,
+		latencies[total * 99 / 100] * 1000000., latencies[total - 1] * 1000000.);
+
+	delete [] messages;
+	delete [] latencies;
+}
+
+
+int main(int argc, char **argv)
 {
 	TestThread *testThread[5];  Thread *thread[5];  int i;
+	bool bench = true;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(!stricmp(argv[i], "-nobench")) bench = false;
+		else
+		{
+			fprintf(stderr, "\nUSAGE: %s [-nobench]\n\n", argv[0]);
+			fprintf(stderr, "-nobench = Do not run the queue hand-off benchmark\n\n");
+			exit(1);
+		}
+	}
+
+	try
+	{
+		queueTest();
+		if(bench)
+		{
+			printf("\nQueue hand-off performance (latencies in microseconds):\n");
+			printf("Queue    Producers   Msgs/sec       p50       p99       max\n");
+			for(i = 1; i <= 4; i *= 4)
+			{
+				benchmark<GenericQ>("GenericQ", i);
+				benchmark<RingQ>("RingQ", i);
+			}
+		}
+	}
+	catch(std::exception &e)
+	{
+		printf("Error in %s:\n%s\n", GET_METHOD(e), e.what());
+		return -1;
+	}
 
 	try
 	{
-		printf("Number of CPU cores in this system:  %d\n", NumProcs());
+		printf("\nNumber of CPU cores in this system:  %d\n", NumProcs());
 		printf("Word size = %d-bit\n", (int)sizeof(long *) * 8);
 
 		event.wait();